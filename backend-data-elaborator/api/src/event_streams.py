@@ -0,0 +1,69 @@
+"""
+Zone-Partitioned Event Streams
+------------------------------
+Seismic events travel from the API to the Workers through ZONE_SHARDS Redis
+Streams, "seismic_events:{shard}", with shard = zone_id % ZONE_SHARDS. Every
+event of a zone lands in the same stream, in arrival order.
+
+All Workers read through one consumer group (EVENT_GROUP), but a stream is
+only ever read by the Worker holding its lease (see worker.py): that keeps
+each zone's events processed in order, by one Worker at a time, while
+different shards scale across processes and nodes. A fixed shard count
+(rather than one stream per zone) bounds the set of keys a Worker polls.
+
+ZONE_SHARDS must be the same for the API and every Worker. Changing it
+moves zones between streams: drain the streams first.
+"""
+
+import os
+from typing import List
+
+ZONE_SHARDS = int(os.getenv("ZONE_SHARDS", "16"))
+EVENT_GROUP = "workers"
+EVENT_FIELD = "data"          # Entry field holding the JSON event
+STREAM_MAXLEN = 100000        # Approximate cap per stream (acknowledged entries are trimmed)
+LEGACY_QUEUE = "seismic_events"  # Single list used before the streams
+DEAD_LETTER_STREAM = "seismic_events:dead"  # Events a Worker could not store (see worker.py)
+
+if ZONE_SHARDS < 1:
+    raise ValueError("FATAL: ZONE_SHARDS must be at least 1.")
+
+
+def shard_for_zone(zone_id: int) -> int:
+    return zone_id % ZONE_SHARDS
+
+
+def stream_key(shard: int) -> str:
+    return f"seismic_events:{shard}"
+
+
+def stream_for_zone(zone_id: int) -> str:
+    return stream_key(shard_for_zone(zone_id))
+
+
+def all_streams() -> List[str]:
+    return [stream_key(shard) for shard in range(ZONE_SHARDS)]
+
+
+def lease_key(shard: int) -> str:
+    return f"seismic_events:{shard}:owner"
+
+
+def stream_backlog(client) -> int:
+    """
+    Events not yet read plus events read but not acknowledged, over all
+    shards (client: a synchronous redis.Redis with decode_responses).
+    """
+    backlog = 0
+    for stream in all_streams():
+        if not client.exists(stream):
+            continue
+        for group in client.xinfo_groups(stream):
+            if group["name"] != EVENT_GROUP:
+                continue
+            backlog += group["pending"]
+            lag = group.get("lag")
+            if lag is None:  # Unknown after deletions: compare the ids instead
+                lag = int(client.xinfo_stream(stream)["last-generated-id"] != group["last-delivered-id"])
+            backlog += lag
+    return backlog
@@ -5,23 +5,26 @@ Orchestrates IoT data ingestion, system health monitoring, and data retrieval.
 Implements robust error handling for cryptographic verification (SHA256, DER/RAW).
 """
 
+import os
 import json
-import asyncio
 import time
 import hashlib  
-from datetime import datetime
-from typing import List, Dict, Any, Optional
-
-from fastapi import FastAPI, Depends, HTTPException, status
+from datetime import datetime, timezone
+from collections import OrderedDict
+from typing import List, Dict, Any, NamedTuple, Optional
+
+from fastapi import FastAPI, Depends, HTTPException, Request, status
+from fastapi.exceptions import RequestValidationError
+from fastapi.responses import PlainTextResponse, Response
+from pydantic import BaseModel, ValidationError
 from sqlalchemy.orm import Session
 from sqlalchemy import func, desc, text
 from sqlalchemy.exc import OperationalError
 from redis import asyncio as aioredis
 
 # --- CRYPTO IMPORTS ---
-from ecdsa import VerifyingKey, NIST256p, BadSignatureError
-from ecdsa.errors import MalformedPointError
-from ecdsa.util import sigdecode_der, sigdecode_string 
+from ecdsa import SigningKey, NIST256p
+from ecdsa.util import sigencode_string
 
 from geoalchemy2.elements import WKTElement
 
@@ -29,6 +32,11 @@ from geoalchemy2.elements import WKTElement
 from src.database import get_db, engine
 import src.models as models
 import src.schemas as schemas
+import src.wire_format as wire_format
+from src.event_streams import stream_for_zone, EVENT_FIELD, STREAM_MAXLEN
+from src.signatures import (
+    verify, verify_device_signature, verify_device_signature_raw, start_verify_pool, stop_verify_pool
+)
 
 # ==========================================
 # DATABASE INITIALIZATION & WAITER
@@ -69,41 +77,205 @@ app = FastAPI(
 redis_client = aioredis.from_url("redis://redis:6379/0", decode_responses=True)
 
 
+@app.on_event("startup")
+def startup_verify_pool():
+    start_verify_pool()
+
+
+@app.on_event("shutdown")
+def shutdown_verify_pool():
+    stop_verify_pool()
+
+
 # --- UTILITY FUNCTIONS ---
 
-def verify_device_signature(public_key_hex: str, message: str, signature_hex: str) -> bool:
+class SensorIdentity(NamedTuple):
+    """What the ingestion endpoints need from a Misurator row."""
+    id: int
+    active: bool
+    zone_id: int
+    public_key_hex: str
+
+
+SENSOR_CACHE_SIZE = 10000   # Sensors kept in memory
+SENSOR_CACHE_TTL = 60       # Seconds before a cached sensor is read again (changes made outside the API)
+_sensor_cache: "OrderedDict[int, tuple]" = OrderedDict()
+
+
+def get_sensor(db: Session, misurator_id: int) -> Optional[SensorIdentity]:
     """
-    Verifies ECDSA signature using SHA256 hashing.
-    Compatible with ESP32 MbedTLS (DER) and Standard Python (RAW).
+    Looks a sensor up through an LRU cache, so a burst of events from the
+    same nodes does not cost one database query each. Unknown ids are not cached.
+    """
+    now = time.monotonic()
+    cached = _sensor_cache.get(misurator_id)
+    if cached is not None and cached[0] > now:
+        _sensor_cache.move_to_end(misurator_id)
+        return cached[1]
+
+    row = db.query(models.Misurator).filter(models.Misurator.id == misurator_id).first()
+    if row is None:
+        _sensor_cache.pop(misurator_id, None)
+        return None
+    sensor = SensorIdentity(row.id, row.active, row.zone_id, row.public_key_hex)
+    _sensor_cache[misurator_id] = (now + SENSOR_CACHE_TTL, sensor)
+    _sensor_cache.move_to_end(misurator_id)
+    if len(_sensor_cache) > SENSOR_CACHE_SIZE:
+        _sensor_cache.popitem(last=False)
+    return sensor
+
+
+def forget_sensor(misurator_id: int):
+    """Drops a sensor from the cache (registration changed it)."""
+    _sensor_cache.pop(misurator_id, None)
+
+
+def signed_timestamp(device_timestamp: float, device_timestamp_us: Optional[int]) -> int:
+    """Timestamp as it appears in the signed message: µs when the device sent them."""
+    return device_timestamp_us if device_timestamp_us is not None else int(device_timestamp)
+
+
+def signed_features(features: Optional[schemas.EventFeatures]) -> str:
+    """Features as they follow the timestamp in the signed message ("" when absent)."""
+    if features is None:
+        return ""
+    fields = [features.event_class, features.dominant_hz, features.duration_ms, features.pga_mms2, *features.energy]
+    return "".join(f":{v}" for v in fields)
+
+
+def signed_seq(seq: Optional[int]) -> str:
+    """Sequence number as it ends the signed entry (":seq", "" when absent)."""
+    return f":{seq}" if seq is not None else ""
+
+
+def is_binary_request(request: Request) -> bool:
+    """True if the body uses the binary wire format instead of JSON."""
+    content_type = request.headers.get("content-type", "")
+    return content_type.split(";")[0].strip().lower() == wire_format.CONTENT_TYPE
+
+
+async def parse_json_body(request: Request, model: type[BaseModel]) -> BaseModel:
+    """
+    Validates a JSON body against a schema, reporting errors like FastAPI's own (422).
     """
     try:
-        if not public_key_hex or not signature_hex:
-            return False
-            
-        key_bytes = bytes.fromhex(public_key_hex)
-        sig_bytes = bytes.fromhex(signature_hex)
-        message_bytes = message.encode('utf-8')
-
-        # 1. Load the Key (Try DER first - ESP32 Standard, fallback to RAW)
-        try:
-            vk = VerifyingKey.from_der(key_bytes)
-        except (ValueError, MalformedPointError):
-            vk = VerifyingKey.from_string(key_bytes, curve=NIST256p)
-        
-        # 2. Verify with SHA256 (CRITICAL: Matches ESP32's mbedtls_md_info_from_type(SHA256))
-        try:
-            # Try DER (ASN.1) first
-            return vk.verify(sig_bytes, message_bytes, sigdecode=sigdecode_der, hashfunc=hashlib.sha256)
-        except BadSignatureError:
-            # Fallback to RAW string signature
-            try:
-                return vk.verify(sig_bytes, message_bytes, sigdecode=sigdecode_string, hashfunc=hashlib.sha256)
-            except BadSignatureError:
-                return False
+        return model.model_validate_json(await request.body())
+    except ValidationError as e:
+        raise RequestValidationError(
+            [{**err, "loc": ("body", *err["loc"])} for err in e.errors(include_url=False)]
+        )
 
-    except Exception as e:
-        print(f"⚠️ Crypto Validation Error: {str(e)}")
-        return False
+
+SEQ_DEDUP_TTL = 7 * 24 * 3600  # Seconds a delivered sequence number is remembered
+
+
+LATENCY_TRACE = os.getenv("LATENCY_TRACE", "0") == "1"
+
+
+def start_trace() -> Optional[Dict[str, float]]:
+    """
+    Ingestion timestamps for tests/latency_benchmark.py when LATENCY_TRACE=1
+    (None otherwise). They travel in the event payload as "trace" and the
+    Worker stores them with its own once the event is committed.
+    """
+    return {"received": time.time()} if LATENCY_TRACE else None
+
+
+def mark_trace(trace: Optional[Dict[str, float]], stage: str):
+    if trace is not None:
+        trace[stage] = time.time()
+
+
+# Appends the entries not delivered before and marks their sequence numbers.
+# KEYS[1]: stream, KEYS[2..]: seq keys. ARGV: ttl, maxlen, field, then per
+# entry the index of its seq key (0: none) and the payload. A seq is marked
+# only after its XADD succeeded, so a failed enqueue never turns the retry
+# into a "duplicate".
+ENQUEUE_FIRST_DELIVERIES = redis_client.register_script("""
+local added = 0
+for i = 4, #ARGV, 2 do
+    local k = tonumber(ARGV[i])
+    if k == 0 or redis.call('EXISTS', KEYS[k]) == 0 then
+        redis.call('XADD', KEYS[1], 'MAXLEN', '~', ARGV[2], '*', ARGV[3], ARGV[i + 1])
+        if k > 0 then
+            redis.call('SET', KEYS[k], 1, 'EX', ARGV[1])
+        end
+        added = added + 1
+    end
+end
+return added
+""")
+
+
+async def enqueue_events(misurator_id: int, zone_id: int, payloads: List[Dict[str, Any]],
+                         trace: Optional[Dict[str, float]] = None) -> int:
+    """
+    Appends events to their zone's stream for the Workers (see event_streams.py),
+    skipping journal sequence numbers the sensor already delivered: a burst is
+    resent when its acknowledgement was lost. Entries without seq always pass.
+    De-duplication and XADD run in one script, in one Redis round-trip.
+    All payloads of one request come from one sensor, so they share the stream.
+    Returns the number of events enqueued.
+    """
+    mark_trace(trace, "enqueued")
+    keys = [stream_for_zone(zone_id)]
+    args: List[Any] = [SEQ_DEDUP_TTL, STREAM_MAXLEN, EVENT_FIELD]
+    for payload in payloads:
+        if trace is not None:
+            payload["trace"] = trace
+        if payload.get("seq"):
+            keys.append(f"misurator:{misurator_id}:seq:{payload['seq']}")
+            args.append(len(keys))
+        else:
+            args.append(0)
+        args.append(json.dumps(payload))
+    return await ENQUEUE_FIRST_DELIVERIES(keys=keys, args=args)
+
+
+async def ingest_binary_frame(body: bytes, db: Session, trace: Optional[Dict[str, float]]) -> Dict[str, str]:
+    """
+    Verifies a binary event frame (one raw signature over the frame bytes)
+    and queues every entry to Redis in the Worker's usual payload shape.
+    """
+    try:
+        frame = wire_format.decode_frame(body)
+    except wire_format.WireFormatError as e:
+        raise HTTPException(status_code=400, detail=f"Malformed binary frame: {e}")
+
+    misurator = get_sensor(db, frame.misurator_id)
+
+    if not misurator or not misurator.active:
+        raise HTTPException(status_code=403, detail="Sensor unauthorized or inactive")
+
+    is_valid = await verify(
+        verify_device_signature_raw,
+        misurator.public_key_hex,
+        frame.signed_bytes,
+        frame.signature
+    )
+
+    if not is_valid:
+        print(f"\n❌ BINARY SIGNATURE FAILED for Sensor {misurator.id} ({len(frame.entries)} entries)")
+        raise HTTPException(status_code=401, detail="Invalid digital signature")
+    mark_trace(trace, "verified")
+
+    signature_hex = frame.signature.hex()
+    payloads = [
+        {
+            "value": value,
+            "misurator_id": frame.misurator_id,
+            "device_timestamp": device_timestamp,
+            "device_timestamp_us": device_timestamp_us,
+            "seq": seq or None,
+            "features": features,
+            "signature_hex": signature_hex,
+            "zone_id": misurator.zone_id
+        }
+        for value, device_timestamp, seq, device_timestamp_us, features in frame.entries
+    ]
+    enqueued = await enqueue_events(frame.misurator_id, misurator.zone_id, payloads, trace)
+
+    return {"status": "accepted", "detail": f"{enqueued} entries enqueued"}
 
 
 # ==========================================
@@ -138,6 +310,7 @@ def create_misurator(misurator: schemas.MisuratorCreate, db: Session = Depends(g
     # Note: In prod, you might query by public_key or hardware_id, here we simplify.
     existing = db.query(models.Misurator).filter(models.Misurator.public_key_hex == misurator.public_key_hex).first()
     if existing:
+        forget_sensor(existing.id)
         return existing
 
     zone = db.query(models.Zone).filter(models.Zone.id == misurator.zone_id).first()
@@ -158,6 +331,7 @@ def create_misurator(misurator: schemas.MisuratorCreate, db: Session = Depends(g
     db.add(db_misurator)
     db.commit()
     db.refresh(db_misurator)
+    forget_sensor(db_misurator.id)
     return db_misurator
 
 
@@ -167,30 +341,133 @@ def get_misurators(skip: int = 0, limit: int = 100, db: Session = Depends(get_db
     return db.query(models.Misurator).offset(skip).limit(limit).all()
 
 
+# ==========================================
+# REMOTE DETECTOR CONFIGURATION
+# ==========================================
+
+def load_config_signing_key() -> Optional[SigningKey]:
+    """
+    Key that signs detector configurations: CONFIG_SIGNING_KEY, the hex P-256 private scalar.
+    Sensors hold the public half (firmware REMOTE_CONFIG_PUBKEY), so the key must stay the same.
+    """
+    key_hex = os.getenv("CONFIG_SIGNING_KEY", "").strip()
+    if not key_hex:
+        return None
+    return SigningKey.from_string(bytes.fromhex(key_hex), curve=NIST256p)
+
+
+CONFIG_SIGNING_KEY = load_config_signing_key()
+
+
+def require_config_key() -> SigningKey:
+    if CONFIG_SIGNING_KEY is None:
+        raise HTTPException(status_code=503, detail="CONFIG_SIGNING_KEY is not configured")
+    return CONFIG_SIGNING_KEY
+
+
+def detector_config_blob(misurator_id: int, version: int, cfg: schemas.DetectorConfigCreate) -> str:
+    """The signed text the firmware parses (detector_config.h)."""
+    return (f"config:{misurator_id}:{version}:{cfg.trigger_ratio:.6g}:{cfg.noise_floor:.6g}:"
+            f"{cfg.alpha_lta:.6g}:{cfg.alpha_sta:.6g}:{cfg.cooldown_ms}")
+
+
+def detector_config_response(row: models.DetectorConfig) -> Dict[str, Any]:
+    return {
+        "misurator_id": row.misurator_id,
+        "version": row.version,
+        "trigger_ratio": row.trigger_ratio,
+        "noise_floor": row.noise_floor,
+        "alpha_lta": row.alpha_lta,
+        "alpha_sta": row.alpha_sta,
+        "cooldown_ms": row.cooldown_ms,
+        "config": row.blob,
+        "signature_hex": row.signature_hex,
+        "updated_at": row.updated_at,
+    }
+
+
+@app.get("/config/public-key", tags=["System"])
+def get_config_public_key():
+    """Public half of the configuration key, for the firmware's REMOTE_CONFIG_PUBKEY (04 || X || Y)."""
+    key = require_config_key()
+    return {"public_key_hex": "04" + key.verifying_key.to_string().hex()}
+
+
+@app.put("/misurators/{misurator_id}/config", response_model=schemas.DetectorConfigResponse, tags=["Registration"])
+def set_detector_config(misurator_id: int, cfg: schemas.DetectorConfigCreate, db: Session = Depends(get_db)):
+    """
+    Signs a new detector configuration for a sensor. Each call increments the version;
+    the sensor picks it up on its next poll and applies it without a restart.
+    """
+    key = require_config_key()
+    if not db.query(models.Misurator).filter(models.Misurator.id == misurator_id).first():
+        raise HTTPException(status_code=404, detail="Sensor not found")
+
+    row = db.query(models.DetectorConfig).filter(models.DetectorConfig.misurator_id == misurator_id).first()
+    if row is None:
+        row = models.DetectorConfig(misurator_id=misurator_id, version=0)
+        db.add(row)
+
+    row.version += 1
+    row.trigger_ratio = cfg.trigger_ratio
+    row.noise_floor = cfg.noise_floor
+    row.alpha_lta = cfg.alpha_lta
+    row.alpha_sta = cfg.alpha_sta
+    row.cooldown_ms = cfg.cooldown_ms
+    row.blob = detector_config_blob(misurator_id, row.version, cfg)
+    row.signature_hex = key.sign_deterministic(
+        row.blob.encode("utf-8"), hashfunc=hashlib.sha256, sigencode=sigencode_string
+    ).hex()
+    db.commit()
+    db.refresh(row)
+    return detector_config_response(row)
+
+
+@app.get("/misurators/{misurator_id}/config", response_model=schemas.DetectorConfigBlob,
+         responses={204: {"description": "No configuration newer than `since`"}}, tags=["Ingestion"])
+def get_detector_config(misurator_id: int, since: int = 0, db: Session = Depends(get_db)):
+    """
+    Polled by the sensor with the version it runs (`since`). Returns the signed blob
+    when a newer one exists, otherwise 204. The blob is public: the signature protects it.
+    """
+    row = db.query(models.DetectorConfig).filter(models.DetectorConfig.misurator_id == misurator_id).first()
+    if row is None or row.version <= since:
+        return Response(status_code=status.HTTP_204_NO_CONTENT)
+    return {"misurator_id": row.misurator_id, "version": row.version,
+            "config": row.blob, "signature_hex": row.signature_hex}
+
+
 # ==========================================
 # INGESTION ENDPOINT
 # ==========================================
 
 @app.post("/misurations/", status_code=status.HTTP_202_ACCEPTED, tags=["Ingestion"])
 async def create_misuration_async(
-    misuration: schemas.MisurationCreate, 
+    request: Request,
     db: Session = Depends(get_db)
 ):
     """
     Receives data, verifies signature (SHA256), and queues to Redis.
+    Body: schemas.MisurationCreate as JSON, or a binary frame
+    (Content-Type: application/x-quakeguard-event).
     """
-    misurator = db.query(models.Misurator).filter(models.Misurator.id == misuration.misurator_id).first()
+    trace = start_trace()
+    if is_binary_request(request):
+        return await ingest_binary_frame(await request.body(), db, trace)
+    misuration = await parse_json_body(request, schemas.MisurationCreate)
+
+    misurator = get_sensor(db, misuration.misurator_id)
     
     if not misurator or not misurator.active:
         raise HTTPException(status_code=403, detail="Sensor unauthorized or inactive")
 
     # CRITICAL: Reconstruct message as "value:int(timestamp)" to match ESP32
-    message = f"{misuration.value}:{int(misuration.device_timestamp)}"
+    # (the µs timestamp when the device sent one, then the features and seq if any)
+    message = (f"{misuration.value}:{signed_timestamp(misuration.device_timestamp, misuration.device_timestamp_us)}"
+               f"{signed_features(misuration.features)}{signed_seq(misuration.seq)}")
     
-    loop = asyncio.get_event_loop()
-    is_valid = await loop.run_in_executor(
-        None, 
-        verify_device_signature, 
+    is_valid = await verify(
+        verify_device_signature,
         misurator.public_key_hex, 
         message, 
         misuration.signature_hex
@@ -202,16 +479,298 @@ async def create_misuration_async(
         print(f"Stored Key: {misurator.public_key_hex[:15]}...")
         print(f"Received Sig: {misuration.signature_hex[:15]}...\n")
         raise HTTPException(status_code=401, detail="Invalid digital signature")
+    mark_trace(trace, "verified")
 
     # Prepare payload for Worker
     payload = misuration.model_dump()
     payload['zone_id'] = misurator.zone_id 
     
-    await redis_client.lpush("seismic_events", json.dumps(payload))
+    # Already delivered (acknowledgement lost): accept again so the sensor moves on
+    if not await enqueue_events(misuration.misurator_id, misurator.zone_id, [payload], trace):
+        return {"status": "accepted", "detail": "Duplicate ignored"}
     
     return {"status": "accepted", "detail": "Data enqueued"}
 
 
+@app.post("/misurations/batch", status_code=status.HTTP_202_ACCEPTED, tags=["Ingestion"])
+async def create_misuration_batch_async(
+    request: Request,
+    db: Session = Depends(get_db)
+):
+    """
+    Receives several readings covered by a single signature, verifies it once,
+    and queues every entry to Redis in one round-trip.
+    Body: schemas.MisurationBatchCreate as JSON, or a binary frame.
+    """
+    trace = start_trace()
+    if is_binary_request(request):
+        return await ingest_binary_frame(await request.body(), db, trace)
+    batch = await parse_json_body(request, schemas.MisurationBatchCreate)
+
+    misurator = get_sensor(db, batch.misurator_id)
+
+    if not misurator or not misurator.active:
+        raise HTTPException(status_code=403, detail="Sensor unauthorized or inactive")
+
+    # CRITICAL: Reconstruct message as "value:int(ts);value:int(ts);..." to match ESP32
+    message = ";".join(
+        f"{e.value}:{signed_timestamp(e.device_timestamp, e.device_timestamp_us)}{signed_features(e.features)}"
+        f"{signed_seq(e.seq)}"
+        for e in batch.entries
+    )
+
+    is_valid = await verify(
+        verify_device_signature,
+        misurator.public_key_hex,
+        message,
+        batch.signature_hex
+    )
+
+    if not is_valid:
+        print(f"\n❌ BATCH SIGNATURE FAILED for Sensor {misurator.id} ({len(batch.entries)} entries)")
+        print(f"Expected Message: {message}")
+        raise HTTPException(status_code=401, detail="Invalid digital signature")
+    mark_trace(trace, "verified")
+
+    # Same per-event payload shape the Worker already consumes
+    payloads = [
+        {
+            "value": e.value,
+            "misurator_id": batch.misurator_id,
+            "device_timestamp": e.device_timestamp,
+            "device_timestamp_us": e.device_timestamp_us,
+            "seq": e.seq,
+            "features": e.features.model_dump() if e.features else None,
+            "signature_hex": batch.signature_hex,
+            "zone_id": misurator.zone_id
+        }
+        for e in batch.entries
+    ]
+    enqueued = await enqueue_events(batch.misurator_id, misurator.zone_id, payloads, trace)
+
+    return {"status": "accepted", "detail": f"{enqueued} entries enqueued"}
+
+
+# ==========================================
+# WAVEFORM UPLOAD (CHUNKED, BINARY)
+# ==========================================
+
+WAVEFORM_ASSEMBLY_TTL = 300  # Seconds a partial upload is kept in Redis
+
+
+@app.post("/waveforms/", status_code=status.HTTP_202_ACCEPTED, tags=["Ingestion"])
+async def upload_waveform_chunk(request: Request, db: Session = Depends(get_db)):
+    """
+    Receives one chunk of a trigger waveform (Content-Type: application/x-quakeguard-waveform).
+    Chunks are staged in Redis; the last one carries the signature, which is
+    checked against the reassembled capture before it is stored.
+    """
+    content_type = request.headers.get("content-type", "").split(";")[0].strip().lower()
+    if content_type != wire_format.WAVEFORM_CONTENT_TYPE:
+        raise HTTPException(status_code=415, detail=f"Expected {wire_format.WAVEFORM_CONTENT_TYPE}")
+
+    try:
+        chunk = wire_format.decode_waveform_chunk(await request.body())
+    except wire_format.WireFormatError as e:
+        raise HTTPException(status_code=400, detail=f"Malformed waveform chunk: {e}")
+
+    misurator = get_sensor(db, chunk.misurator_id)
+    if not misurator or not misurator.active:
+        raise HTTPException(status_code=403, detail="Sensor unauthorized or inactive")
+
+    # Stage the chunk (hex: the shared Redis client decodes responses as text)
+    key = f"waveform:{chunk.misurator_id}:{chunk.capture_id}"
+    pipe = redis_client.pipeline()
+    pipe.hsetnx(key, "descriptor", chunk.descriptor.hex())
+    pipe.hset(key, str(chunk.chunk_index), chunk.payload.hex())
+    pipe.expire(key, WAVEFORM_ASSEMBLY_TTL)
+    await pipe.execute()
+
+    if not chunk.is_last:
+        return {"status": "accepted", "detail": f"chunk {chunk.chunk_index + 1}/{chunk.chunk_count}"}
+
+    # Final chunk: reassemble, verify, persist
+    staged = await redis_client.hgetall(key)
+    await redis_client.delete(key)
+
+    parts = [staged.get(str(i)) for i in range(chunk.chunk_count)]
+    if staged.get("descriptor") != chunk.descriptor.hex() or any(p is None for p in parts):
+        raise HTTPException(status_code=409, detail="Incomplete or inconsistent waveform upload")
+    data = b"".join(bytes.fromhex(p) for p in parts)
+
+    is_valid = await verify(
+        verify_device_signature_raw,
+        misurator.public_key_hex,
+        chunk.descriptor + data,
+        chunk.signature
+    )
+    if not is_valid:
+        print(f"\n❌ WAVEFORM SIGNATURE FAILED for Sensor {misurator.id} (capture {chunk.capture_id})")
+        raise HTTPException(status_code=401, detail="Invalid digital signature")
+
+    try:
+        wire_format.decode_samples(chunk.encoding, data, chunk.total_samples)
+    except wire_format.WireFormatError as e:
+        raise HTTPException(status_code=400, detail=f"Malformed waveform payload: {e}")
+
+    waveform = models.Waveform(
+        misurator_id=chunk.misurator_id,
+        capture_id=chunk.capture_id,
+        trigger_time=datetime.fromtimestamp(chunk.trigger_timestamp, tz=timezone.utc),
+        odr_hz=chunk.odr_hz,
+        pre_samples=chunk.pre_samples,
+        total_samples=chunk.total_samples,
+        encoding=chunk.encoding,
+        data=data
+    )
+    db.add(waveform)
+    db.commit()
+    db.refresh(waveform)
+
+    # Decoding and analysis happen in the Worker
+    await redis_client.lpush("waveform_events", str(waveform.id))
+
+    return {"status": "accepted", "detail": "waveform stored", "waveform_id": waveform.id}
+
+
+@app.get("/waveforms/{waveform_id}", response_model=schemas.WaveformResponse, tags=["Data Retrieval"])
+def get_waveform(waveform_id: int, db: Session = Depends(get_db)):
+    """Returns a stored trigger waveform as raw [x, y, z] counts."""
+    waveform = db.query(models.Waveform).filter(models.Waveform.id == waveform_id).first()
+    if not waveform:
+        raise HTTPException(status_code=404, detail="Waveform not found")
+
+    samples = wire_format.decode_samples(waveform.encoding, waveform.data, waveform.total_samples)
+    return {
+        "id": waveform.id,
+        "misurator_id": waveform.misurator_id,
+        "trigger_time": waveform.trigger_time,
+        "odr_hz": waveform.odr_hz,
+        "pre_samples": waveform.pre_samples,
+        "total_samples": waveform.total_samples,
+        "peak_acceleration": waveform.peak_acceleration,
+        "samples": [list(s) for s in samples]
+    }
+
+
+# ==========================================
+# HEARTBEATS (DEVICE COUNTERS)
+# ==========================================
+
+HEARTBEAT_TTL = 24 * 3600  # Seconds the last heartbeat of a silent sensor is kept
+# Heartbeat fields that are levels, not counts since boot
+HEARTBEAT_GAUGES = {
+    "uptime_s", "sign_max_us", "tcp_connect_last_ms", "tcp_connect_max_ms",
+    "wifi_reconnect_max_ms", "free_heap", "min_free_heap", "heartbeat_age_seconds",
+}
+
+
+def heartbeat_message(hb: schemas.HeartbeatCreate) -> str:
+    """Reconstructs the signed heartbeat message exactly as the ESP32 builds it."""
+    fields = ",".join(str(getattr(hb, name)) for name in schemas.HEARTBEAT_FIELDS)
+    hist = ",".join(str(count) for count in hb.sign_ms_hist)
+    return f"heartbeat:{hb.misurator_id}:{hb.device_timestamp}:{fields};{hist}"
+
+
+async def load_heartbeat(misurator_id: int) -> Optional[Dict[str, Any]]:
+    stored = await redis_client.hgetall(f"misurator:{misurator_id}:heartbeat")
+    if not stored:
+        return None
+    # A field added in a later release reads 0 until the sensor reports again
+    heartbeat: Dict[str, Any] = {name: int(stored.get(name, 0)) for name in schemas.HEARTBEAT_FIELDS}
+    heartbeat["misurator_id"] = misurator_id
+    heartbeat["device_timestamp"] = int(stored["device_timestamp"])
+    heartbeat["received_at"] = float(stored["received_at"])
+    heartbeat["sign_ms_hist"] = json.loads(stored["sign_ms_hist"])
+    return heartbeat
+
+
+@app.post("/heartbeats/", status_code=status.HTTP_202_ACCEPTED, tags=["Ingestion"])
+async def receive_heartbeat(heartbeat: schemas.HeartbeatCreate, db: Session = Depends(get_db)):
+    """
+    Stores the latest counter snapshot of a sensor (signed, see the firmware README).
+    Only the newest heartbeat is kept: the counters are cumulative since boot.
+    """
+    misurator = get_sensor(db, heartbeat.misurator_id)
+    if not misurator or not misurator.active:
+        raise HTTPException(status_code=403, detail="Sensor unauthorized or inactive")
+
+    is_valid = await verify(
+        verify_device_signature,
+        misurator.public_key_hex,
+        heartbeat_message(heartbeat),
+        heartbeat.signature_hex
+    )
+    if not is_valid:
+        raise HTTPException(status_code=401, detail="Invalid digital signature")
+
+    # A replayed (or reordered) heartbeat must not roll the counters back
+    key = f"misurator:{heartbeat.misurator_id}:heartbeat"
+    last_ts = await redis_client.hget(key, "device_timestamp")
+    if last_ts is not None and heartbeat.device_timestamp <= int(last_ts):
+        raise HTTPException(status_code=409, detail="Heartbeat older than the stored one")
+
+    record = {name: getattr(heartbeat, name) for name in schemas.HEARTBEAT_FIELDS}
+    record["device_timestamp"] = heartbeat.device_timestamp
+    record["received_at"] = time.time()
+    record["sign_ms_hist"] = json.dumps(heartbeat.sign_ms_hist)
+
+    pipe = redis_client.pipeline()
+    pipe.hset(key, mapping=record)
+    pipe.expire(key, HEARTBEAT_TTL)
+    pipe.sadd("heartbeat_sensors", heartbeat.misurator_id)
+    await pipe.execute()
+
+    return {"status": "accepted", "detail": "Heartbeat stored"}
+
+
+@app.get("/sensors/{misurator_id}/heartbeat", tags=["Analytics"])
+async def get_sensor_heartbeat(misurator_id: int):
+    """Returns the latest heartbeat counters of a sensor."""
+    heartbeat = await load_heartbeat(misurator_id)
+    if heartbeat is None:
+        raise HTTPException(status_code=404, detail="No heartbeat received")
+    return heartbeat
+
+
+@app.get("/metrics", response_class=PlainTextResponse, tags=["System"])
+async def get_metrics():
+    """
+    Latest heartbeat of every sensor in the Prometheus text format.
+    Counters are cumulative since the sensor booted; uptime_s resets with them.
+    """
+    sensor_ids = sorted(int(i) for i in await redis_client.smembers("heartbeat_sensors"))
+    heartbeats = []
+    for misurator_id in sensor_ids:
+        heartbeat = await load_heartbeat(misurator_id)
+        if heartbeat is None:
+            # Expired: forget the sensor until it reports again
+            await redis_client.srem("heartbeat_sensors", misurator_id)
+        else:
+            heartbeats.append(heartbeat)
+
+    now = time.time()
+    lines: List[str] = []
+    for name in schemas.HEARTBEAT_FIELDS + ("heartbeat_age_seconds",):
+        kind = "gauge" if name in HEARTBEAT_GAUGES else "counter"
+        lines.append(f"# TYPE quakeguard_{name} {kind}")
+        for hb in heartbeats:
+            value = round(now - hb["received_at"], 1) if name == "heartbeat_age_seconds" else hb[name]
+            lines.append(f'quakeguard_{name}{{misurator_id="{hb["misurator_id"]}"}} {value}')
+
+    lines.append("# TYPE quakeguard_sign_latency_ms histogram")
+    for hb in heartbeats:
+        label = f'misurator_id="{hb["misurator_id"]}"'
+        cumulative = 0
+        bounds = [str(b) for b in schemas.HEARTBEAT_SIGN_BUCKETS_MS] + ["+Inf"]
+        for bound, count in zip(bounds, hb["sign_ms_hist"]):
+            cumulative += count
+            lines.append(f'quakeguard_sign_latency_ms_bucket{{{label},le="{bound}"}} {cumulative}')
+        lines.append(f"quakeguard_sign_latency_ms_count{{{label}}} {cumulative}")
+
+    return "\n".join(lines) + "\n"
+
+
 # ==========================================
 # STATISTICS & ALERTS ENDPOINTS (RESTORED)
 # ==========================================
@@ -3,10 +3,11 @@ Database Models Definition
 --------------------------
 This module defines the SQLAlchemy ORM models for the Earthquake Monitoring System.
 It integrates PostGIS geometry types for GPS location handling and defines
-the schema for Zones, Sensors (Misurators), Measurements, and Alerts.
+the schema for Zones, Sensors (Misurators), Measurements, Waveforms, Detector
+Configurations and Alerts.
 """
 
-from sqlalchemy import Column, Integer, String, Boolean, DateTime, ForeignKey, Float
+from sqlalchemy import Column, Integer, BigInteger, String, Boolean, DateTime, ForeignKey, Float, LargeBinary
 from sqlalchemy.sql import func
 from sqlalchemy.orm import relationship
 from geoalchemy2 import Geometry
@@ -70,6 +71,51 @@ class Misuration(Base):
     misurator = relationship("Misurator", back_populates="misurations")
 
 
+class Waveform(Base):
+    """
+    Raw 3-axis samples captured by a Misurator around one trigger.
+    Assembled from the chunked binary upload and verified before storing.
+    """
+    __tablename__ = "waveforms"
+
+    id = Column(Integer, primary_key=True, index=True)
+    created_at = Column(DateTime(timezone=True), server_default=func.now(), nullable=False)
+    misurator_id = Column(Integer, ForeignKey("misurators.id"), nullable=False, index=True)
+    capture_id = Column(BigInteger, nullable=False)
+    trigger_time = Column(DateTime(timezone=True), nullable=False, index=True)
+    odr_hz = Column(Integer, nullable=False)
+    pre_samples = Column(Integer, nullable=False)   # Index of the trigger sample
+    total_samples = Column(Integer, nullable=False)
+    encoding = Column(Integer, nullable=False)      # wire_format.WAVEFORM_ENC_*
+    data = Column(LargeBinary, nullable=False)      # Payload as uploaded (encoded)
+    peak_acceleration = Column(Float, nullable=True) # PGA in m/s^2, filled in by the Worker
+
+    # Relationships
+    misurator = relationship("Misurator")
+
+
+class DetectorConfig(Base):
+    """
+    Detector tuning pushed to one Misurator (remote configuration).
+    Only the latest version is kept, with the signed blob exactly as served.
+    """
+    __tablename__ = "detector_configs"
+
+    misurator_id = Column(Integer, ForeignKey("misurators.id"), primary_key=True)
+    version = Column(Integer, nullable=False)
+    trigger_ratio = Column(Float, nullable=False)
+    noise_floor = Column(Float, nullable=False)   # m/s^2
+    alpha_lta = Column(Float, nullable=False)     # Per sample at 100 Hz
+    alpha_sta = Column(Float, nullable=False)
+    cooldown_ms = Column(Integer, nullable=False)
+    blob = Column(String(128), nullable=False)
+    signature_hex = Column(String(128), nullable=False)  # Raw r||s over the blob
+    updated_at = Column(DateTime(timezone=True), server_default=func.now(), onupdate=func.now(), nullable=False)
+
+    # Relationships
+    misurator = relationship("Misurator")
+
+
 class Alert(Base):
     """
     Represents an aggregated/confirmed seismic event for a specific zone.
@@ -0,0 +1,54 @@
+"""
+QuakeGuard Sample Codec
+-----------------------
+Decoder for WAVEFORM_ENC_DELTA_VARINT, the firmware's lossless waveform
+encoding (iot-data-harvester/esp32_code/lib/QuakeCore/src/sample_codec.h).
+
+Each sample is three varints (x, y, z). Each varint is the ZigZag-mapped
+difference to the previous sample, in little-endian base-128 (MSB = more
+bytes follow). The stream starts from (0, 0, 0) and runs across all chunks
+of a capture.
+"""
+
+from typing import List, Tuple
+
+
+class CodecError(ValueError):
+    """Raised when an encoded stream is truncated or does not match its sample count."""
+
+
+def _to_int16(v: int) -> int:
+    return ((v + 0x8000) & 0xFFFF) - 0x8000
+
+
+def decode_delta_varint(data: bytes, total_samples: int) -> List[Tuple[int, int, int]]:
+    """Expands a delta/varint stream into (x, y, z) raw counts."""
+    samples: List[Tuple[int, int, int]] = []
+    prev = [0, 0, 0]
+    axis = 0
+    value = 0
+    shift = 0
+
+    for b in data:
+        value |= (b & 0x7F) << shift
+        if b & 0x80:
+            shift += 7
+            if shift > 28:
+                raise CodecError("Varint too long")
+            continue
+
+        # ZigZag -> signed delta, accumulated with int16 wrap-around like the device
+        delta = (value >> 1) ^ -(value & 1)
+        prev[axis] = _to_int16(prev[axis] + delta)
+        value = 0
+        shift = 0
+        axis += 1
+        if axis == 3:
+            samples.append((prev[0], prev[1], prev[2]))
+            axis = 0
+
+    if axis != 0 or shift != 0:
+        raise CodecError("Stream ends inside a sample")
+    if len(samples) != total_samples:
+        raise CodecError(f"Decoded {len(samples)} samples, expected {total_samples}")
+    return samples
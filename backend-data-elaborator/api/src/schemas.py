@@ -5,10 +5,12 @@ Defines request/response structures for API communication.
 Includes validation fields for security signatures and model serialization.
 """
 
-from pydantic import BaseModel, ConfigDict, Field
-from typing import Optional, List
+from pydantic import BaseModel, ConfigDict, Field, model_validator
+from typing import Optional, List, Annotated
 from datetime import datetime
 
+U32 = Annotated[int, Field(ge=0, le=0xFFFFFFFF)]
+
 # ==========================================
 # ZONE SCHEMAS
 # ==========================================
@@ -65,6 +67,25 @@ class Misurator(MisuratorBase):
 # MISURATION (DATA POINT) SCHEMAS
 # ==========================================
 
+# Event classes of the firmware's local classifier (lib/QuakeCore/src/event_features.h)
+EVENT_CLASS_SEISMIC = 1
+EVENT_CLASS_IMPULSIVE = 2
+EVENT_CLASS_MACHINERY = 3
+EVENT_CLASS_NAMES = {EVENT_CLASS_SEISMIC: "seismic", EVENT_CLASS_IMPULSIVE: "impulsive",
+                     EVENT_CLASS_MACHINERY: "machinery"}
+
+class EventFeatures(BaseModel):
+    """
+    Features of the first second (FEATURE_WINDOW_MS) after a trigger, computed
+    on the device. Signed as ":class:dominant_hz:duration_ms:pga_mms2:ex:ey:ez"
+    after the entry's timestamp.
+    """
+    event_class: int = Field(..., ge=1, le=255)
+    dominant_hz: int = Field(..., ge=0, le=255)
+    duration_ms: int = Field(..., ge=0, le=0xFFFF)
+    pga_mms2: U32                   # Peak ground acceleration, mm/s^2
+    energy: List[U32] = Field(..., min_length=3, max_length=3)  # x, y, z in (mm/s^2)^2 * s
+
 class MisurationBase(BaseModel):
     value: int
     misurator_id: int
@@ -77,7 +98,39 @@ class MisurationCreate(MisurationBase):
     # Timestamp generated by the device (Unix epoch float/int) used for replay protection
     device_timestamp: float 
     
-    # The digital signature of "value:device_timestamp"
+    # Trigger time in Unix microseconds (firmware TIMESTAMP_US=1). When present
+    # it replaces device_timestamp in the signed message.
+    device_timestamp_us: Optional[int] = Field(None, ge=0)
+
+    # The digital signature of "value:device_timestamp" (or "value:device_timestamp_us"),
+    # followed by the features, then ":seq", when present
+    signature_hex: str
+
+    # Journal sequence number (firmware EVENT_JOURNAL=1), used to drop replays (signed when present)
+    seq: Optional[int] = Field(None, ge=1, le=0xFFFFFFFF)
+
+    # Firmware EVENT_FEATURES=1; absent for journal replays (signed when present)
+    features: Optional[EventFeatures] = None
+
+class MisurationEntry(BaseModel):
+    """
+    A single reading inside a batch payload.
+    """
+    value: int
+    device_timestamp: float
+    device_timestamp_us: Optional[int] = Field(None, ge=0)
+    seq: Optional[int] = Field(None, ge=1, le=0xFFFFFFFF)
+    features: Optional[EventFeatures] = None
+
+class MisurationBatchCreate(BaseModel):
+    """
+    Payload for batch ingestion (multiple readings, ONE signature).
+    The signature covers "value:timestamp;value:timestamp;..." in entry order,
+    where an entry's timestamp is device_timestamp_us when present and its
+    features, then ":seq", follow the timestamp when present.
+    """
+    misurator_id: int
+    entries: List[MisurationEntry] = Field(..., min_length=1, max_length=100)
     signature_hex: str
 
 class MisurationUpdate(BaseModel):
@@ -90,6 +143,104 @@ class Misuration(MisurationBase):
     model_config = ConfigDict(from_attributes=True)
 
 
+# ==========================================
+# WAVEFORM SCHEMAS
+# ==========================================
+
+class WaveformResponse(BaseModel):
+    """
+    A stored trigger waveform, decoded to raw ADXL345 counts (4 mg/LSB).
+    """
+    id: int
+    misurator_id: int
+    trigger_time: datetime
+    odr_hz: int
+    pre_samples: int
+    total_samples: int
+    peak_acceleration: Optional[float] = None  # PGA in m/s^2 (None until processed)
+    samples: List[List[int]]  # [x, y, z] per sample
+
+
+# ==========================================
+# HEARTBEAT SCHEMAS
+# ==========================================
+
+# Scalar heartbeat counters, in the order they appear in the signed message
+HEARTBEAT_FIELDS = (
+    "uptime_s", "samples", "dropouts", "triggers", "suppressed", "queue_drops",
+    "send_ok", "send_failures", "sign_max_us", "sign_failures", "tcp_connects",
+    "tcp_connect_last_ms", "tcp_connect_max_ms", "wifi_disconnects",
+    "wifi_reconnect_max_ms", "free_heap", "min_free_heap",
+)
+HEARTBEAT_SIGN_BUCKETS_MS = (2, 8, 32, 128, 512)  # Upper bounds; a last bucket holds the rest
+
+class HeartbeatCreate(BaseModel):
+    """
+    Periodic counter snapshot from a sensor (counters run from boot).
+    Signature covers "heartbeat:<id>:<ts>:<fields, comma-joined>;<histogram, comma-joined>".
+    """
+    misurator_id: int
+    device_timestamp: int
+    uptime_s: U32
+    samples: U32
+    dropouts: U32
+    triggers: U32
+    suppressed: U32
+    queue_drops: U32
+    send_ok: U32
+    send_failures: U32
+    sign_max_us: U32
+    sign_failures: U32
+    tcp_connects: U32
+    tcp_connect_last_ms: U32
+    tcp_connect_max_ms: U32
+    wifi_disconnects: U32
+    wifi_reconnect_max_ms: U32
+    free_heap: U32
+    min_free_heap: U32
+    sign_ms_hist: List[U32] = Field(min_length=len(HEARTBEAT_SIGN_BUCKETS_MS) + 1,
+                                    max_length=len(HEARTBEAT_SIGN_BUCKETS_MS) + 1)
+    signature_hex: str
+
+
+# ==========================================
+# REMOTE DETECTOR CONFIGURATION SCHEMAS
+# ==========================================
+
+class DetectorConfigCreate(BaseModel):
+    """
+    Detector tuning for one sensor, at the 100 Hz reference rate.
+    Limits match the firmware's checks (detector_config.cpp): a blob outside them is rejected.
+    """
+    trigger_ratio: float = Field(ge=1.2, le=10.0)
+    noise_floor: float = Field(ge=0.005, le=1.0, description="Noise gate in m/s^2")
+    alpha_lta: float = Field(ge=0.001, le=0.5)
+    alpha_sta: float = Field(gt=0.0, le=1.0, description="Must be above alpha_lta")
+    cooldown_ms: int = Field(ge=500, le=60000)
+
+    @model_validator(mode="after")
+    def sta_faster_than_lta(self):
+        if self.alpha_sta <= self.alpha_lta:
+            raise ValueError("alpha_sta must be above alpha_lta")
+        return self
+
+class DetectorConfigBlob(BaseModel):
+    """
+    What a sensor fetches: the signed blob and its raw r||s signature.
+    """
+    misurator_id: int
+    version: int
+    config: str
+    signature_hex: str
+
+class DetectorConfigResponse(DetectorConfigCreate):
+    misurator_id: int
+    version: int
+    config: str
+    signature_hex: str
+    updated_at: Optional[datetime] = None
+
+
 # ==========================================
 # ANALYTICS & ALERTS SCHEMAS
 # ==========================================
@@ -0,0 +1,145 @@
+"""
+Device Signature Verification
+-----------------------------
+ECDSA (NIST256p) verification with SHA-256 hashing of sensor payloads,
+compatible with ESP32 MbedTLS (DER) and Standard Python (RAW) formats.
+
+python-ecdsa is pure Python and holds the GIL for the whole verification,
+so the default thread pool serializes it with the event loop. Verification
+runs in a process pool instead (VERIFY_WORKERS processes, default one per
+core; 0 keeps the thread pool). Each process keeps an LRU of parsed keys
+with precomputed point tables, keyed by the key hex: a key is parsed once
+per process, and a re-registered key is a new entry, never a stale one.
+
+This module is imported by the pool processes: keep it free of the
+database, Redis and the FastAPI app.
+"""
+
+import asyncio
+import hashlib
+import multiprocessing
+import os
+from concurrent.futures import Executor, ProcessPoolExecutor
+from concurrent.futures.process import BrokenProcessPool
+from functools import lru_cache
+from typing import Callable, Optional
+
+from ecdsa import VerifyingKey, NIST256p, BadSignatureError
+from ecdsa.errors import MalformedPointError
+from ecdsa.der import UnexpectedDER
+from ecdsa.util import sigdecode_der, sigdecode_string
+
+import src.wire_format as wire_format
+
+VERIFY_WORKERS = int(os.getenv("VERIFY_WORKERS") or os.cpu_count() or 1)
+KEY_CACHE_SIZE = 4096  # Parsed keys kept per process
+
+_pool: Optional[Executor] = None
+
+
+@lru_cache(maxsize=KEY_CACHE_SIZE)
+def load_verifying_key(public_key_hex: str) -> VerifyingKey:
+    """
+    Loads a device public key (DER first - ESP32 Standard, fallback to RAW).
+    Cached: the precomputed tables make every later verification faster.
+    """
+    key_bytes = bytes.fromhex(public_key_hex)
+    try:
+        vk = VerifyingKey.from_der(key_bytes)
+    except (ValueError, MalformedPointError):
+        vk = VerifyingKey.from_string(key_bytes, curve=NIST256p)
+    vk.precompute(lazy=True)
+    return vk
+
+
+def verify_device_signature(public_key_hex: str, message: str, signature_hex: str) -> bool:
+    """
+    Verifies ECDSA signature using SHA256 hashing.
+    Compatible with ESP32 MbedTLS (DER) and Standard Python (RAW).
+    """
+    try:
+        if not public_key_hex or not signature_hex:
+            return False
+
+        sig_bytes = bytes.fromhex(signature_hex)
+        message_bytes = message.encode('utf-8')
+
+        # 1. Load the Key
+        vk = load_verifying_key(public_key_hex)
+
+        # 2. Verify with SHA256 (CRITICAL: Matches ESP32's mbedtls_md_info_from_type(SHA256))
+        try:
+            # Try DER (ASN.1) first
+            return vk.verify(sig_bytes, message_bytes, sigdecode=sigdecode_der, hashfunc=hashlib.sha256)
+        except (BadSignatureError, UnexpectedDER):
+            # Fallback to RAW string signature
+            try:
+                return vk.verify(sig_bytes, message_bytes, sigdecode=sigdecode_string, hashfunc=hashlib.sha256)
+            except BadSignatureError:
+                return False
+
+    except Exception as e:
+        print(f"⚠️ Crypto Validation Error: {str(e)}")
+        return False
+
+
+def verify_device_signature_raw(public_key_hex: str, message: bytes, signature: bytes) -> bool:
+    """
+    Verifies a raw 64-byte r||s signature over binary data (binary wire format).
+    """
+    try:
+        if not public_key_hex or len(signature) != wire_format.SIG_SIZE:
+            return False
+        vk = load_verifying_key(public_key_hex)
+        return vk.verify(signature, message, sigdecode=sigdecode_string, hashfunc=hashlib.sha256)
+    except BadSignatureError:
+        return False
+    except Exception as e:
+        print(f"⚠️ Crypto Validation Error: {str(e)}")
+        return False
+
+
+def verify_pool() -> Optional[Executor]:
+    """
+    The verification pool, created on first use (None: the loop's default thread pool).
+    "spawn" so the processes start clean instead of forking the running server.
+    """
+    global _pool
+    if _pool is None and VERIFY_WORKERS > 0:
+        _pool = ProcessPoolExecutor(max_workers=VERIFY_WORKERS, mp_context=multiprocessing.get_context("spawn"))
+    return _pool
+
+
+async def verify(check: Callable[..., bool], *args) -> bool:
+    """Runs verify_device_signature or verify_device_signature_raw off the event loop."""
+    global _pool
+    loop = asyncio.get_running_loop()
+    pool = verify_pool()
+    try:
+        return await loop.run_in_executor(pool, check, *args)
+    except BrokenProcessPool:
+        # A pool process died (OOM kill...): replace the pool once and try again
+        if _pool is pool:
+            print("⚠️ Verification pool broken, restarting it")
+            pool.shutdown(wait=False)
+            _pool = None
+        return await loop.run_in_executor(verify_pool(), check, *args)
+
+
+def _warm_up() -> int:
+    return os.getpid()  # Imports this module (and ecdsa) in the pool process
+
+
+def start_verify_pool():
+    """Starts every pool process now, so the first requests do not pay for the spawn."""
+    pool = verify_pool()
+    if isinstance(pool, ProcessPoolExecutor):
+        for future in [pool.submit(_warm_up) for _ in range(VERIFY_WORKERS)]:
+            future.result()
+
+
+def stop_verify_pool():
+    global _pool
+    if _pool is not None:
+        _pool.shutdown(wait=True)
+        _pool = None
@@ -0,0 +1,184 @@
+"""
+QuakeGuard Binary Wire Format (v1)
+----------------------------------
+Decoder for the compact event frame sent by the firmware when built with
+WIRE_BINARY=1 (see iot-data-harvester/esp32_code/lib/QuakeCore/src/wire_format.h).
+
+Layout (little-endian):
+    u8  version | u8 count | u16 flags | u32 misurator_id
+    count x (i32 value, u32 device_timestamp[, u32 seq][, u32 usec][, features])
+    64-byte raw r||s ECDSA signature over everything before it
+
+With FLAG_SEQUENCE each entry carries the sensor's journal sequence number
+(0 = not journaled), used to drop entries delivered twice. With FLAG_TIME_US
+it also carries the microseconds within device_timestamp. With FLAG_FEATURES
+the entry ends with the on-device event features (20 bytes: u8 event_class,
+u8 dominant_hz, u16 duration_ms, u32 pga_mms2, 3 x u32 energy); class 0 means
+the entry was sent unclassified (e.g. replayed from the journal).
+
+Waveform chunks (POST /waveforms/) carry a 32-byte header: a 28-byte
+capture descriptor shared by all chunks, then chunk_index and payload_len.
+The last chunk appends one signature over
+SHA-256(descriptor || payload_0 || ... || payload_n-1).
+"""
+
+import struct
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Tuple
+
+from src.sample_codec import CodecError, decode_delta_varint
+
+CONTENT_TYPE = "application/x-quakeguard-event"
+VERSION = 1
+MAX_ENTRIES = 100
+FLAG_SEQUENCE = 0x0001
+FLAG_TIME_US = 0x0002
+FLAG_FEATURES = 0x0004
+
+_HEADER = struct.Struct("<BBHI")
+_ENTRY = struct.Struct("<iI")
+_U32 = struct.Struct("<I")
+_FEATURES = struct.Struct("<BBHIIII")
+SIG_SIZE = 64
+
+
+WAVEFORM_CONTENT_TYPE = "application/x-quakeguard-waveform"
+WAVEFORM_MAGIC = 0x46574751  # "QGWF"
+WAVEFORM_DESCRIPTOR_SIZE = 28
+WAVEFORM_ENC_RAW16 = 0       # int16 x, y, z per sample
+WAVEFORM_ENC_DELTA_VARINT = 1  # src/sample_codec.py, one stream across all chunks
+
+_WAVEFORM_HEADER = struct.Struct("<IBBHIIIIHHHH")
+_RAW16_SAMPLE = struct.Struct("<hhh")
+
+
+class WireFormatError(ValueError):
+    """Raised when a binary frame is truncated or malformed."""
+
+
+@dataclass
+class BinaryFrame:
+    misurator_id: int
+    # (value, device_timestamp, seq, device_timestamp_us, features); seq 0 = none,
+    # us None = seconds only, features None = unclassified (else the EventFeatures fields)
+    entries: List[Tuple[int, int, int, Optional[int], Optional[Dict[str, Any]]]]
+    signed_bytes: bytes             # Exact bytes covered by the signature
+    signature: bytes                # Raw r||s
+
+
+def decode_frame(body: bytes) -> BinaryFrame:
+    """Parses and validates one binary event frame."""
+    if len(body) < _HEADER.size + _ENTRY.size + SIG_SIZE:
+        raise WireFormatError("Frame too short")
+
+    version, count, flags, misurator_id = _HEADER.unpack_from(body, 0)
+    if version != VERSION:
+        raise WireFormatError(f"Unsupported frame version {version}")
+    if not 1 <= count <= MAX_ENTRIES:
+        raise WireFormatError(f"Invalid entry count {count}")
+
+    has_seq = bool(flags & FLAG_SEQUENCE)
+    has_usec = bool(flags & FLAG_TIME_US)
+    has_features = bool(flags & FLAG_FEATURES)
+    entry_size = _ENTRY.size + _U32.size * (has_seq + has_usec) + (_FEATURES.size if has_features else 0)
+    signed_len = _HEADER.size + count * entry_size
+    if len(body) != signed_len + SIG_SIZE:
+        raise WireFormatError("Frame length does not match entry count")
+
+    entries = []
+    for offset in range(_HEADER.size, signed_len, entry_size):
+        value, device_timestamp = _ENTRY.unpack_from(body, offset)
+        offset += _ENTRY.size
+        seq = 0
+        if has_seq:
+            (seq,) = _U32.unpack_from(body, offset)
+            offset += _U32.size
+        device_timestamp_us = None
+        if has_usec:
+            (usec,) = _U32.unpack_from(body, offset)
+            if usec >= 1_000_000:
+                raise WireFormatError(f"Invalid microsecond field {usec}")
+            device_timestamp_us = device_timestamp * 1_000_000 + usec
+            offset += _U32.size
+        features = None
+        if has_features:
+            event_class, dominant_hz, duration_ms, pga_mms2, *energy = _FEATURES.unpack_from(body, offset)
+            if event_class:
+                features = {"event_class": event_class, "dominant_hz": dominant_hz,
+                            "duration_ms": duration_ms, "pga_mms2": pga_mms2, "energy": energy}
+        entries.append((value, device_timestamp, seq, device_timestamp_us, features))
+    return BinaryFrame(
+        misurator_id=misurator_id,
+        entries=entries,
+        signed_bytes=body[:signed_len],
+        signature=body[signed_len:],
+    )
+
+
+@dataclass
+class WaveformChunk:
+    descriptor: bytes               # Bytes [0, 28): identical in every chunk of a capture
+    encoding: int
+    odr_hz: int
+    misurator_id: int
+    capture_id: int
+    trigger_timestamp: int
+    total_samples: int
+    pre_samples: int
+    chunk_count: int
+    chunk_index: int
+    payload: bytes
+    signature: Optional[bytes]      # Present on the last chunk only
+
+    @property
+    def is_last(self) -> bool:
+        return self.chunk_index + 1 == self.chunk_count
+
+
+def decode_waveform_chunk(body: bytes) -> WaveformChunk:
+    """Parses and validates one waveform upload chunk."""
+    if len(body) < _WAVEFORM_HEADER.size:
+        raise WireFormatError("Chunk too short")
+
+    (magic, version, encoding, odr_hz, misurator_id, capture_id, trigger_timestamp,
+     total_samples, pre_samples, chunk_count, chunk_index, payload_len) = _WAVEFORM_HEADER.unpack_from(body, 0)
+    if magic != WAVEFORM_MAGIC:
+        raise WireFormatError("Bad waveform magic")
+    if version != VERSION:
+        raise WireFormatError(f"Unsupported chunk version {version}")
+    if chunk_count == 0 or chunk_index >= chunk_count:
+        raise WireFormatError(f"Invalid chunk {chunk_index}/{chunk_count}")
+
+    payload_end = _WAVEFORM_HEADER.size + payload_len
+    last = chunk_index + 1 == chunk_count
+    if len(body) != payload_end + (SIG_SIZE if last else 0):
+        raise WireFormatError("Chunk length does not match payload_len")
+
+    return WaveformChunk(
+        descriptor=body[:WAVEFORM_DESCRIPTOR_SIZE],
+        encoding=encoding,
+        odr_hz=odr_hz,
+        misurator_id=misurator_id,
+        capture_id=capture_id,
+        trigger_timestamp=trigger_timestamp,
+        total_samples=total_samples,
+        pre_samples=pre_samples,
+        chunk_count=chunk_count,
+        chunk_index=chunk_index,
+        payload=body[_WAVEFORM_HEADER.size:payload_end],
+        signature=body[payload_end:] if last else None,
+    )
+
+
+def decode_samples(encoding: int, data: bytes, total_samples: int) -> List[Tuple[int, int, int]]:
+    """Expands an assembled waveform payload into (x, y, z) raw counts."""
+    if encoding == WAVEFORM_ENC_DELTA_VARINT:
+        try:
+            return decode_delta_varint(data, total_samples)
+        except CodecError as e:
+            raise WireFormatError(str(e))
+    if encoding != WAVEFORM_ENC_RAW16:
+        raise WireFormatError(f"Unsupported sample encoding {encoding}")
+    if len(data) != total_samples * _RAW16_SAMPLE.size:
+        raise WireFormatError("Payload size does not match total_samples")
+    return list(_RAW16_SAMPLE.iter_unpack(data))
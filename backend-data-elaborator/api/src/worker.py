@@ -1,89 +1,581 @@
 """
 QuakeGuard Background Worker
 -----------------------------
-Consumes seismic events from the Redis queue, persists data to PostgreSQL,
-and detects critical seismic thresholds to generate persistent Alerts.
+Consumes seismic events from the zone-partitioned Redis Streams, persists
+data to PostgreSQL, and detects critical seismic thresholds to generate
+persistent Alerts. Several Workers can run side by side.
+An alert fires when ALERT_THRESHOLD distinct sensors of a zone trigger
+within ALERT_WINDOW_SECONDS of device time.
+Events the sensor classified as non-seismic are stored but not counted.
+Events are drained in batches (WORKER_BATCH_SIZE) and written with one
+multi-row INSERT and one Redis pipeline per batch. An event that cannot be
+stored goes to a dead-letter stream; it is never acknowledged unstored.
 """
 
 import json
+import math
+import os
+import random
 import redis
+import signal
+import socket
 import time
+from concurrent.futures import Future, ThreadPoolExecutor, wait
 from datetime import datetime
+from typing import Dict, List, Optional, Set, Tuple
+from sqlalchemy import insert
+from sqlalchemy.exc import DBAPIError, InterfaceError, OperationalError
 from src.database import SessionLocal
-from src.models import Misuration, Alert
+from src.event_streams import (
+    ZONE_SHARDS, EVENT_GROUP, EVENT_FIELD, STREAM_MAXLEN, LEGACY_QUEUE, DEAD_LETTER_STREAM,
+    all_streams, lease_key, stream_for_zone, stream_key
+)
+from src.models import Misuration, Alert, Waveform
+from src.schemas import EVENT_CLASS_IMPULSIVE, EVENT_CLASS_MACHINERY, EVENT_CLASS_NAMES
+from src.wire_format import decode_samples, WireFormatError
 
 # --- CONFIGURATION ---
 REDIS_HOST = 'redis'
 REDIS_PORT = 6379
 ALERT_THRESHOLD = 50       # Number of sensors triggering within the window to raise an alarm
-ALERT_WINDOW_SECONDS = 10  # Rolling time window for the counter
+ALERT_WINDOW_SECONDS = 10  # Sliding window, in device time, over which distinct sensors are counted
+MAX_CLOCK_SKEW = 2         # Device timestamps further ahead of the server clock are not trusted
+WINDOW_KEY_TTL = 10 * ALERT_WINDOW_SECONDS  # A quiet zone's window is dropped after this
 ALERT_COOLDOWN = 60        # Seconds to wait before raising another alarm for the same zone
+WORKER_BATCH_SIZE = int(os.getenv("WORKER_BATCH_SIZE", "500"))  # Events per round (1 = one at a time)
+THROUGHPUT_REPORT_SECONDS = 10
+WORKER_ID = os.getenv("WORKER_ID") or f"{socket.gethostname()}-{os.getpid()}"
+WORKERS_KEY = "seismic_workers"  # Live workers, scored by last rebalance
+LEASE_SECONDS = 10         # A dead worker's shards are taken over after this
+REBALANCE_SECONDS = 2      # Lease renewal and rebalancing period
+STREAM_BLOCK_MS = 1000     # Longest wait for new events before checking waveforms
+MAX_BATCH_ATTEMPTS = 3     # A batch failing this many times is split to find the bad events
+MAX_BACKOFF_SECONDS = 30   # Longest wait between retries while PostgreSQL or Redis is down
+
+# Classes of the sensor's local classifier that never count towards an alert. Events
+# without features (older firmware, journal replays) always count.
+NON_SEISMIC_CLASSES = {EVENT_CLASS_IMPULSIVE, EVENT_CLASS_MACHINERY}
+
+ADXL345_LSB_TO_MS2 = 0.004 * 9.80665  # Full-resolution scale factor (4 mg/LSB)
 
 # Synchronous Redis client for the worker loop
 redis_sync = redis.Redis(host=REDIS_HOST, port=REDIS_PORT, db=0, decode_responses=True)
 
-def run_worker():
+def process_waveform(waveform_id: int):
     """
-    Continuous loop consuming messages from the 'seismic_events' queue.
-    Uses BRPOP (Blocking Right Pop) for efficient resource utilization.
+    Decodes a stored trigger waveform and records its Peak Ground Acceleration.
+    The baseline (gravity + offset) is the mean of the pre-trigger samples.
     """
-    print(f"👷 Worker started. Threshold: {ALERT_THRESHOLD} events / {ALERT_WINDOW_SECONDS}s")
-    
-    while True:
+    with SessionLocal() as db:
+        waveform = db.query(Waveform).filter(Waveform.id == waveform_id).first()
+        if waveform is None:
+            return
+        try:
+            samples = decode_samples(waveform.encoding, waveform.data, waveform.total_samples)
+        except WireFormatError as e:
+            print(f"❌ Waveform {waveform_id} could not be decoded: {e}")
+            return
+        if not samples:
+            return
+
+        baseline = samples[:waveform.pre_samples] or samples
+        mean = [sum(s[axis] for s in baseline) / len(baseline) for axis in range(3)]
+        peak = max(
+            math.sqrt((x - mean[0]) ** 2 + (y - mean[1]) ** 2 + (z - mean[2]) ** 2)
+            for x, y, z in samples
+        )
+        waveform.peak_acceleration = peak * ADXL345_LSB_TO_MS2
+        db.commit()
+        print(f"📈 Waveform {waveform_id}: {len(samples)} samples, PGA {waveform.peak_acceleration:.3f} m/s^2")
+
+
+def counts_towards_alert(event: dict) -> bool:
+    """False for events the sensor classified as non-seismic (they are still stored)."""
+    features = event.get('features')
+    return not (features and features['event_class'] in NON_SEISMIC_CLASSES)
+
+
+# --------------------------------------------------------------------------
+# ZONE WINDOWS
+# --------------------------------------------------------------------------
+# "zone:{id}:sensors" is a sorted set of the zone's sensors scored by the
+# device time of their latest counted event. The window ends at the newest
+# event time of the zone (so a backlog in the queue does not age events out
+# before they are counted), but never after the server clock, and spans
+# ALERT_WINDOW_SECONDS: a sensor counts once however often it fires, and a
+# steady trickle cannot keep stale sensors in. A sensor whose clock runs
+# ahead is let in at most MAX_CLOCK_SKEW ahead (event_time) and cannot push
+# the window forward, so it cannot evict the zone's honest sensors. Memory is
+# bounded by the zone's sensors, and the key expires once the zone goes quiet.
+
+WINDOW_COUNT = redis_sync.register_script("""
+local newest = redis.call('ZRANGE', KEYS[1], -1, -1, 'WITHSCORES')[2]
+if not newest then
+    return 0
+end
+local window_end = math.min(tonumber(newest), tonumber(ARGV[3]))
+redis.call('ZREMRANGEBYSCORE', KEYS[1], '-inf', '(' .. (window_end - tonumber(ARGV[1])))
+redis.call('EXPIRE', KEYS[1], ARGV[2])
+return redis.call('ZCARD', KEYS[1])
+""")
+
+
+def event_time(event: dict, now: float) -> float:
+    """Device time of an event in seconds; the server clock if the device's is implausible."""
+    if event.get('device_timestamp_us') is not None:
+        t = event['device_timestamp_us'] / 1_000_000
+    else:
+        t = event.get('device_timestamp') or now
+    return now if t > now + MAX_CLOCK_SKEW else t
+
+
+def zone_sensor_times(events: List[dict], now: float) -> Dict[int, Dict[str, float]]:
+    """Latest event time of every sensor, per zone, over the events that count."""
+    zones: Dict[int, Dict[str, float]] = {}
+    for e in events:
+        if not counts_towards_alert(e):
+            continue
+        sensors = zones.setdefault(e['zone_id'], {})
+        member = str(e['misurator_id'])
+        sensors[member] = max(sensors.get(member, 0.0), event_time(e, now))
+    return zones
+
+
+def update_windows(zone_sensors: Dict[int, Dict[str, float]], now: float) -> Dict[int, int]:
+    """Adds the sensor times to the zone windows; returns each zone's distinct sensors."""
+    pipe = redis_sync.pipeline()
+    for zone_id, sensors in zone_sensors.items():
+        key = f"zone:{zone_id}:sensors"
+        pipe.zadd(key, sensors, gt=True)  # GT: never moves a sensor back in time
+        WINDOW_COUNT(keys=[key], args=[ALERT_WINDOW_SECONDS, WINDOW_KEY_TTL, now], client=pipe)
+    return dict(zip(zone_sensors, pipe.execute()[1::2]))
+
+
+def process_events(events: List[dict]):
+    """
+    Persists a batch of events with one multi-row INSERT and updates the zone
+    windows with one Redis round-trip: the batch is reduced to one latest time
+    per sensor first, so a zone whose sensors all fire at once costs one ZADD.
+    """
+    if not events:
+        return
+
+    now = time.time()
+    zone_sensors = zone_sensor_times(events, now)
+    filtered = sum(1 for e in events if not counts_towards_alert(e))
+    if filtered:
+        print(f"🔇 {filtered} of {len(events)} events classified non-seismic by their sensors, not counted")
+
+    cooldowns: List[str] = []  # Cooldown flags claimed by this batch
+    with SessionLocal() as db:
+        # 1. Persist raw measurements to PostgreSQL (created_at is the DB default)
+        db.execute(insert(Misuration), [
+            {"value": e['value'], "misurator_id": e['misurator_id']} for e in events
+        ])
+
         try:
-            # Blocking pop from the tail of the list (waits until data is available)
-            _, data = redis_sync.brpop("seismic_events")
-            event = json.loads(data)
-            
-            zone_id = event['zone_id']
-            
-            with SessionLocal() as db:
-                # 1. Persist raw measurement to PostgreSQL
-                new_misuration = Misuration(
-                    value=event['value'],
-                    misurator_id=event['misurator_id']
-                    # created_at is handled automatically by DB default
-                )
-                db.add(new_misuration)
-                
-                # 2. Update real-time alert counter in Redis
-                # Key: "zone:{id}:alerts" -> Increments with every high-vibration event
-                zone_counter_key = f"zone:{zone_id}:alerts"
-                
-                pipe = redis_sync.pipeline()
-                pipe.incr(zone_counter_key)
-                pipe.expire(zone_counter_key, ALERT_WINDOW_SECONDS) 
-                # Execute and get the new counter value
-                results = pipe.execute()
-                current_count = results[0]
-
-                # 3. Check Threshold & Generate Alert
-                if current_count >= ALERT_THRESHOLD:
-                    # Check if we are in a "cooldown" period to avoid spamming the DB
-                    cooldown_key = f"zone:{zone_id}:alarm_cooldown"
-                    
-                    if not redis_sync.exists(cooldown_key):
-                        print(f"🚨 CRITICAL ALARM! Zone {zone_id} has {current_count} events!")
-                        
-                        # Create persistent Alert record
-                        new_alert = Alert(
+            if zone_sensors:
+                # 2. Update the sliding windows and count the distinct sensors in each
+                totals = update_windows(zone_sensors, now)
+
+                # 3. Check thresholds; the cooldown flag is claimed atomically (SET NX)
+                alarmed = [zone_id for zone_id, count in totals.items() if count >= ALERT_THRESHOLD]
+                if alarmed:
+                    pipe = redis_sync.pipeline()
+                    for zone_id in alarmed:
+                        pipe.set(f"zone:{zone_id}:alarm_cooldown", "active", nx=True, ex=ALERT_COOLDOWN)
+                    for zone_id, claimed in zip(alarmed, pipe.execute()):
+                        if not claimed:
+                            continue  # Still in the cooldown of an earlier alarm
+                        cooldowns.append(f"zone:{zone_id}:alarm_cooldown")
+                        current_count = totals[zone_id]
+                        print(f"🚨 CRITICAL ALARM! Zone {zone_id} has {current_count} sensors triggered "
+                              f"within {ALERT_WINDOW_SECONDS}s!")
+                        db.add(Alert(
                             zone_id=zone_id,
                             severity=float(current_count) / 10.0, # Example severity logic
                             message=f"Seismic Swarm Detected: {current_count} sensors triggered.",
                             timestamp=datetime.utcnow()
-                        )
-                        db.add(new_alert)
-                        
-                        # Set cooldown flag (expires in 60s)
-                        redis_sync.setex(cooldown_key, ALERT_COOLDOWN, "active")
-                
-                db.commit()
-                
+                        ))
+
+            db.commit()
+        except Exception:
+            release_cooldowns(cooldowns)
+            raise
+    record_traces(events)
+
+
+def release_cooldowns(keys: List[str]):
+    """
+    Gives back the cooldown flags of alerts that were never committed, so the
+    retried batch raises them. The zone is leased to this Worker, so nobody
+    else can have claimed them meanwhile. If Redis is down too the flags
+    expire by themselves.
+    """
+    if not keys:
+        return
+    try:
+        redis_sync.delete(*keys)
+    except redis.RedisError as e:
+        print(f"⚠️ Could not release alert cooldowns {keys}: {e}")
+
+
+TRACE_TTL = 3600  # Seconds the latency traces are kept
+
+
+def record_traces(events: List[dict]):
+    """
+    Stores the ingestion timestamps of traced events (API run with
+    LATENCY_TRACE=1) with the commit time, as trace:{misurator_id}:{seq},
+    for tests/latency_benchmark.py. Untraced events cost nothing.
+    """
+    traced = [e for e in events if e.get('trace') and e.get('seq')]
+    if not traced:
+        return
+    persisted = time.time()
+    pipe = redis_sync.pipeline(transaction=False)
+    for e in traced:
+        key = f"trace:{e['misurator_id']}:{e['seq']}"
+        pipe.hset(key, mapping={**e['trace'], "persisted": persisted})
+        pipe.expire(key, TRACE_TTL)
+    pipe.execute()
+
+
+# --------------------------------------------------------------------------
+# SHARD LEASES
+# --------------------------------------------------------------------------
+# A Worker only reads the streams it holds a lease on, so each zone is
+# processed by one Worker at a time, in order. Leases are renewed every
+# REBALANCE_SECONDS and expire after LEASE_SECONDS, so the shards of a Worker
+# that dies move to the others within LEASE_SECONDS.
+
+RENEW_LEASE = redis_sync.register_script("""
+if redis.call('GET', KEYS[1]) == ARGV[1] then
+    return redis.call('EXPIRE', KEYS[1], ARGV[2])
+end
+return 0
+""")
+
+RELEASE_LEASE = redis_sync.register_script("""
+if redis.call('GET', KEYS[1]) == ARGV[1] then
+    return redis.call('DEL', KEYS[1])
+end
+return 0
+""")
+
+
+class ShardLeases:
+    """
+    The shards this Worker owns. Each Worker aims for its fair share,
+    ceil(ZONE_SHARDS / live workers): it releases shards above that and takes
+    free ones below it. Live workers announce themselves in a sorted set
+    scored by their last rebalance.
+    """
+
+    def __init__(self, worker_id: str):
+        self.worker_id = worker_id
+        self.owned: Set[int] = set()
+
+    def rebalance(self) -> List[int]:
+        """Renews, releases and acquires leases. Returns the newly acquired shards."""
+        now = time.time()
+        pipe = redis_sync.pipeline()
+        pipe.zadd(WORKERS_KEY, {self.worker_id: now})
+        pipe.zremrangebyscore(WORKERS_KEY, "-inf", now - LEASE_SECONDS)
+        pipe.zcard(WORKERS_KEY)
+        live = pipe.execute()[2]
+
+        owned = sorted(self.owned)
+        renewed = [RENEW_LEASE(keys=[lease_key(shard)], args=[self.worker_id, LEASE_SECONDS]) for shard in owned]
+        for shard, ok in zip(owned, renewed):
+            if not ok:
+                print(f"⚠️ Lease on shard {shard} lost")
+                self.owned.discard(shard)
+
+        fair = math.ceil(ZONE_SHARDS / max(live, 1))
+        while len(self.owned) > fair:
+            self.release(max(self.owned))
+
+        acquired = []
+        offset = random.randrange(ZONE_SHARDS)  # Spread concurrent starts over different shards
+        for i in range(ZONE_SHARDS):
+            if len(self.owned) >= fair:
+                break
+            shard = (offset + i) % ZONE_SHARDS
+            if shard not in self.owned and redis_sync.set(lease_key(shard), self.worker_id, nx=True, ex=LEASE_SECONDS):
+                self.owned.add(shard)
+                acquired.append(shard)
+        if acquired or renewed.count(0):
+            print(f"🔀 Worker {self.worker_id} owns shards {sorted(self.owned)} ({live} workers)")
+        return acquired
+
+    def release(self, shard: int):
+        RELEASE_LEASE(keys=[lease_key(shard)], args=[self.worker_id])
+        self.owned.discard(shard)
+
+    def release_all(self):
+        for shard in list(self.owned):
+            self.release(shard)
+        redis_sync.zrem(WORKERS_KEY, self.worker_id)
+
+
+# --------------------------------------------------------------------------
+# STREAM CONSUMPTION
+# --------------------------------------------------------------------------
+# A batch is a list of (stream, entry ids, JSON events), one per stream.
+Batch = List[Tuple[str, List[str], List[str]]]
+
+
+def ensure_groups():
+    """Creates the consumer group on every shard stream (idempotent)."""
+    for stream in all_streams():
+        try:
+            redis_sync.xgroup_create(stream, EVENT_GROUP, id="0", mkstream=True)
+        except redis.ResponseError as e:
+            if "BUSYGROUP" not in str(e):
+                raise
+
+
+def migrate_legacy_queue():
+    """Moves events left in the single pre-stream list into their zone streams."""
+    moved = 0
+    while True:
+        data = redis_sync.rpop(LEGACY_QUEUE)
+        if data is None:
+            break
+        try:
+            zone_id = json.loads(data)['zone_id']
+        except (ValueError, KeyError, TypeError):
+            print(f"❌ Dropping malformed legacy event: {data[:80]}")
+            continue
+        redis_sync.xadd(stream_for_zone(zone_id), {EVENT_FIELD: data}, maxlen=STREAM_MAXLEN, approximate=True)
+        moved += 1
+    if moved:
+        print(f"📦 Moved {moved} events from the '{LEGACY_QUEUE}' list to the zone streams")
+
+
+def as_batch(replies) -> Batch:
+    batch = []
+    for stream, entries in replies or []:
+        entries = [(entry_id, fields) for entry_id, fields in entries if fields]  # Trimmed entries come back empty
+        if entries:
+            batch.append((stream, [e[0] for e in entries], [e[1][EVENT_FIELD] for e in entries]))
+    return batch
+
+
+def read_batch(worker_id: str, shards: List[int], batch_size: int, start: str = ">") -> Batch:
+    """
+    Reads the next events of the given shards: new ones (start ">"), or this
+    consumer's unacknowledged ones (start "0") to retry a failed batch.
+    Blocks up to STREAM_BLOCK_MS when there is nothing new.
+    """
+    if not shards:
+        time.sleep(STREAM_BLOCK_MS / 1000)
+        return []
+    count = max(1, batch_size // len(shards))
+    return as_batch(redis_sync.xreadgroup(
+        EVENT_GROUP, worker_id, {stream_key(shard): start for shard in shards},
+        count=count, block=STREAM_BLOCK_MS if start == ">" else None
+    ))
+
+
+def reclaim_shard(worker_id: str, shard: int, batch_size: int):
+    """
+    Processes the events a shard's previous owner read but never acknowledged,
+    before anything new from that shard, so its zones stay in order.
+    """
+    stream = stream_key(shard)
+    cursor = "0-0"
+    while True:
+        reply = redis_sync.xautoclaim(stream, EVENT_GROUP, worker_id, min_idle_time=0,
+                                      start_id=cursor, count=batch_size)
+        cursor, entries = reply[0], reply[1]
+        batch = as_batch([(stream, entries)])
+        if batch:
+            print(f"♻️ Reclaimed {len(batch[0][1])} unacknowledged events on shard {shard}")
+            process_batch(batch)
+        if cursor == "0-0":
+            return
+
+
+def is_outage(e: Exception) -> bool:
+    """
+    True when PostgreSQL or Redis is unreachable rather than the batch being
+    at fault: the batch is retried as it is, however long the outage lasts.
+    """
+    if isinstance(e, (redis.ConnectionError, redis.TimeoutError, OperationalError, InterfaceError)):
+        return True
+    return isinstance(e, DBAPIError) and e.connection_invalidated
+
+
+def dead_letter(stream: str, entry_id: str, data: str, error: str):
+    """
+    Moves an event that cannot be stored to DEAD_LETTER_STREAM, with where it
+    came from and why, and acknowledges it there and then (one transaction).
+    """
+    pipe = redis_sync.pipeline()
+    pipe.xadd(DEAD_LETTER_STREAM, {EVENT_FIELD: data, "stream": stream, "id": entry_id, "error": error[:200]},
+              maxlen=STREAM_MAXLEN, approximate=True)
+    pipe.xack(stream, EVENT_GROUP, entry_id)
+    pipe.execute()
+    print(f"☠️ Event {entry_id} of {stream} moved to {DEAD_LETTER_STREAM}: {error[:80]}")
+
+
+def process_batch(batch: Batch):
+    """
+    Processes the events of all streams in one pass, then acknowledges them.
+    Events that are not valid JSON cannot be stored and are dead-lettered.
+    """
+    events = []
+    for stream, ids, raw in batch:
+        for entry_id, data in zip(ids, raw):
+            try:
+                events.append(json.loads(data))
+            except ValueError:
+                dead_letter(stream, entry_id, data, "malformed JSON")
+    process_events(events)
+    pipe = redis_sync.pipeline(transaction=False)
+    for stream, ids, _ in batch:
+        pipe.xack(stream, EVENT_GROUP, *ids)
+    pipe.execute()
+
+
+def split_batch(batch: Batch):
+    """
+    Processes a batch that failed MAX_BATCH_ATTEMPTS times by halves, down to
+    single events, so the good events are stored and only the ones that fail
+    on their own are dead-lettered. Halves run left to right, so each zone's
+    events stay in order. An outage aborts the split: the events not stored
+    yet stay unacknowledged and the whole thing is retried.
+    """
+    entries = [(stream, entry_id, data) for stream, ids, raw in batch for entry_id, data in zip(ids, raw)]
+    if len(entries) == 1:
+        try:
+            process_batch(batch)
+        except Exception as e:
+            if is_outage(e):
+                raise
+            dead_letter(*entries[0], str(e) or type(e).__name__)
+        return
+    for half in (entries[:len(entries) // 2], entries[len(entries) // 2:]):
+        streams: Dict[str, Tuple[List[str], List[str]]] = {}
+        for stream, entry_id, data in half:
+            ids, raw = streams.setdefault(stream, ([], []))
+            ids.append(entry_id)
+            raw.append(data)
+        sub_batch = [(stream, ids, raw) for stream, (ids, raw) in streams.items()]
+        try:
+            process_batch(sub_batch)
         except Exception as e:
-            print(f"❌ Error processing event: {str(e)}")
-            time.sleep(1) # Prevent rapid-fire errors if DB/Redis connection drops
+            if is_outage(e):
+                raise
+            split_batch(sub_batch)
+
+
+def run_worker(batch_size: int = WORKER_BATCH_SIZE, worker_id: str = WORKER_ID):
+    """
+    Continuous loop consuming the zone streams this Worker holds a lease on
+    (see event_streams.py). Any number of Workers can run: shards are shared
+    out between them and move when one joins or leaves.
+    Stored waveforms ('waveform_events') are processed when no event is pending.
+
+    With batch_size > 1 the next batch is read while the current one is
+    written. Events are acknowledged only once written, so the events of a
+    Worker that dies are reclaimed by the shard's next owner (an event can
+    be processed twice if a Worker stalls past its lease). While PostgreSQL
+    or Redis is down the batch is retried with a growing delay (up to
+    MAX_BACKOFF_SECONDS), for as long as it takes. A batch that fails for any
+    other reason MAX_BATCH_ATTEMPTS times is split to dead-letter the events
+    at fault. Leases are only rebalanced between batches, never with a read
+    in flight.
+    """
+    print(f"👷 Worker {worker_id} started. Threshold: {ALERT_THRESHOLD} sensors / {ALERT_WINDOW_SECONDS}s, "
+          f"batches of up to {batch_size}, {ZONE_SHARDS} shards")
+
+    ensure_groups()
+    migrate_legacy_queue()
+    leases = ShardLeases(worker_id)
+    prefetch = ThreadPoolExecutor(max_workers=1)
+    pending: Optional[Future] = None
+    recovering = False  # Re-reading our unacknowledged events after an error
+    failures = 0        # Consecutive failed batches, outages excluded
+    outage_retries = 0  # Consecutive retries while storage is down
+
+    next_rebalance = 0.0
+    processed = 0
+    report_at = time.monotonic() + THROUGHPUT_REPORT_SECONDS
+    try:
+        while True:
+            try:
+                rebalance_due = time.monotonic() >= next_rebalance
+                if pending is None and rebalance_due:
+                    for shard in leases.rebalance():
+                        reclaim_shard(worker_id, shard, batch_size)
+                    next_rebalance = time.monotonic() + REBALANCE_SECONDS
+                    rebalance_due = False
+
+                shards = sorted(leases.owned)
+                if recovering:
+                    batch = read_batch(worker_id, shards, batch_size, start="0")
+                else:
+                    batch = pending.result() if pending else read_batch(worker_id, shards, batch_size)
+                pending = None
+
+                if not batch:
+                    if recovering:
+                        recovering = False
+                        continue
+                    # Idle: alert counting always goes first, waveforms one at a time
+                    waveform_id = redis_sync.rpop("waveform_events")
+                    if waveform_id is not None:
+                        process_waveform(int(waveform_id))
+                    continue
+
+                if batch_size > 1 and not rebalance_due and not recovering:
+                    pending = prefetch.submit(read_batch, worker_id, shards, batch_size)
+                if failures >= MAX_BATCH_ATTEMPTS:
+                    split_batch(batch)
+                else:
+                    process_batch(batch)
+                failures = outage_retries = 0
+
+                processed += sum(len(ids) for _, ids, _ in batch)
+                if time.monotonic() >= report_at and processed:
+                    print(f"📊 {processed} events in the last {THROUGHPUT_REPORT_SECONDS}s "
+                          f"({processed / THROUGHPUT_REPORT_SECONDS:.0f} events/s)")
+                    processed = 0
+                    report_at = time.monotonic() + THROUGHPUT_REPORT_SECONDS
+
+            except Exception as e:
+                print(f"❌ Error processing event: {str(e)}")
+                if "NOGROUP" in str(e):
+                    # Redis was flushed or restarted without persistence
+                    try:
+                        ensure_groups()
+                    except redis.RedisError:
+                        pass
+                if pending is not None:
+                    wait([pending])  # Its events stay unacknowledged and are retried below
+                    pending = None
+                recovering = True
+                if is_outage(e):
+                    delay = min(MAX_BACKOFF_SECONDS, 2 ** outage_retries)
+                    outage_retries += 1
+                    print(f"⏳ Storage unavailable, retrying in {delay}s")
+                    time.sleep(delay)
+                else:
+                    failures += 1
+                    time.sleep(1) # Prevent rapid-fire errors on a failing batch
+    finally:
+        prefetch.shutdown(wait=True)
+        leases.release_all()
+
+
+def stop_worker(signum, frame):
+    raise SystemExit(0)  # Unwinds run_worker so the leases are handed over at once
 
 if __name__ == "__main__":
+    signal.signal(signal.SIGTERM, stop_worker)
     # Optional: Wait for DB to be ready script could be added here similar to main.py
     # but usually the main API holds the fort until DB is up.
     time.sleep(5) # Give services a moment to warm up
@@ -0,0 +1,99 @@
+"""
+QuakeGuard Alert Retry Test
+---------------------------
+Checks that an alert survives a failed commit (worker.py, process_events()):
+the first attempt claims the zone's cooldown and then fails to commit, as it
+does while PostgreSQL is down. The retried batch must still write the Alert,
+and a later batch inside the cooldown must not write another one.
+
+PostgreSQL is replaced by an in-memory session; Redis is the stack's, on a
+scratch zone. Run it inside the stack:
+    docker compose run --rm worker python -m tests.alert_retry_test
+"""
+
+import sys
+import time
+from typing import List
+
+from sqlalchemy.exc import OperationalError
+
+from src import worker
+from src.models import Alert
+
+SCRATCH_ZONE = -2              # Never a real zone id
+
+redis_sync = worker.redis_sync
+
+
+class FakeSession:
+    """Stands in for SessionLocal(): records added rows, commits only if told to."""
+
+    def __init__(self, fail_commit: bool, committed: List[object]):
+        self.fail_commit = fail_commit
+        self.committed = committed
+        self.added: List[object] = []
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        return False
+
+    def execute(self, *args, **kwargs):
+        pass
+
+    def add(self, row):
+        self.added.append(row)
+
+    def commit(self):
+        if self.fail_commit:
+            raise OperationalError("COMMIT", {}, ConnectionRefusedError("database is down"))
+        self.committed.extend(self.added)
+
+
+def swarm(now: float) -> List[dict]:
+    """One alert's worth of distinct sensors firing in the scratch zone."""
+    return [{"misurator_id": i, "zone_id": SCRATCH_ZONE, "value": 500,
+             "device_timestamp_us": int(now * 1_000_000)} for i in range(worker.ALERT_THRESHOLD)]
+
+
+def attempt(events: List[dict], fail_commit: bool) -> int:
+    """Runs process_events() once; returns the number of Alert rows it committed."""
+    committed: List[object] = []
+    worker.SessionLocal = lambda: FakeSession(fail_commit, committed)
+    try:
+        worker.process_events(events)
+    except Exception as e:
+        if not worker.is_outage(e):
+            raise
+        print(f"   commit failed as planned ({type(e).__name__})")
+    return sum(1 for row in committed if isinstance(row, Alert))
+
+
+def main() -> int:
+    keys = [f"zone:{SCRATCH_ZONE}:sensors", f"zone:{SCRATCH_ZONE}:alarm_cooldown"]
+    redis_sync.delete(*keys)
+    session_local = worker.SessionLocal
+    events = swarm(time.time())
+    print(f"--- 🔁 QUAKEGUARD ALERT RETRY: {len(events)} sensors, zone {SCRATCH_ZONE} ---")
+    try:
+        cases = [
+            ("failed commit writes no alert", attempt(events, fail_commit=True), 0),
+            ("failed commit leaves the cooldown free", redis_sync.exists(keys[1]), 0),
+            ("retried batch writes the alert", attempt(events, fail_commit=False), 1),
+            ("next batch is in the cooldown", attempt(events, fail_commit=False), 0),
+        ]
+    finally:
+        worker.SessionLocal = session_local
+        redis_sync.delete(*keys)
+
+    failed = 0
+    for name, count, expected in cases:
+        ok = count == expected
+        failed += not ok
+        print(f"{'✅' if ok else '❌'} {name}: {count} (expected {expected})")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,296 @@
+"""
+QuakeGuard End-to-End Latency Benchmark
+---------------------------------------
+Measures the time from the trigger sample on a sensor to the alert, stage
+by stage, with a fleet of simulated sensors running the firmware's
+detector, feature window and binary wire format (tools/fleet in
+iot-data-harvester/esp32_code). Every event is timed through:
+
+    detect     trigger sample latched -> event queued (FIFO block, + feature window
+               with LATENCY_FEATURES=1)
+    sign       event queued -> frame signed (host OpenSSL: see below for the device)
+    transmit   frame signed -> request received by the API
+    verify     received -> signature verified
+    enqueue    verified -> appended to the zone stream
+    persist    appended -> committed by a Worker
+    end-to-end trigger sample latched -> committed
+
+and, per zone, the alert latency: from the trigger of the event that
+brought the zone to ALERT_THRESHOLD distinct sensors (and from the first
+trigger of the wave) to the Alert's timestamp.
+
+The on-device signing time is not measured here: the heartbeat's
+sign_ms_hist (GET /sensors/{id}/heartbeat) reports it from real nodes.
+
+Requirements:
+    - the stack running with LATENCY_TRACE=1 for the API:
+        LATENCY_TRACE=1 docker compose up -d
+    - the fleet build: cd iot-data-harvester/esp32_code && pio run -e fleet
+    - aiohttp, ecdsa and redis-py on the host
+    - the fleet, the API and the Workers on one host (or NTP-synced clocks)
+
+Run from backend-data-elaborator/api:
+    python -m tests.latency_benchmark
+
+Environment: LATENCY_DEVICES (default 240), LATENCY_ZONES (4),
+LATENCY_SPREAD_MS (2000, time for the wave to sweep the fleet),
+LATENCY_START / LATENCY_DURATION (20 / 30: seconds of the recording
+replayed), LATENCY_RECORDING (recording file, default: the synthetic
+scenario), LATENCY_FLEET (path of the fleet binary), LATENCY_FEATURES (0; 1 runs the
+fleet as firmware built with EVENT_FEATURES=1, to measure the feature window).
+Every run registers new zones and sensors: sequence numbers are remembered
+for a week, so a sensor cannot replay the same ones.
+"""
+
+import asyncio
+import math
+import os
+import random
+import tempfile
+import time
+import uuid
+from datetime import datetime, timezone
+from typing import Dict, List, Optional, Tuple
+
+import aiohttp
+import redis
+from ecdsa import SigningKey, NIST256p
+
+from src.event_streams import stream_backlog
+from src.wire_format import CONTENT_TYPE
+
+# --- CONFIGURATION PARAMETERS ---
+BASE_URL = os.getenv("BASE_URL", "http://localhost:8000")
+REDIS_URL = os.getenv("REDIS_URL", "redis://localhost:6379/0")
+NUM_DEVICES = int(os.getenv("LATENCY_DEVICES", "240"))
+NUM_ZONES = int(os.getenv("LATENCY_ZONES", "4"))
+SPREAD_MS = int(os.getenv("LATENCY_SPREAD_MS", "2000"))
+START_S = os.getenv("LATENCY_START", "20")
+DURATION_S = os.getenv("LATENCY_DURATION", "30")
+RECORDING = os.getenv("LATENCY_RECORDING")
+FLEET = os.getenv("LATENCY_FLEET", "../../iot-data-harvester/esp32_code/.pio/build/fleet/program")
+FEATURES = os.getenv("LATENCY_FEATURES", "0") == "1"
+ALERT_THRESHOLD = 50           # Must match src/worker.py
+TIMEOUT_SECONDS = 30
+DRAIN_TIMEOUT_SECONDS = 120
+
+STAGES = [
+    ("detect", "trigger", "queued"),
+    ("sign", "queued", "signed"),
+    ("transmit", "signed", "received"),
+    ("verify", "received", "verified"),
+    ("enqueue", "verified", "enqueued"),
+    ("persist", "enqueued", "persisted"),
+    ("end-to-end", "trigger", "persisted"),
+]
+
+
+class FleetDevice:
+    """A registered sensor: its key goes to the fleet, the public half to the API."""
+    def __init__(self, zone_id: int):
+        self.sk = SigningKey.generate(curve=NIST256p)
+        self.zone_id = zone_id
+        self.sensor_id: Optional[int] = None
+
+
+async def setup_fleet(session: aiohttp.ClientSession) -> Tuple[List[int], List[FleetDevice]]:
+    """Registers NUM_ZONES fresh zones and NUM_DEVICES sensors spread over them."""
+    run = uuid.uuid4().hex[:8]
+    zones = []
+    for k in range(NUM_ZONES):
+        async with session.post(f"{BASE_URL}/zones/", json={"city": f"LatencyBench-{run}-{k}"}) as resp:
+            resp.raise_for_status()
+            zones.append((await resp.json())["id"])
+
+    # Node i of the fleet starts i * spread / N after the first: alternate the
+    # zones so the wave sweeps every zone over the whole spread
+    devices = [FleetDevice(zones[i % NUM_ZONES]) for i in range(NUM_DEVICES)]
+
+    async def register(device: FleetDevice):
+        payload = {
+            "active": True,
+            "zone_id": device.zone_id,
+            "latitude": round(random.uniform(-90, 90), 6),
+            "longitude": round(random.uniform(-180, 180), 6),
+            "public_key_hex": device.sk.verifying_key.to_der().hex()
+        }
+        async with session.post(f"{BASE_URL}/misurators/", json=payload, timeout=TIMEOUT_SECONDS) as resp:
+            resp.raise_for_status()
+            device.sensor_id = (await resp.json())["id"]
+
+    await asyncio.gather(*[register(d) for d in devices])
+    return zones, devices
+
+
+def write_keys(devices: List[FleetDevice]) -> str:
+    """Keys file for the fleet: "misurator_id private_scalar_hex" per line."""
+    fd, path = tempfile.mkstemp(prefix="quakeguard-fleet-", suffix=".keys")
+    with os.fdopen(fd, "w") as f:
+        for d in devices:
+            f.write(f"{d.sensor_id} {d.sk.privkey.secret_multiplier:064x}\n")
+    return path
+
+
+async def run_fleet(session: aiohttp.ClientSession, keys_path: str) -> Tuple[List[dict], int]:
+    """
+    Runs the fleet and posts every frame as it comes out (the fleet paces
+    itself in real time). Returns the frames and the number of rejected posts.
+    """
+    args = [FLEET, "--keys", keys_path, "--spread-ms", str(SPREAD_MS), "--start", START_S, "--duration", DURATION_S]
+    if FEATURES:
+        args.append("--features")
+    if RECORDING:
+        args.append(RECORDING)
+    proc = await asyncio.create_subprocess_exec(*args, stdout=asyncio.subprocess.PIPE)
+
+    frames: List[dict] = []
+    posts = []
+    rejected = 0
+
+    async def post(body: bytes):
+        nonlocal rejected
+        try:
+            async with session.post(f"{BASE_URL}/misurations/", data=body, timeout=TIMEOUT_SECONDS,
+                                    headers={"Content-Type": CONTENT_TYPE}) as resp:
+                await resp.read()
+                if resp.status != 202:
+                    rejected += 1
+        except Exception:
+            rejected += 1
+
+    async for line in proc.stdout:
+        fields = line.decode().split()
+        if len(fields) != 7 or fields[0] != "frame":
+            continue
+        frames.append({
+            "misurator_id": int(fields[1]),
+            "seq": int(fields[2]),
+            "trigger": int(fields[3]) / 1e6,
+            "queued": int(fields[4]) / 1e6,
+            "signed": int(fields[5]) / 1e6,
+        })
+        posts.append(asyncio.create_task(post(bytes.fromhex(fields[6]))))
+
+    await proc.wait()
+    await asyncio.gather(*posts)
+    if proc.returncode != 0:
+        print(f"⚠️ The fleet exited with status {proc.returncode}")
+    return frames, rejected
+
+
+def wait_for_drain(client: "redis.Redis") -> bool:
+    deadline = time.monotonic() + DRAIN_TIMEOUT_SECONDS
+    while time.monotonic() < deadline:
+        if stream_backlog(client) == 0:
+            return True
+        time.sleep(0.05)
+    return False
+
+
+def attach_traces(client: "redis.Redis", frames: List[dict]) -> int:
+    """Adds the API and Worker timestamps to every frame. Returns how many were found."""
+    pipe = client.pipeline(transaction=False)
+    for f in frames:
+        pipe.hgetall(f"trace:{f['misurator_id']}:{f['seq']}")
+    found = 0
+    for f, trace in zip(frames, pipe.execute()):
+        if trace:
+            f.update({stage: float(t) for stage, t in trace.items()})
+            found += 1
+    return found
+
+
+def percentile(values: List[float], p: float) -> float:
+    """Nearest-rank percentile of sorted values."""
+    rank = max(1, min(len(values), math.ceil(p / 100 * len(values))))
+    return values[rank - 1]
+
+
+def print_row(name: str, values: List[float]):
+    values = sorted(values)
+    if not values:
+        print(f"{name:<22}{'-':>10}{'-':>10}{'-':>10}{0:>8}")
+        return
+    p50, p99, p999 = (percentile(values, p) * 1000 for p in (50, 99, 99.9))
+    print(f"{name:<22}{p50:>10.1f}{p99:>10.1f}{p999:>10.1f}{len(values):>8}")
+
+
+async def fetch_alerts(session: aiohttp.ClientSession, zones: List[int]) -> Dict[int, float]:
+    """Time of the first alert of every zone that raised one (Unix seconds)."""
+    alerts = {}
+    for zone_id in zones:
+        async with session.get(f"{BASE_URL}/zones/{zone_id}/alerts", params={"limit": 100}) as resp:
+            resp.raise_for_status()
+            stamps = [datetime.fromisoformat(a["timestamp"]) for a in await resp.json()]
+        if stamps:
+            first = min(stamps)
+            if first.tzinfo is None:
+                first = first.replace(tzinfo=timezone.utc)  # The Worker stores UTC
+            alerts[zone_id] = first.timestamp()
+    return alerts
+
+
+def alert_latencies(frames: List[dict], devices: List[FleetDevice],
+                    alerts: Dict[int, float]) -> Tuple[List[float], List[float]]:
+    """
+    Per alerted zone: alert time minus the trigger of the event that made
+    ALERT_THRESHOLD distinct sensors, and minus the first trigger.
+    """
+    zone_of = {d.sensor_id: d.zone_id for d in devices}
+    from_threshold, from_first = [], []
+    for zone_id, alert in alerts.items():
+        triggers = sorted((f["trigger"], f["misurator_id"]) for f in frames
+                          if zone_of.get(f["misurator_id"]) == zone_id and f["trigger"] <= alert)
+        seen = set()
+        for trigger, sensor in triggers:
+            seen.add(sensor)
+            if len(seen) == ALERT_THRESHOLD:
+                from_threshold.append(alert - trigger)
+                break
+        if triggers:
+            from_first.append(alert - triggers[0][0])
+    return from_threshold, from_first
+
+
+async def main():
+    print(f"--- ⏱️  QUAKEGUARD LATENCY BENCHMARK: {NUM_DEVICES} sensors, {NUM_ZONES} zones, "
+          f"{SPREAD_MS} ms spread ---")
+    if not os.path.exists(FLEET):
+        print(f"❌ Fleet binary not found at {FLEET}: pio run -e fleet (or set LATENCY_FLEET).")
+        return
+
+    client = redis.Redis.from_url(REDIS_URL, decode_responses=True)
+    async with aiohttp.ClientSession() as session:
+        zones, devices = await setup_fleet(session)
+        print(f"✅ SETUP COMPLETE: zones {zones}, {len(devices)} sensors registered.")
+        keys_path = write_keys(devices)
+        try:
+            print("🚀 Replaying the recording on the fleet...")
+            frames, rejected = await run_fleet(session, keys_path)
+        finally:
+            os.remove(keys_path)
+
+        if not await asyncio.get_running_loop().run_in_executor(None, wait_for_drain, client):
+            print(f"⚠️ The Workers did not drain the streams within {DRAIN_TIMEOUT_SECONDS}s")
+        traced = attach_traces(client, frames)
+        alerts = await fetch_alerts(session, zones)
+    client.close()
+
+    print(f"\n📨 {len(frames)} frames sent, {rejected} rejected, {traced} traced")
+    if frames and not traced:
+        print("⚠️ No traces found: is the API running with LATENCY_TRACE=1?")
+
+    print("\n" + "=" * 60)
+    print(f"{'stage (ms)':<22}{'p50':>10}{'p99':>10}{'p99.9':>10}{'n':>8}")
+    print("=" * 60)
+    for name, begin, end in STAGES:
+        print_row(name, [f[end] - f[begin] for f in frames if begin in f and end in f])
+    from_threshold, from_first = alert_latencies(frames, devices, alerts)
+    print_row(f"alert ({ALERT_THRESHOLD}th sensor)", from_threshold)
+    print_row("alert (first trigger)", from_first)
+    print("=" * 60)
+    print(f"🚨 {len(alerts)} of {NUM_ZONES} zones raised an alert")
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
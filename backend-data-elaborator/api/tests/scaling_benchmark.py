@@ -0,0 +1,149 @@
+"""
+QuakeGuard Worker Scaling Benchmark
+-----------------------------------
+Measures Worker throughput (events/sec) against the number of Worker
+processes. Events are written straight into the zone streams, spread over
+BENCH_ZONES zones (so over every shard), bypassing the API and its
+signature checks: only the Worker side is measured.
+
+For each worker count the benchmark starts that many Workers, waits until
+they have shared out the shards, queues BENCH_EVENTS events and times
+until every one is acknowledged.
+
+Run it inside the stack, with the regular worker stopped:
+    docker compose stop worker
+    docker compose run --rm worker python -m tests.scaling_benchmark
+
+Environment: BENCH_WORKERS (default "1,2,4,8"), BENCH_EVENTS (20000),
+BENCH_ZONES (32).
+"""
+
+import json
+import math
+import multiprocessing
+import os
+import random
+import signal
+import time
+from typing import List, Optional
+
+from src import worker
+from src.database import SessionLocal, engine
+from src.event_streams import ZONE_SHARDS, EVENT_FIELD, lease_key, stream_backlog, stream_for_zone
+from src.models import Zone, Misurator
+
+WORKER_COUNTS = [int(n) for n in os.getenv("BENCH_WORKERS", "1,2,4,8").split(",")]
+NUM_EVENTS = int(os.getenv("BENCH_EVENTS", "20000"))
+NUM_ZONES = int(os.getenv("BENCH_ZONES", "32"))
+ZONE_ID_BASE = 9000            # Benchmark zones: ZONE_ID_BASE .. ZONE_ID_BASE + NUM_ZONES - 1
+SETTLE_TIMEOUT_SECONDS = 60
+DRAIN_TIMEOUT_SECONDS = 600
+
+redis_sync = worker.redis_sync
+
+
+def setup_zones() -> List[dict]:
+    """Creates (or reuses) one zone with one sensor per benchmark zone."""
+    sensors = []
+    with SessionLocal() as db:
+        for zone_id in range(ZONE_ID_BASE, ZONE_ID_BASE + NUM_ZONES):
+            if db.get(Zone, zone_id) is None:
+                db.add(Zone(id=zone_id, city=f"BenchZone{zone_id}"))
+                db.flush()
+            misurator = db.query(Misurator).filter(Misurator.zone_id == zone_id).first()
+            if misurator is None:
+                misurator = Misurator(zone_id=zone_id, active=True, public_key_hex="benchmark")
+                db.add(misurator)
+                db.flush()
+            sensors.append({"misurator_id": misurator.id, "zone_id": zone_id})
+        db.commit()
+    engine.dispose()  # Workers are forked: they must not share the parent's connections
+    return sensors
+
+
+def enqueue(sensors: List[dict], count: int):
+    pipe = redis_sync.pipeline(transaction=False)
+    for i in range(count):
+        sensor = sensors[i % len(sensors)]
+        event = dict(sensor, value=random.randint(200, 900), device_timestamp=int(time.time()), features=None)
+        pipe.xadd(stream_for_zone(sensor["zone_id"]), {EVENT_FIELD: json.dumps(event)})
+        if i % 1000 == 999:
+            pipe.execute()
+    pipe.execute()
+
+
+def start_worker(worker_id: str):
+    signal.signal(signal.SIGTERM, worker.stop_worker)
+    worker.run_worker(worker_id=worker_id)
+
+
+def wait_until_settled(count: int) -> bool:
+    """True once every shard is leased and no Worker holds more than its fair share."""
+    fair = math.ceil(ZONE_SHARDS / count)
+    deadline = time.monotonic() + SETTLE_TIMEOUT_SECONDS
+    while time.monotonic() < deadline:
+        owners = redis_sync.mget([lease_key(shard) for shard in range(ZONE_SHARDS)])
+        if None not in owners and max(owners.count(o) for o in set(owners)) <= fair:
+            return True
+        time.sleep(0.2)
+    return False
+
+
+def run_round(sensors: List[dict], count: int) -> Optional[float]:
+    processes = [multiprocessing.Process(target=start_worker, args=(f"bench-{count}-{i}",)) for i in range(count)]
+    for p in processes:
+        p.start()
+    try:
+        if not wait_until_settled(count):
+            print(f"⚠️ {count} workers did not share out the shards within {SETTLE_TIMEOUT_SECONDS}s")
+            return None
+        start = time.perf_counter()
+        enqueue(sensors, NUM_EVENTS)
+        while stream_backlog(redis_sync) > 0:
+            if time.perf_counter() - start > DRAIN_TIMEOUT_SECONDS:
+                print(f"⚠️ {count} workers did not drain the streams within {DRAIN_TIMEOUT_SECONDS}s")
+                return None
+            time.sleep(0.05)
+        return time.perf_counter() - start
+    finally:
+        for p in processes:
+            p.terminate()  # SIGTERM: the Workers release their leases on the way out
+        for p in processes:
+            p.join()
+
+
+def main():
+    print(f"--- 👷 QUAKEGUARD WORKER SCALING: {NUM_EVENTS} events, {NUM_ZONES} zones, {ZONE_SHARDS} shards ---")
+    others = redis_sync.zrangebyscore(worker.WORKERS_KEY, time.time() - worker.LEASE_SECONDS, "+inf")
+    if others:
+        print(f"❌ Other workers are running ({', '.join(others)}): stop them first (docker compose stop worker).")
+        return
+    if stream_backlog(redis_sync) > 0:
+        print("❌ The zone streams are not empty: let the workers drain them first.")
+        return
+
+    sensors = setup_zones()
+    worker.ensure_groups()
+    results = []
+    for count in WORKER_COUNTS:
+        seconds = run_round(sensors, count)
+        results.append((count, seconds))
+        if seconds:
+            print(f"✅ {count} workers: {seconds:.2f} s")
+
+    baseline = next((NUM_EVENTS / s for _, s in results if s), None)  # Speedup is against the first row
+    print("\n" + "="*50)
+    print(f"📊 SCALING REPORT")
+    print("="*50)
+    print(f"{'Workers':>8} {'Seconds':>10} {'Events/sec':>12} {'Speedup':>8}")
+    for count, seconds in results:
+        if seconds is None:
+            print(f"{count:>8} {'-':>10} {'-':>12} {'-':>8}")
+            continue
+        rate = NUM_EVENTS / seconds
+        print(f"{count:>8} {seconds:>10.2f} {rate:>12.0f} {rate / baseline:>7.2f}x")
+    print("="*50)
+
+
+if __name__ == "__main__":
+    main()
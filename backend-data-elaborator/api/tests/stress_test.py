@@ -5,9 +5,14 @@ Performs a load test on the QuakeGuard Ingestion API.
 It simulates concurrent IoT devices generating ECDSA-signed payloads
 to verify the system's throughput and asynchronous processing capabilities.
 
+It also times how long the Workers take to drain the zone streams
+('seismic_events:{shard}'), which is their end-to-end throughput (if
+redis-py is installed and REDIS_URL points at the stack's Redis).
+
 Requirements:
     - aiohttp
     - ecdsa
+    - redis (optional, for the worker throughput)
 """
 
 import asyncio
@@ -15,15 +20,26 @@ import aiohttp
 import time
 import random
 import hashlib
+import os
 from ecdsa import SigningKey, NIST256p
 from ecdsa.util import sigencode_der  
 from typing import List, Optional, Tuple
 
+from src.event_streams import stream_backlog
+
+try:
+    import redis
+except ImportError:
+    redis = None
+
 # --- CONFIGURATION PARAMETERS ---
 BASE_URL = "http://localhost:8000"
 NUM_SENSORS = 100
 TEST_ZONE_ID = 1
 TIMEOUT_SECONDS = 30  
+ROUNDS = int(os.getenv("STRESS_ROUNDS", "10"))  # Each round sends one event per sensor
+REDIS_URL = os.getenv("REDIS_URL", "redis://localhost:6379/0")
+DRAIN_TIMEOUT_SECONDS = 120
 
 class VirtualSensor:
     """
@@ -150,8 +166,20 @@ async def send_measurement(
     except Exception as e:
         return 999, 0.0
 
+async def measure_drain(queue: "redis.Redis") -> Optional[float]:
+    """
+    Polls the zone streams until the Workers have processed every event.
+    Returns the time the streams were found drained, or None on timeout.
+    """
+    deadline = time.perf_counter() + DRAIN_TIMEOUT_SECONDS
+    while time.perf_counter() < deadline:
+        if await asyncio.get_running_loop().run_in_executor(None, stream_backlog, queue) == 0:
+            return time.perf_counter()
+        await asyncio.sleep(0.05)
+    return None
+
 async def main():
-    print(f"--- 🌋 QUAKEGUARD LOAD TEST: {NUM_SENSORS} CONCURRENT SENSORS ---")
+    print(f"--- 🌋 QUAKEGUARD LOAD TEST: {NUM_SENSORS} CONCURRENT SENSORS x {ROUNDS} ROUNDS ---")
     
     async with aiohttp.ClientSession() as session:
         # PHASE 1: Setup (Device Registration)
@@ -160,16 +188,29 @@ async def main():
             print("❌ No sensors registered. Aborting test.")
             return
 
-        print("⏳ Preparing payload (Thundering Herd simulation)...")
-        tasks = [send_measurement(session, s) for s in sensors]
-        
-        print("🚀 FIRE! Sending concurrent requests...")
+        queue = redis.Redis.from_url(REDIS_URL, decode_responses=True) if redis else None
+        if queue is None:
+            print("⚠️ redis-py not installed: worker throughput will not be measured.")
+
+        print("🚀 FIRE! Sending concurrent requests (Thundering Herd simulation)...")
         start_time = time.perf_counter()
-        
-        results = await asyncio.gather(*tasks)
-        
+
+        results = []
+        for _ in range(ROUNDS):
+            results += await asyncio.gather(*[send_measurement(session, s) for s in sensors])
+
         total_time = time.perf_counter() - start_time
 
+        drain_time = None
+        if queue is not None:
+            try:
+                drained_at = await measure_drain(queue)
+                drain_time = drained_at - start_time if drained_at else None
+            except Exception as e:
+                print(f"⚠️ Could not read the stream backlog: {e}")
+            finally:
+                queue.close()
+
     # --- METRICS & REPORTING ---
     success_count = sum(1 for status, _ in results if status == 202)
     fail_count = sum(1 for status, _ in results if status != 202)
@@ -185,9 +226,12 @@ async def main():
     print(f"✅ Success (HTTP 202):      {success_count}")
     print(f"❌ Failures:                {fail_count}")
     print(f"🐢 Avg Request Latency:     {avg_req_time*1000:.2f} ms")
+    if drain_time:
+        print(f"👷 Workers Drained Queue:   {drain_time:.4f} seconds after the first request")
+        print(f"👷 Worker Throughput:       {success_count / drain_time:.2f} events/sec")
     print("="*50)
 
-    if fail_count == 0 and success_count == len(sensors):
+    if fail_count == 0 and success_count == len(sensors) * ROUNDS:
         print("🏆 TEST PASSED: System handled the load successfully.")
     else:
         print("⚠️ TEST FAILED or PARTIAL: Check server logs for details.")
@@ -0,0 +1,72 @@
+"""
+QuakeGuard Zone Window Clock Skew Test
+--------------------------------------
+Checks that a sensor whose clock runs fast cannot evict the honest sensors
+of its zone from the alert window (worker.py, "ZONE WINDOWS"). Each case
+feeds events through the Worker's own zone_sensor_times() and
+update_windows() on a scratch zone and compares the distinct sensor count.
+PostgreSQL is not touched.
+
+Run it inside the stack:
+    docker compose run --rm worker python -m tests.window_skew_test
+"""
+
+import sys
+import time
+from typing import List
+
+from src import worker
+
+SCRATCH_ZONE = -1              # Never a real zone id
+HONEST_SENSORS = 50            # One alert's worth (ALERT_THRESHOLD)
+
+redis_sync = worker.redis_sync
+
+
+def count_after(events: List[dict], now: float) -> int:
+    """Distinct sensors in the scratch zone's window after one batch of events."""
+    key = f"zone:{SCRATCH_ZONE}:sensors"
+    redis_sync.delete(key)
+    try:
+        totals = worker.update_windows(worker.zone_sensor_times(events, now), now)
+        return totals.get(SCRATCH_ZONE, 0)
+    finally:
+        redis_sync.delete(key)
+
+
+def honest(now: float, age: float = 1.0) -> List[dict]:
+    """HONEST_SENSORS sensors with correct clocks, fired `age` seconds before now."""
+    return [{"misurator_id": i, "zone_id": SCRATCH_ZONE, "device_timestamp_us": int((now - age) * 1_000_000)}
+            for i in range(HONEST_SENSORS)]
+
+
+def fast(now: float, ahead: float) -> dict:
+    """One sensor whose clock runs `ahead` seconds fast."""
+    return {"misurator_id": HONEST_SENSORS, "zone_id": SCRATCH_ZONE, "device_timestamp": now + ahead}
+
+
+def main() -> int:
+    now = time.time()
+    window = worker.ALERT_WINDOW_SECONDS
+    cases = [
+        ("honest sensors only", honest(now), HONEST_SENSORS),
+        ("one sensor just inside the skew margin", honest(now) + [fast(now, worker.MAX_CLOCK_SKEW * 0.9)],
+         HONEST_SENSORS + 1),
+        ("one sensor a window ahead", honest(now) + [fast(now, window + 5)], HONEST_SENSORS + 1),
+        ("one sensor far ahead", honest(now) + [fast(now, 3600)], HONEST_SENSORS + 1),
+        ("stale sensors still age out", honest(now, age=window + 5) + [fast(now, window + 5)], 1),
+        ("a backlog is counted in device time", honest(now, age=60), HONEST_SENSORS),
+    ]
+
+    print(f"--- 🕒 QUAKEGUARD WINDOW SKEW: {window}s window, {worker.MAX_CLOCK_SKEW}s skew margin ---")
+    failed = 0
+    for name, events, expected in cases:
+        count = count_after(events, now)
+        ok = count == expected
+        failed += not ok
+        print(f"{'✅' if ok else '❌'} {name}: {count} sensors (expected {expected})")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,150 @@
+/**
+ * Module: ADXL345 FIFO Acquisition Driver
+ * Target Hardware: ESP32-C3 SuperMini + ADXL345
+ *
+ * Description:
+ * Register-level access to the ADXL345 32-entry FIFO in STREAM mode.
+ * The sensor raises a WATERMARK interrupt on INT1 once the configured number
+ * of samples is buffered; the ISR only notifies the acquisition task, which
+ * then drains the FIFO with one 6-byte burst per entry (X0..Z1).
+ *
+ * Sample spacing is therefore defined by the sensor's own output data rate
+ * clock instead of the FreeRTOS tick. The ISR also stamps the watermark edge
+ * with esp_timer_get_time(): at that instant entry watermark-1 of the next
+ * drain had just been latched, which dates the whole block to within the
+ * interrupt latency instead of the drain time.
+ *
+ * The registers are reached over I2C (attach(TwoWire&)) or 4-wire SPI
+ * (attach(SPIClass&), mode 3, up to 5 MHz). Over SPI at 5 MHz one FIFO entry
+ * takes ~20 µs instead of ~250 µs at 400 kHz I2C.
+ *
+ * For light sleep (LOW_POWER, see power_manager.h) enableWakeup() switches
+ * INT1 to a high-level interrupt that is also a GPIO wakeup source: an edge
+ * can be lost while the GPIO block is clock-gated, a level cannot. The ISR
+ * masks the pin and drain() unmasks it once the FIFO is below the watermark.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_ADXL345_U.h>
+#include "i2c_bus.h"
+#include "quake_types.h"
+
+// --------------------------------------------------------------------------
+// FIFO / INTERRUPT BIT FIELDS
+// --------------------------------------------------------------------------
+// Register addresses (ADXL345_REG_*) come from the Adafruit driver header.
+#define ADXL345_INT_OVERRUN       0x01
+#define ADXL345_INT_WATERMARK     0x02
+#define ADXL345_FIFO_MODE_BYPASS  0x00
+#define ADXL345_FIFO_MODE_STREAM  0x80
+#define ADXL345_FIFO_DEPTH        32
+#define ADXL345_DEVICE_ID         0xE5
+#define ADXL345_SPI_READ          0x80
+#define ADXL345_SPI_MULTI         0x40
+#define ADXL345_SPI_MAX_HZ        5000000
+#define ADXL345_FIFO_POP_US       5     // SPI above 1.6 MHz: CS high this long before the next entry
+
+class Adxl345Fifo {
+public:
+    /**
+     * @brief Selects I2C as the register transport. No bus traffic.
+     * @param wire I2C bus the sensor is attached to (already started).
+     * @param addr 7-bit I2C address detected in setup() (0x53 or 0x1D).
+     * @param health Bus monitor that counts every transfer result (optional).
+     */
+    void attach(TwoWire &wire, uint8_t addr, I2cBus *health = NULL);
+
+    /**
+     * @brief Selects 4-wire SPI as the register transport. No bus traffic.
+     * @param spi SPI host with SCK/MISO/MOSI already routed (spi.begin()).
+     * @param csPin GPIO wired to the sensor CS pin (driven here).
+     * @param clockHz SCLK, capped at ADXL345_SPI_MAX_HZ.
+     */
+    void attach(SPIClass &spi, int csPin, uint32_t clockHz);
+
+    /**
+     * @brief Configures data rate, STREAM mode and the watermark interrupt.
+     * Call after attach().
+     * @param rateCode ADXL345 BW_RATE code (e.g. ADXL345_DATARATE_100_HZ).
+     * @param watermark FIFO level (1..31) that raises the interrupt.
+     * @param intPin ESP32 GPIO wired to the sensor INT1 pin (-1 = polled).
+     * @param task Task notified from the ISR on every watermark edge.
+     * @return true if the sensor acknowledged the configuration.
+     */
+    bool begin(uint8_t rateCode, uint8_t watermark, int intPin, TaskHandle_t task);
+
+    /**
+     * @brief true if the DEVID register reads 0xE5 over the attached transport.
+     */
+    bool identify();
+
+    /**
+     * @brief One DATAX0..DATAZ1 burst (pops one FIFO entry in STREAM mode).
+     * Used by the bus benchmark; acquisition goes through drain().
+     */
+    bool readSample(RawSample &out) { return readEntry(out); }
+
+    /**
+     * @brief Makes INT1 wake the chip from light sleep (level-triggered).
+     * Call after begin(); requires an interrupt pin.
+     * @return false if the pin cannot be used as a wakeup source.
+     */
+    bool enableWakeup();
+
+    /**
+     * @brief Returns the FIFO to BYPASS mode and detaches the interrupt.
+     */
+    void end();
+
+    /**
+     * @brief Number of entries currently buffered in the sensor FIFO.
+     */
+    uint8_t entries();
+
+    /**
+     * @brief Drains up to maxSamples entries from the FIFO.
+     * @return Number of samples written to out.
+     */
+    size_t drain(RawSample *out, size_t maxSamples);
+
+    /**
+     * @brief esp_timer time (µs) of the latest watermark interrupt.
+     * Read after the task was notified: the next edge is a block away.
+     */
+    int64_t watermarkUs() const { return lastWatermarkUs; }
+
+    /** Samples lost because the FIFO filled before it was drained. */
+    uint32_t overruns() const { return overrunCount; }
+
+    /** Burst reads that were not fully acknowledged by the sensor. */
+    uint32_t busErrors() const { return busErrorCount; }
+
+private:
+    bool writeRegister(uint8_t reg, uint8_t value);
+    int  readRegister(uint8_t reg);
+    bool readEntry(RawSample &out);
+    uint8_t finish(uint8_t status);
+    void spiTransfer(uint8_t command, uint8_t *data, size_t len);
+
+    static void IRAM_ATTR onWatermark();
+    static void IRAM_ATTR onWatermarkLevel();
+
+    TwoWire *bus = NULL;            // Exactly one of bus / spiBus is set
+    I2cBus *busHealth = NULL;
+    SPIClass *spiBus = NULL;
+    int chipSelect = -1;
+    uint32_t spiHz = 0;
+    uint8_t address = 0;
+    int interruptPin = -1;
+    uint32_t overrunCount = 0;
+    uint32_t busErrorCount = 0;
+    bool levelWake = false;
+
+    static TaskHandle_t notifyTask;
+    static volatile int64_t lastWatermarkUs;
+    static int levelPin;
+};
@@ -0,0 +1,87 @@
+/**
+ * Module: Connectivity Manager
+ * Target Hardware: ESP32-C3 SuperMini
+ *
+ * Description:
+ * Wi-Fi association, reconnection and NTP sync, driven by the Wi-Fi and SNTP
+ * event callbacks instead of a blocking loop in the network task:
+ * - begin() starts the connect and returns immediately.
+ * - A disconnect schedules WiFi.reconnect() on a one-shot FreeRTOS timer with
+ *   exponential back-off (0.5 s .. 30 s), so retries never run on the event
+ *   path and never stall the network task.
+ * - The state lives in an event group: tasks test ready() or block in
+ *   waitReady(), which returns as soon as the link and the clock are usable.
+ *
+ * "Ready" means IP obtained and wall-clock time valid (first SNTP sync, or a
+ * clock that survived a software reset). Event timestamps are reconstructed
+ * from the wall clock, so nothing is signed before that.
+ *
+ * Each SNTP sync is also handed to the Timebase (timebase.h), which turns
+ * trigger stamps into µs Unix time. SNTP polls every CONN_SNTP_INTERVAL_MS
+ * (instead of the 1 h default) so the drift estimate converges within hours.
+ *
+ * Counters: disconnects, last / worst reconnect latency (link lost -> IP
+ * obtained), time to the first sync. report() prints them.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+// Wall-clock values below this (2020-09) mean the clock was never set
+#define CONN_MIN_VALID_UNIX 1600000000
+#define CONN_SNTP_INTERVAL_MS (15UL * 60UL * 1000UL)
+
+class Timebase;
+
+class Connectivity {
+public:
+    /**
+     * @brief Registers the callbacks, starts SNTP and the first connect.
+     * Non-blocking. Call once, from the task that owns the network.
+     * @param timebase Receives every SNTP sync (optional).
+     */
+    void begin(const char *ssid, const char *pass, const char *ntp1, const char *ntp2,
+               Timebase *timebase = NULL);
+
+    /** IP obtained (the socket layer is usable). */
+    bool linkUp() const;
+
+    /** Link up and wall-clock time valid: events can be signed and sent. */
+    bool ready() const;
+
+    /**
+     * @brief Blocks until ready() or the timeout expires.
+     * @return ready()
+     */
+    bool waitReady(TickType_t timeout);
+
+    uint32_t disconnects() const { return disconnectCount; }
+    uint32_t lastReconnectMs() const { return lastReconnect; }
+    uint32_t maxReconnectMs() const { return maxReconnect; }
+
+    /**
+     * @brief Prints link state and reconnect statistics.
+     */
+    void report() const;
+
+private:
+    static void onWifiEvent(arduino_event_id_t event, arduino_event_info_t info);
+    static void onTimeSync(struct timeval *tv);
+    static void onRetryTimer(TimerHandle_t timer);
+    void scheduleRetry();
+
+    EventGroupHandle_t state = NULL;
+    Timebase *clock = NULL;
+    TimerHandle_t retryTimer = NULL;
+    uint32_t backoffMs = 0;
+    bool everConnected = false;
+    int64_t downSinceUs = 0;          // Link loss time (0 while up)
+    uint32_t disconnectCount = 0;
+    uint32_t lastReconnect = 0;       // ms
+    uint32_t maxReconnect = 0;        // ms
+    uint32_t firstSyncMs = 0;         // ms after boot, 0 until synced
+
+    static Connectivity *instance;    // Callbacks carry no context pointer
+};
@@ -0,0 +1,151 @@
+/**
+ * Module: Store-and-Forward Event Journal
+ * Target Hardware: ESP32-C3 SuperMini (4 MB flash)
+ *
+ * Description:
+ * Append-only ring of trigger records in a raw flash partition, so events
+ * survive both a server outage and a reboot. The sensor task only assigns a
+ * sequence number and queues the record (append()); a low-priority writer
+ * task batches the queue into flash, so no flash operation runs on the
+ * sensor path.
+ *
+ * Layout: the partition is a ring of 4 KB sectors. Slot 0 of every sector
+ * is a header (magic, sector counter, first sequence number); slots 1..127
+ * hold one 32-byte record each, CRC-protected, in sequence order. Records
+ * are written once and never modified. When the head sector is full the
+ * next sector in the ring is erased and reused, so every sector is erased
+ * once per lap of the ring (wear levelling by construction). A record's slot
+ * follows from its sequence number, so lookups need no index.
+ *
+ * Delivery is tracked by a cursor in NVS ("all sequence numbers up to N were
+ * acknowledged"), written once per delivered burst. After a reboot every
+ * record above the cursor is replayed. Sequence numbers are unique per
+ * sensor across reboots, so the backend can drop duplicates (a burst that
+ * was delivered but whose acknowledgement was lost is sent again).
+ *
+ * Partition: label "journal" if the partition table has one, otherwise the
+ * data/spiffs partition of the default Arduino table (the firmware uses no
+ * file system).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "esp_partition.h"
+
+#define JOURNAL_SECTOR_SIZE   4096
+#define JOURNAL_RECORD_SIZE   32
+#define JOURNAL_SLOTS         (JOURNAL_SECTOR_SIZE / JOURNAL_RECORD_SIZE) // Slot 0 = header
+#define JOURNAL_RECORDS       (JOURNAL_SLOTS - 1)                         // Per sector
+#define JOURNAL_MAX_SECTORS   1024
+#define JOURNAL_QUEUE_DEPTH   16  // Records waiting for the writer task
+#define JOURNAL_TIME_UNKNOWN  0   // unix_time of a record written before the clock was set
+
+/**
+ * @brief One journaled trigger (32 bytes on flash, little-endian).
+ */
+struct JournalRecord {
+    uint32_t seq;        // Sequence number, never reused
+    uint32_t boot_id;    // Boot counter at trigger time
+    uint32_t uptime_ms;  // millis() at trigger time
+    uint32_t unix_time;  // Wall clock at trigger time (JOURNAL_TIME_UNKNOWN if not set)
+    float magnitude;     // STA/LTA ratio, bit-exact
+    uint32_t unix_usec;  // Microseconds within unix_time (timebase.h)
+    uint32_t sample_index; // Sensor sample counter at the trigger sample
+    uint32_t crc;        // CRC-32 over the first 28 bytes
+};
+
+class EventJournal {
+public:
+    /**
+     * @brief Mounts the ring: finds the newest sector, the write position and
+     * the delivery cursor. Call once in setup(), before the tasks start.
+     * @return false if no usable partition was found (journal disabled).
+     */
+    bool begin();
+
+    bool ready() const { return part != NULL; }
+
+    /**
+     * @brief Sensor task: assigns the next sequence number and queues the
+     * record for the writer. Never blocks and never touches flash.
+     * @param unix_us Trigger time in Unix µs, 0 if the clock is not set.
+     * @return Sequence number, or 0 if the journal is disabled.
+     */
+    uint32_t append(float magnitude, uint32_t uptime_ms, int64_t unix_us, uint32_t sample_index);
+
+    /**
+     * @brief Writer task body (pvParameter: the EventJournal).
+     */
+    static void writerTask(void *pvParameters);
+
+    /**
+     * @brief Reads persisted records with seq >= fromSeq, oldest first.
+     * Records that were torn by a power cut or already overwritten by the
+     * ring are skipped and counted.
+     * @param scanEnd Receives the first sequence number not examined.
+     * @return Number of records copied to out.
+     */
+    size_t read(uint32_t fromSeq, JournalRecord *out, size_t max, uint32_t *scanEnd);
+
+    /**
+     * @brief Moves the delivery cursor: every seq <= seq is acknowledged.
+     */
+    void acknowledge(uint32_t seq);
+
+    uint32_t acked() const { return ackedSeq; }
+
+    /** One past the newest record on flash. */
+    uint32_t writtenEnd() const { return writeEnd; }
+
+    /** true if flash holds records above the delivery cursor. */
+    bool pending() const { return ready() && ackedSeq + 1 < writeEnd; }
+    uint32_t pendingCount() const { return pending() ? writeEnd - 1 - ackedSeq : 0; }
+
+    uint32_t bootId() const { return boot; }
+
+    /** Writer queue (depth monitoring). */
+    QueueHandle_t writeQueue() const { return queue; }
+
+    /**
+     * @brief Prints capacity, cursor and loss counters.
+     */
+    void report() const;
+
+private:
+    struct SectorHeader {
+        uint32_t magic;
+        uint32_t sector_seq; // Increases by one each time a sector is (re)used
+        uint32_t first_seq;  // Sequence number of slot 1
+        uint32_t crc;
+    };
+
+    bool readHeader(uint32_t sector, SectorHeader &h) const;
+    bool openSector(uint32_t sector, uint32_t sectorSeq, uint32_t firstSeq);
+    bool locate(uint32_t seq, uint32_t *offset) const;
+    void writeBatch(JournalRecord *records, size_t count);
+
+    const esp_partition_t *part = NULL;
+    uint32_t sectors = 0;
+    QueueHandle_t queue = NULL;
+    SemaphoreHandle_t lock = NULL;   // Head position: writer task vs. read()
+    Preferences prefs;
+
+    // Head of the ring (writer task, under lock)
+    uint32_t headSector = 0;
+    uint32_t headSectorSeq = 0;
+    uint32_t headFirstSeq = 1;
+    uint32_t writeEnd = 1;           // Next sequence number to be written
+
+    uint32_t nextSeq = 1;            // Next number handed out by append() (sensor task)
+    uint32_t ackedSeq = 0;
+    uint32_t boot = 0;
+
+    // Counters
+    volatile uint32_t queueDrops = 0; // Writer queue full: record never reached flash
+    uint32_t written = 0;
+    uint32_t writeErrors = 0;
+    uint32_t overwritten = 0;        // Undelivered records erased by the ring
+    uint32_t corrupt = 0;            // Torn or missing records met on replay
+};
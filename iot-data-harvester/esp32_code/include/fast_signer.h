@@ -0,0 +1,116 @@
+/**
+ * Module: Fast ECDSA Signer (SECP256R1)
+ * Target Hardware: ESP32-C3 SuperMini
+ *
+ * Description:
+ * Moves the expensive part of ECDSA off the trigger-to-transmit path.
+ *
+ * An ECDSA signature is (r, s) with r = (k*G).x mod n and
+ * s = k^-1 * (e + r*d) mod n. The point multiplication k*G dominates the
+ * cost and does not depend on the message, so a low-priority task
+ * precomputes (r, (k*b)^-1, b) triples ("pre-signatures") while the system
+ * is idle. At trigger time sign() only performs the final modular
+ * arithmetic, s = (k*b)^-1 * (b*e + r*(b*d)), with b a fresh random
+ * blinding factor per signature: the non-constant-time bignum code never
+ * sees the private key d or k^-1 unblinded.
+ *
+ * If the pool is empty (e.g. a burst of events right after boot) sign()
+ * falls back to RFC 6979 deterministic ECDSA on the long-lived key group,
+ * whose fixed-base comb table mbedtls caches across calls.
+ *
+ * Concurrency:
+ * - Pre-signatures flow through an SpscRing: refill() is the only producer
+ *   (presign task), sign() the only consumer (network task).
+ * - The refill side owns a private ECP group and DRBG, so the two tasks never
+ *   share mutable mbedtls state. Every pre-signature is used exactly once.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/pk.h"
+#include "spsc_ring.h"
+
+#define PRESIG_POOL_SIZE 8  // Power of two (SpscRing)
+#define ECDSA_P256_BYTES 32
+
+class FastSigner {
+public:
+    /**
+     * @brief Binds the signer to the device key and seeds the presign DRBG.
+     * @param pk Loaded device key (SECP256R1).
+     * @param rng DRBG used by the RFC 6979 fallback (network task side).
+     * @return false if the key is not an EC key or seeding failed.
+     */
+    bool begin(mbedtls_pk_context *pk,
+               int (*rng)(void *, unsigned char *, size_t), void *rngCtx);
+
+    /**
+     * @brief Precomputes pre-signatures until the pool is full.
+     * Called only from the low-priority presign task.
+     * @return Number of pre-signatures added.
+     */
+    size_t refill();
+
+    /**
+     * @brief Body of the presign task: refills, then sleeps until sign()
+     * consumes an entry.
+     */
+    static void presignTask(void *pvParameters);
+
+    /**
+     * @brief Signs a SHA-256 digest.
+     * @param rs Receives the raw 64-byte r||s signature.
+     * @param fromPool Set to true if a pre-signature was used.
+     * @return 0 on success, mbedtls error code otherwise.
+     */
+    int signRaw(const uint8_t hash[32], uint8_t rs[2 * ECDSA_P256_BYTES], bool *fromPool);
+
+    /**
+     * @brief Signs a SHA-256 digest and DER-encodes the result.
+     * @return DER length (0 on failure).
+     */
+    size_t signDer(const uint8_t hash[32], uint8_t *der, size_t derSize, bool *fromPool);
+
+    /** true once begin() succeeded. */
+    bool ready() const { return key != NULL; }
+
+    /** Pre-signatures currently available. */
+    size_t poolLevel() const { return pool.size(); }
+
+    /** Signatures that had to take the slow path because the pool was empty. */
+    uint32_t poolMisses() const { return misses; }
+
+    /**
+     * @brief DER-encodes a raw r||s signature (ASN.1 SEQUENCE of two INTEGERs).
+     * @return DER length (at most MBEDTLS_ECDSA_MAX_LEN).
+     */
+    static size_t derEncode(const uint8_t rs[2 * ECDSA_P256_BYTES], uint8_t *der, size_t derSize);
+
+private:
+    struct PreSignature {
+        uint8_t r[ECDSA_P256_BYTES];
+        uint8_t kbinv[ECDSA_P256_BYTES]; // (k*b)^-1 mod n
+        uint8_t b[ECDSA_P256_BYTES];     // Blinding factor
+    };
+
+    bool computePreSignature(PreSignature &out);
+    int finish(const PreSignature &ps, const uint8_t hash[32], uint8_t rs[2 * ECDSA_P256_BYTES]);
+    int signDeterministic(const uint8_t hash[32], uint8_t rs[2 * ECDSA_P256_BYTES]);
+
+    mbedtls_ecp_keypair *key = NULL;
+    int (*fallbackRng)(void *, unsigned char *, size_t) = NULL;
+    void *fallbackRngCtx = NULL;
+
+    // Presign-task-owned state
+    mbedtls_ecp_group presignGroup;
+    mbedtls_entropy_context presignEntropy;
+    mbedtls_ctr_drbg_context presignDrbg;
+
+    SpscRing<PreSignature, PRESIG_POOL_SIZE> pool;
+    TaskHandle_t refillTask = NULL;
+    uint32_t misses = 0;
+};
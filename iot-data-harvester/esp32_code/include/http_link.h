@@ -0,0 +1,92 @@
+/**
+ * Module: Persistent HTTP/1.1 Link
+ * Target Hardware: ESP32-C3 SuperMini
+ *
+ * Description:
+ * Keeps one warm keep-alive TCP connection to the ingestion API so a trigger
+ * does not pay a TCP handshake before its POST. Requests can be pipelined:
+ * several sendPost() calls are written back-to-back and their responses are
+ * collected afterwards with readResponse(), in order.
+ *
+ * The link is re-established in the background by maintain(), which the
+ * network task calls while it is idle, so the socket is normally already
+ * open when the next event arrives.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+// Request head + body are assembled here and sent with a single write.
+#define LINK_TX_BUF_SIZE 2048
+
+class HttpLink {
+public:
+    HttpLink(const char *host, uint16_t port);
+
+    /**
+     * @brief Opens the socket if it is not already connected.
+     * @return true if a usable connection is available.
+     */
+    bool ensureConnected();
+
+    /**
+     * @brief Idle-time upkeep: reconnects a dropped socket (rate-limited).
+     */
+    void maintain();
+
+    /**
+     * @brief Closes the socket. Used after protocol errors or Connection: close.
+     */
+    void close();
+
+    bool connected();
+
+    /**
+     * @brief Writes one POST request without waiting for the response.
+     * Head and body are assembled in the static transmit buffer and handed
+     * to the socket in one write (no heap allocation).
+     * @return false if the request does not fit or the socket rejected it.
+     */
+    bool sendPost(const char *path, const char *contentType, const uint8_t *body, size_t len);
+
+    /**
+     * @brief Writes one GET request without waiting for the response.
+     */
+    bool sendGet(const char *path);
+
+    /**
+     * @brief Reads the next pipelined response.
+     * @param body If set, receives the NUL-terminated body. A body that does
+     *        not fit in bodySize is drained and returned empty.
+     * @return HTTP status code, or -1 on timeout / malformed response. A
+     *         body cut short or an invalid Content-Length also returns -1
+     *         and closes the socket, so the pipeline cannot desync.
+     */
+    int readResponse(uint32_t timeout_ms, char *body = NULL, size_t bodySize = 0);
+
+    /** true if the last ensureConnected() reused an already open socket. */
+    bool reused() const { return lastReused; }
+
+    /** Time spent in the last TCP connect, in ms. */
+    uint32_t lastConnectMs() const { return connectMs; }
+
+    /** Slowest TCP connect since boot, in ms. */
+    uint32_t maxConnectMs() const { return worstConnectMs; }
+
+    uint32_t connectCount() const { return connects; }
+
+private:
+    bool readLine(char *buf, size_t size, unsigned long deadline);
+
+    WiFiClient client;
+    uint8_t txBuf[LINK_TX_BUF_SIZE];
+    const char *host;
+    uint16_t port;
+    unsigned long lastAttempt = 0;
+    bool lastReused = false;
+    uint32_t connectMs = 0;
+    uint32_t worstConnectMs = 0;
+    uint32_t connects = 0;
+};
@@ -0,0 +1,142 @@
+/**
+ * Module: Adaptive I2C Bus
+ * Target Hardware: ESP32-C3 SuperMini + ADXL345
+ *
+ * Description:
+ * Owns the sensor bus (Wire on the fixed SDA/SCL pins) and keeps it at the
+ * fastest clock it runs cleanly at. The bus starts at 400 kHz (ADXL345 fast
+ * mode) and every transfer, plus every dropout frame the acquisition sees
+ * (magnitude below the detector's dropout threshold: zeros from a bus that
+ * stopped answering), is counted in one-second windows. service() closes a
+ * window and reacts to it:
+ * - A second with I2C_ERROR_BUDGET or more errors runs the bus recovery
+ *   (SCL clocked until the slave releases SDA, a STOP, then a driver
+ *   restart) at the same clock.
+ * - A second bad second in a row steps the clock one rung down the ladder
+ *   (400 kHz -> 100 kHz -> 10 kHz), never below the floor the sample rate
+ *   needs (I2C_BITS_PER_SAMPLE bits per sample must fit in a second).
+ * - After stepUpHold clean seconds the next faster rung is tried again. A
+ *   step down soon after such a try doubles the hold (up to
+ *   I2C_STEP_UP_MAX_S), so a marginal bus settles instead of oscillating.
+ *
+ * All bus traffic runs in the sensor task, so service() restarts the driver
+ * without a lock. The counters are read by report() in the network task.
+ * With adaptive = false the clock stays fixed; recovery still runs.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#ifndef I2C_ERROR_BUDGET
+  #define I2C_ERROR_BUDGET      3     // Errors in one second that count as a bad second
+#endif
+#ifndef I2C_STEP_UP_S
+  #define I2C_STEP_UP_S         300   // Clean seconds before a faster clock is tried
+#endif
+#define I2C_STEP_UP_MAX_S       3600
+#define I2C_TIMEOUT_MS          10    // Driver timeout: a stuck bus fails fast, not in 50 ms
+#define I2C_BITS_PER_SAMPLE     100   // One FIFO entry: 9 bytes x 9 bits + start/stop, with margin
+#define I2C_MAX_RUNGS           4
+
+// endTransmission() codes (Arduino-ESP32) and the one result it has no code for
+#define I2C_STATUS_OK           0
+#define I2C_STATUS_NACK_ADDR    2
+#define I2C_STATUS_NACK_DATA    3
+#define I2C_STATUS_TIMEOUT      5
+#define I2C_STATUS_SHORT_READ   0xFF  // requestFrom() returned fewer bytes than asked
+
+/**
+ * @brief Error and recovery counts of one window (or since boot).
+ */
+struct BusCounters {
+    uint32_t transfers;
+    uint32_t nacks;
+    uint32_t timeouts;    // Driver timeouts and short reads (SCL or SDA held)
+    uint32_t dropouts;    // Frames below the dropout threshold
+    uint32_t recoveries;  // Bus recovery sequences run
+    uint32_t stepsDown;   // Clock reductions
+    uint32_t stepsUp;     // Faster clock tried again
+
+    uint32_t errors() const { return nacks + timeouts + dropouts; }
+};
+
+class I2cBus {
+public:
+    /**
+     * @brief Recovers and starts the bus. Call once in setup(), before the
+     * sensor is probed.
+     * @param startHz Fastest clock (top of the ladder, at most 400 kHz).
+     * @param sampleHz Sensor output rate: sets the slowest usable clock.
+     * @param adaptive false: fixed clock (recovery still runs).
+     * @param settle Boot without a fast-boot budget: waits for the slave
+     *        instead of only clocking it free.
+     */
+    void begin(TwoWire &wire, int sdaPin, int sclPin, uint32_t startHz, uint32_t sampleHz,
+               bool adaptive, bool settle);
+
+    /**
+     * @brief Records the result of one transfer (I2C_STATUS_*).
+     * Sensor task only, like every bus access.
+     */
+    void noteTransfer(uint8_t status);
+
+    /**
+     * @brief Records frames whose magnitude fell below the dropout threshold.
+     */
+    void noteDropouts(uint32_t frames);
+
+    /**
+     * @brief Closes the one-second window once it has elapsed and applies the
+     * recovery / clock policy. Call from the sensor task after every read.
+     * @return true if the driver was restarted (the caller's transfer state,
+     *         e.g. a half-read FIFO, may be stale).
+     */
+    bool service();
+
+    /**
+     * @brief Runs the recovery sequence and restarts the driver at the
+     * current clock.
+     */
+    void recover();
+
+    uint32_t clockHz() const { return rungs[rung]; }
+
+    /** Counters of the last complete second. */
+    BusCounters lastSecond() const;
+
+    /** Counters since boot. */
+    BusCounters totals() const;
+
+    /**
+     * @brief Prints the clock, the last second, the worst second since the
+     * previous report and the totals.
+     */
+    void report();
+
+private:
+    void restart(bool settle);
+    void changeRung(uint8_t next);
+
+    TwoWire *bus = NULL;
+    int sda = -1;
+    int scl = -1;
+    bool adaptiveClock = true;
+
+    uint32_t rungs[I2C_MAX_RUNGS];
+    uint8_t rungCount = 0;
+    uint8_t rung = 0;               // Index into rungs, 0 = fastest
+
+    unsigned long windowStartMs = 0;
+    uint32_t badSeconds = 0;        // Consecutive seconds over the error budget
+    uint32_t cleanSeconds = 0;      // Consecutive seconds under it
+    uint32_t stepUpHold = I2C_STEP_UP_S;
+    bool tryingFaster = false;      // Last change was a step up that has not held yet
+
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED; // Sensor task vs. report()
+    BusCounters window = {};
+    BusCounters previous = {};
+    BusCounters worst = {};         // Highest-error second since the last report
+    BusCounters total = {};
+};
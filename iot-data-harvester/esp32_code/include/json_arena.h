@@ -0,0 +1,97 @@
+/**
+ * Module: Static JSON Arena
+ *
+ * Description:
+ * ArduinoJson 7 allocator backed by a fixed buffer, so JsonDocument trees
+ * are built without touching the heap. Memory is handed out bump-style and
+ * reclaimed all at once with reset() before the next document is built.
+ *
+ * Usage:
+ *   alignas(8) static uint8_t storage[1024];
+ *   static JsonArena arena(storage, sizeof(storage));
+ *   arena.reset();
+ *   JsonDocument doc(&arena);
+ */
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include <string.h>
+
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    JsonArena(uint8_t *buffer, size_t size) : base(buffer), capacity(size) {}
+
+    /** Releases every block; all documents using the arena must be gone. */
+    void reset() { used = 0; }
+
+    /** Highest number of bytes ever in use (sizing aid). */
+    size_t peak() const { return peakUsed; }
+
+    /** Requests that did not fit (the document reports overflowed()). */
+    uint32_t failures() const { return failed; }
+
+    void *allocate(size_t size) override {
+        size_t total = align(sizeof(Header) + size);
+        if (used + total > capacity) {
+            failed++;
+            return NULL;
+        }
+        Header *h = (Header *)(base + used);
+        h->size = size;
+        used += total;
+        if (used > peakUsed) peakUsed = used;
+        return h + 1;
+    }
+
+    void deallocate(void *ptr) override {
+        // Reclaim only the most recent block; everything else waits for reset()
+        if (ptr != NULL && isLast(ptr)) {
+            used = (uint8_t *)header(ptr) - base;
+        }
+    }
+
+    void *reallocate(void *ptr, size_t new_size) override {
+        if (ptr == NULL) return allocate(new_size);
+
+        Header *h = header(ptr);
+        if (isLast(ptr)) {
+            // Grow or shrink in place at the top of the arena
+            size_t start = (uint8_t *)h - base;
+            size_t total = align(sizeof(Header) + new_size);
+            if (start + total > capacity) {
+                failed++;
+                return NULL;
+            }
+            h->size = new_size;
+            used = start + total;
+            if (used > peakUsed) peakUsed = used;
+            return ptr;
+        }
+
+        void *fresh = allocate(new_size);
+        if (fresh != NULL) {
+            memcpy(fresh, ptr, h->size < new_size ? h->size : new_size);
+        }
+        return fresh;
+    }
+
+private:
+    struct alignas(8) Header {
+        size_t size;
+    };
+
+    static size_t align(size_t n) { return (n + 7) & ~(size_t)7; }
+    static Header *header(void *ptr) { return (Header *)ptr - 1; }
+
+    bool isLast(void *ptr) const {
+        Header *h = header(ptr);
+        return (uint8_t *)h + align(sizeof(Header) + h->size) == base + used;
+    }
+
+    uint8_t *base;
+    size_t capacity;
+    size_t used = 0;
+    size_t peakUsed = 0;
+    uint32_t failed = 0;
+};
@@ -0,0 +1,100 @@
+/**
+ * Module: Performance Counters
+ * Target Hardware: ESP32-C3 SuperMini (any ESP32 variant)
+ *
+ * Description:
+ * Counters of how the firmware behaves in the field, cheap enough to stay on
+ * in production. Every plain counter has exactly one writer task (noted per
+ * method), so it is a single 32-bit store: aligned 32-bit loads and stores
+ * are atomic on the ESP32 cores and readers (the heartbeat) see a consistent
+ * value without a lock. The ESP32-C3 has no atomic instructions, so
+ * std::atomic would fall back to a critical section on every increment.
+ * Only the sign counters (latency histogram, failures) have two writers
+ * (network and upload task) and take a portMUX.
+ *
+ * Counters run from boot and never reset: the backend derives rates from
+ * two heartbeats, as with Prometheus counters, and a lost heartbeat loses
+ * nothing. The network task sends a signed snapshot every HEARTBEAT_MS
+ * (see "Heartbeat" in the README for the message format).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define METRICS_SIGN_BUCKETS 6 // Upper bounds in ms: 2, 8, 32, 128, 512, above
+
+/**
+ * @brief Point-in-time copy of every counter plus the heap gauges.
+ */
+struct MetricsSnapshot {
+    uint32_t uptimeS;
+    uint32_t samples;            // Sensor samples processed
+    uint32_t dropouts;           // Frames below the dropout threshold
+    uint32_t triggers;           // Detector triggers
+    uint32_t suppressed;         // Triggers classified impulsive and not sent (FEATURE_SUPPRESS)
+    uint32_t queueDrops;         // Triggers lost because eventQueue was full
+    uint32_t sendOk;             // Requests answered with 2xx
+    uint32_t sendFailures;       // Requests without a 2xx answer (each attempt)
+    uint32_t signCount[METRICS_SIGN_BUCKETS];
+    uint32_t signMaxUs;
+    uint32_t signFailures;       // Signatures mbedtls could not produce (item kept for retry)
+    uint32_t tcpConnects;
+    uint32_t tcpConnectLastMs;
+    uint32_t tcpConnectMaxMs;
+    uint32_t wifiDisconnects;
+    uint32_t wifiReconnectMaxMs;
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;        // Lowest free heap since boot
+};
+
+class Metrics {
+public:
+    // --- Sensor task ---
+    void noteSamples(uint32_t n, uint32_t dropoutFrames) {
+        samples += n;
+        dropouts += dropoutFrames;
+    }
+    void noteTrigger() { triggers++; }
+    void noteSuppressed() { suppressed++; }
+    void noteQueueDrop() { queueDrops++; }
+
+    // --- Network task ---
+    void noteSend(bool ok) {
+        if (ok) sendOk++;
+        else sendFailures++;
+    }
+    void noteSendFailures(uint32_t n) { sendFailures += n; }
+
+    // --- Any task ---
+    /**
+     * @brief Records the duration of one ECDSA signature.
+     */
+    void noteSignUs(uint32_t us);
+    void noteSignFailure();
+
+    uint32_t queueDropCount() const { return queueDrops; }
+
+    /**
+     * @brief Copies the counters and samples the heap. Link figures
+     * (tcp*, wifi*) are filled in by the caller, which owns the link objects.
+     */
+    void snapshot(MetricsSnapshot &out) const;
+
+    /** Upper bound (ms) of sign latency bucket i; 0 for the open last bucket. */
+    static uint32_t signBucketMs(size_t i);
+
+private:
+    volatile uint32_t samples = 0;
+    volatile uint32_t dropouts = 0;
+    volatile uint32_t triggers = 0;
+    volatile uint32_t suppressed = 0;
+    volatile uint32_t queueDrops = 0;
+    volatile uint32_t sendOk = 0;
+    volatile uint32_t sendFailures = 0;
+
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED; // Sign counters: network vs. upload task
+    uint32_t signCount[METRICS_SIGN_BUCKETS] = {};
+    uint32_t signMaxUs = 0;
+    uint32_t signFailures = 0;
+};
@@ -0,0 +1,110 @@
+/**
+ * Module: Power Manager
+ * Target Hardware: ESP32-C3 SuperMini + ADXL345
+ *
+ * Description:
+ * Battery / UPS operation (LOW_POWER=1). Power cuts are exactly when the
+ * node has to keep detecting, so idle time is spent asleep instead of
+ * spinning the CPU and the radio at full power:
+ * - Automatic light sleep + frequency scaling (esp_pm): the C3 sleeps
+ *   whenever every task is blocked. The ADXL345 INT1 line is a GPIO wakeup
+ *   source (Adxl345Fifo::enableWakeup()), so each FIFO watermark wakes the
+ *   chip and the sensor task drains the burst.
+ * - Race to idle: the sensor task holds a CPU_FREQ_MAX lock between wake
+ *   and block (sensorWake() / sensorSleep()), so frequency scaling never
+ *   slows down the detector.
+ * - Radio: Wi-Fi stays associated in WIFI_PS_MAX_MODEM (one beacon every
+ *   listen interval) and is switched to WIFI_PS_NONE only while an event or a
+ *   waveform is being sent (radioAcquire() / radioRelease()).
+ *
+ * Automatic light sleep requires CONFIG_PM_ENABLE and
+ * CONFIG_FREERTOS_USE_TICKLESS_IDLE in the SDK configuration. Without them the
+ * manager falls back to what the SDK offers (frequency scaling, or modem
+ * sleep only) and reports the mode it ended up in.
+ *
+ * Every mode counts wakeups per source and the sensor task's awake time, and
+ * report() prints them with an average current estimated from datasheet
+ * figures (see the README for the model and how to measure it).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+enum PowerMode {
+    POWER_MODE_ACTIVE,      // LOW_POWER=0: CPU idles at full clock, radio in default modem sleep
+    POWER_MODE_MODEM,       // Radio power save only (SDK without power management)
+    POWER_MODE_DFS,         // + CPU clock scaled down while idle
+    POWER_MODE_LIGHT_SLEEP  // + automatic light sleep between wakeups
+};
+
+enum PowerWakeSource {
+    POWER_WAKE_SENSOR,   // FIFO watermark (or its timeout) in the sensor task
+    POWER_WAKE_NETWORK,  // Network task loop
+    POWER_WAKE_UPLOAD,   // Waveform upload poll
+    POWER_WAKE_SOURCES
+};
+
+class PowerManager {
+public:
+    /**
+     * @brief Applies the power configuration. Call once in setup().
+     * @param lowPower false keeps the default (always-on) behaviour and only
+     *                 collects statistics.
+     * @return Mode actually in effect.
+     */
+    PowerMode begin(bool lowPower);
+
+    PowerMode mode() const { return currentMode; }
+    const char *modeName() const;
+
+    /** true if the GPIO wakeup should be armed (automatic light sleep active). */
+    bool lightSleep() const { return currentMode == POWER_MODE_LIGHT_SLEEP; }
+
+    /**
+     * @brief Sensor task woke up: takes the CPU frequency lock and starts the
+     * awake-time measurement.
+     */
+    void sensorWake();
+
+    /**
+     * @brief Sensor task is about to block: releases the lock.
+     */
+    void sensorSleep();
+
+    /** Counts a wakeup of a task without a frequency lock. */
+    void noteWakeup(PowerWakeSource source) { wakeups[source]++; }
+
+    /**
+     * @brief Applies the idle radio power save once Wi-Fi is associated.
+     */
+    void radioReady();
+
+    /**
+     * @brief Keeps the radio fully awake until the matching radioRelease().
+     * Reference counted: the network and upload tasks may overlap.
+     */
+    void radioAcquire();
+    void radioRelease();
+
+    /**
+     * @brief Prints wakeups/s, awake duty and the estimated current for the
+     * window since the previous report, then starts a new window.
+     */
+    void report();
+
+private:
+    float estimateCurrentMa(float sensorDuty, float radioOnDuty) const;
+
+    PowerMode currentMode = POWER_MODE_ACTIVE;
+    void *cpuLock = NULL;           // esp_pm_lock_handle_t
+    SemaphoreHandle_t radioMutex = NULL;
+    uint32_t radioUsers = 0;
+
+    volatile uint32_t wakeups[POWER_WAKE_SOURCES] = {0, 0, 0};
+    int64_t sensorWakeUs = 0;
+    volatile int64_t sensorAwakeUs = 0;   // Awake time of the sensor task in the window
+    int64_t radioOnSinceUs = 0;
+    int64_t radioOnUs = 0;                // Time spent in WIFI_PS_NONE in the window
+    int64_t windowStartUs = 0;
+};
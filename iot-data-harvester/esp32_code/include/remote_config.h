@@ -0,0 +1,63 @@
+/**
+ * Module: Signed Remote Configuration
+ * Target Hardware: ESP32-C3 SuperMini (any ESP32 variant)
+ *
+ * Description:
+ * Verifies and persists the detector configuration blobs the backend pushes
+ * (format in lib/QuakeCore/src/detector_config.h). Each blob is signed by
+ * the backend's configuration key: ECDSA P-256 over SHA-256 of the blob
+ * text, sent as a raw r||s hex signature. The public half is compiled in
+ * (REMOTE_CONFIG_PUBKEY, from GET /config/public-key), so a blob from anyone else,
+ * for another sensor, or older than the one in use is rejected.
+ *
+ * An accepted blob is stored with its signature in NVS (namespace
+ * "quake-config") and verified again at every boot, so a corrupted entry
+ * falls back to the compile-time profile instead of loading garbage.
+ *
+ * Network task only: the verify context is not shared.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "mbedtls/ecp.h"
+#include "detector_config.h"
+
+class RemoteConfig {
+public:
+    /**
+     * @brief Loads the backend's public key.
+     * @param pubKeyHex Uncompressed SECP256R1 point, 04 || X || Y (130 hex chars).
+     * @return false if the key does not parse or is not on the curve.
+     */
+    bool begin(const char *pubKeyHex, int sensorId, uint32_t odrHz);
+
+    /**
+     * @brief Reads the stored blob, verifies and checks it again.
+     * @return true if out holds a usable configuration.
+     */
+    bool load(DetectorConfig &out);
+
+    /**
+     * @brief Verifies a blob received from the backend, checks it and
+     * stores it.
+     * @param why Reason on rejection.
+     * @return true if out holds the new configuration.
+     */
+    bool accept(const char *blob, const char *sigHex, DetectorConfig &out, const char **why);
+
+    /** Version in use (0: compile-time profile). */
+    uint32_t version() const { return current; }
+
+private:
+    bool verify(const char *blob, const char *sigHex);
+    const char *validate(const char *blob, const char *sigHex, DetectorConfig &out);
+
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point serverKey;
+    bool ready = false;
+    int id = 0;
+    uint32_t odr = 100;
+    uint32_t current = 0;
+};
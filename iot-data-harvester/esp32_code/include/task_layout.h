@@ -0,0 +1,78 @@
+/**
+ * Module: Task Layout
+ * Target Hardware: ESP32-C3 SuperMini (single core); pinning applies to
+ * dual-core ESP32 / ESP32-S3 builds.
+ *
+ * Description:
+ * Stack size, priority and core of every firmware task in one place. Each
+ * value can be overridden from esp32_config.env. Check the [TASKS] report
+ * (task_monitor.h) after a change: keep at least MONITOR_STACK_WARN bytes of
+ * headroom at the high-water mark, measured with the largest batch, an
+ * upload and a reconnect behind it.
+ *
+ * Priorities, highest first:
+ *   SensorTask  5  Acquisition and detection: must drain the FIFO in time
+ *   CryptoTask  3  Fast boot only: key loading, deletes itself
+ *   NetworkTask 2  Event path: batch, sign, send
+ *   UploadTask  1  Waveform chunks (WAVEFORM_CAPTURE)
+ *   JournalTask 1  Flash writes (EVENT_JOURNAL)
+ *   SignTask    0  Pre-signature pool (FAST_SIGN), only when the CPU is idle
+ *
+ * On dual-core chips the radio stack (Wi-Fi, lwIP) runs on core 0, so the
+ * network-facing tasks stay there. Acquisition and signing get core 1. The
+ * sensor task then never waits behind a Wi-Fi burst, and the pre-signature
+ * pool refills on the otherwise idle core. SignTask stays at idle priority:
+ * a refill runs for seconds, and starving that core's idle task would
+ * trip the task watchdog.
+ */
+
+#pragma once
+
+#include "task_monitor.h"
+
+#ifndef SENSOR_TASK_STACK
+  #define SENSOR_TASK_STACK   4096
+#endif
+#ifndef SENSOR_TASK_PRIO
+  #define SENSOR_TASK_PRIO    5
+#endif
+#ifndef SENSOR_TASK_CORE
+  #define SENSOR_TASK_CORE    1
+#endif
+
+#ifndef NETWORK_TASK_STACK
+  #define NETWORK_TASK_STACK  8192 // TLS-free HTTP, but JSON + mbedTLS signing run here
+#endif
+#ifndef NETWORK_TASK_PRIO
+  #define NETWORK_TASK_PRIO   2
+#endif
+#ifndef NETWORK_TASK_CORE
+  #define NETWORK_TASK_CORE   0
+#endif
+
+#ifndef SIGN_TASK_STACK
+  #define SIGN_TASK_STACK     6144 // mbedTLS point multiplication
+#endif
+#ifndef SIGN_TASK_PRIO
+  #define SIGN_TASK_PRIO      tskIDLE_PRIORITY
+#endif
+#ifndef SIGN_TASK_CORE
+  #define SIGN_TASK_CORE      1
+#endif
+
+#ifndef CRYPTO_TASK_STACK
+  #define CRYPTO_TASK_STACK   6144
+#endif
+#ifndef UPLOAD_TASK_STACK
+  #define UPLOAD_TASK_STACK   6144
+#endif
+#ifndef JOURNAL_TASK_STACK
+  #define JOURNAL_TASK_STACK  3072
+#endif
+
+const TaskSpec SENSOR_TASK_SPEC  = { "SensorTask",  SENSOR_TASK_STACK,  SENSOR_TASK_PRIO,  SENSOR_TASK_CORE };
+const TaskSpec NETWORK_TASK_SPEC = { "NetworkTask", NETWORK_TASK_STACK, NETWORK_TASK_PRIO, NETWORK_TASK_CORE };
+const TaskSpec SIGN_TASK_SPEC    = { "SignTask",    SIGN_TASK_STACK,    SIGN_TASK_PRIO,    SIGN_TASK_CORE };
+const TaskSpec CRYPTO_TASK_SPEC  = { "CryptoTask",  CRYPTO_TASK_STACK,  3,                 SENSOR_TASK_CORE };
+const TaskSpec UPLOAD_TASK_SPEC  = { "UploadTask",  UPLOAD_TASK_STACK,  1,                 NETWORK_TASK_CORE };
+const TaskSpec JOURNAL_TASK_SPEC = { "JournalTask", JOURNAL_TASK_STACK, 1,                 NETWORK_TASK_CORE };
@@ -0,0 +1,105 @@
+/**
+ * Module: Task Monitor
+ * Target Hardware: ESP32-C3 SuperMini (any ESP32 variant)
+ *
+ * Description:
+ * Creates the firmware tasks from a TaskSpec (task_layout.h) and reports how
+ * they behave at run time, so stack sizes and priorities can be set from
+ * measurements instead of guesses:
+ * - Stack: free bytes at the high-water mark (uxTaskGetStackHighWaterMark)
+ *   against the configured size. Tasks below MONITOR_STACK_WARN are flagged.
+ * - CPU: share of run time per task since the previous report (FreeRTOS
+ *   run-time stats, needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS). With
+ *   CONFIG_FREERTOS_USE_TRACE_FACILITY the report lists every task, including
+ *   the Wi-Fi, lwIP and timer tasks; without it, only the tasks created here.
+ * - Queues: current and peak depth of the watched queues.
+ * - Wake latency: watermark ISR to sensor task running, in µs.
+ *
+ * On dual-core chips spawn() pins each task to its TaskSpec core with
+ * xTaskCreatePinnedToCore(); single-core chips (ESP32-C3) ignore the core.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define MONITOR_MAX_TASKS   24   // Registered tasks / tasks listed per report
+#define MONITOR_MAX_QUEUES  4
+#define MONITOR_STACK_WARN  512  // Bytes of headroom below which a task is flagged
+#define TASK_CORE_ANY       -1
+
+/**
+ * @brief Static description of one task (see task_layout.h).
+ */
+struct TaskSpec {
+    const char *name;
+    uint32_t stackBytes;  // ESP-IDF stack depth is in bytes
+    UBaseType_t priority;
+    int core;             // Core id, or TASK_CORE_ANY (ignored on single-core chips)
+};
+
+class TaskMonitor {
+public:
+    /**
+     * @brief Creates a task as described by spec and registers it.
+     * @param monitored false for tasks that delete themselves (their handle
+     *        must not be queried afterwards).
+     * @return Task handle, NULL if the task could not be created.
+     */
+    TaskHandle_t spawn(const TaskSpec &spec, TaskFunction_t fn, void *arg, bool monitored = true);
+
+    /**
+     * @brief Adds a queue to the depth report.
+     */
+    void watchQueue(QueueHandle_t queue, const char *name);
+
+    /**
+     * @brief Samples the depth of every watched queue (peak tracking).
+     * Cheap: call from a task that wakes regularly.
+     */
+    void sampleQueues();
+
+    /**
+     * @brief Records one interrupt-to-task latency (µs).
+     */
+    void noteWakeLatency(uint32_t us);
+
+    /**
+     * @brief Prints one line per task, the queue depths and the wake latency,
+     * then starts a new measurement window.
+     */
+    void report();
+
+private:
+    struct Registered {
+        TaskHandle_t handle;
+        const TaskSpec *spec;
+    };
+    struct WatchedQueue {
+        QueueHandle_t queue;
+        const char *name;
+        UBaseType_t length;
+        UBaseType_t peak;
+    };
+    struct RunTime {
+        TaskHandle_t handle;
+        uint32_t counter;
+    };
+
+    const Registered *find(TaskHandle_t handle) const;
+    uint32_t previousRunTime(TaskHandle_t handle) const;
+
+    Registered tasks[MONITOR_MAX_TASKS];
+    size_t taskCount = 0;
+    WatchedQueue queues[MONITOR_MAX_QUEUES];
+    size_t queueCount = 0;
+
+    RunTime lastRun[MONITOR_MAX_TASKS];
+    size_t lastRunCount = 0;
+    uint32_t lastTotalRunTime = 0;
+
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED; // Latency: sensor task vs. report()
+    uint32_t wakeCount = 0;
+    uint32_t wakeSumUs = 0;
+    uint32_t wakeMaxUs = 0;
+};
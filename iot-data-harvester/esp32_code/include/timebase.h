@@ -0,0 +1,66 @@
+/**
+ * Module: Disciplined Timebase
+ * Target Hardware: ESP32-C3 SuperMini
+ *
+ * Description:
+ * Maps the monotonic esp_timer clock (µs since boot) to Unix time in µs.
+ * Triggers are stamped with esp_timer_get_time() on the sensor path and only
+ * converted when they are sent, so a trigger never depends on the wall clock
+ * being set yet, and the conversion always uses the newest sync.
+ *
+ * Every SNTP sync (onSync(), from the Connectivity callback) re-anchors the
+ * mapping: unix = anchorUnix + (mono - anchorMono) * (1 + drift). The
+ * difference between the time SNTP delivers and the time the previous anchor
+ * predicted is the sync error; it also updates the drift estimate (ppm of the
+ * esp_timer crystal against NTP), which corrects the time between syncs.
+ *
+ * Before the first sync, a clock that survived a software reset is used as
+ * is (gettimeofday() at conversion time, no drift correction).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <sys/time.h>
+
+class Timebase {
+public:
+    /**
+     * @brief SNTP sync callback context: re-anchors the mapping.
+     * @param tv Time just set by SNTP.
+     */
+    void onSync(const struct timeval *tv);
+
+    /** Unix time is known: synced, or the clock survived a software reset. */
+    bool valid() const;
+
+    /** true once at least one SNTP sync was received this boot. */
+    bool disciplined() const { return syncCount > 0; }
+
+    /**
+     * @brief Converts an esp_timer_get_time() stamp of this boot to Unix µs.
+     * @return 0 if the wall clock is not known yet.
+     */
+    int64_t toUnixUs(int64_t monoUs) const;
+
+    uint32_t syncs() const { return syncCount; }
+    int32_t lastErrorUs() const { return lastError; }
+    float driftPpm() const { return drift; }
+
+    /**
+     * @brief Prints sync count, sync error and drift.
+     */
+    void report() const;
+
+private:
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED; // SNTP task vs. readers
+
+    int64_t anchorMonoUs = 0;
+    int64_t anchorUnixUs = 0;
+    float drift = 0.0f;              // ppm, positive = esp_timer runs slow
+    uint32_t syncCount = 0;
+    uint32_t driftSamples = 0;
+    int32_t lastError = 0;           // µs, NTP minus prediction at the last sync
+    int32_t maxError = 0;            // µs, largest |lastError| (steps excluded)
+    uint32_t steps = 0;              // Syncs too far off to be drift (clock was set)
+};
@@ -0,0 +1,165 @@
+/**
+ * Module: Multi-Band Detector Bank
+ * See detector_bank.h for the channel chain, voting rule and layout.
+ */
+
+#include "detector_bank.h"
+#include "dsp_block.h"
+
+#include <math.h>
+#include <string.h>
+
+static const uint32_t AGE_IDLE = 0x7FFFFFFFUL; // "Never on": outside every vote window
+
+BankConfig bankDefaultConfig() {
+    BankConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.channels = 4;
+    //          f_low  f_high  sta_s  lta_s  ratio  floor  weight
+    cfg.ch[0] = {0.3f,  1.5f,  3.0f,  60.0f, 2.5f,  0.02f, 2}; // Long-period: may trigger alone
+    cfg.ch[1] = {1.0f,  5.0f,  1.0f,  30.0f, 2.5f,  0.03f, 1};
+    cfg.ch[2] = {3.0f,  10.0f, 0.5f,  20.0f, 2.5f,  0.03f, 1};
+    cfg.ch[3] = {8.0f,  20.0f, 0.2f,  10.0f, 3.0f,  0.04f, 1}; // Doors / appliances live here
+    cfg.vote_threshold = 2;
+    cfg.min_on_s = 0.5f;
+    cfg.vote_window_s = 2.0f;
+    cfg.cooldown_s = 5.0f;
+    cfg.dropout_ms2 = 2.0f;
+    cfg.lta_floor = 0.05f;
+    return cfg;
+}
+
+// Per-sample EMA factor for a time constant tau: 1 - e^(-1 / (tau * fs))
+static float emaAlpha(float tau_s, float fs) {
+    return 1.0f - expf(-1.0f / (tau_s * fs));
+}
+
+bool bankInit(DetectorBank &b, const BankConfig &cfg, uint32_t odr_hz, float seed_mag) {
+    memset(&b, 0, sizeof(b));
+    if (cfg.channels == 0 || cfg.channels > BANK_MAX_CHANNELS || odr_hz == 0) return false;
+
+    const float fs = (float)odr_hz;
+    for (size_t c = 0; c < BANK_MAX_CHANNELS; c++) {
+        b.age[c] = AGE_IDLE;
+        b.ratio[c] = 1.0e30f; // Unused lanes never turn on
+        b.lta[c] = cfg.lta_floor;
+        if (c >= cfg.channels) continue;
+
+        const BankChannelConfig &ch = cfg.ch[c];
+        if (ch.f_low_hz <= 0.0f || ch.f_high_hz <= ch.f_low_hz || ch.f_high_hz >= fs / 2.0f) return false;
+
+        // RBJ band-pass (0 dB peak) centred on the geometric mean of the edges
+        float f0 = sqrtf(ch.f_low_hz * ch.f_high_hz);
+        float q = f0 / (ch.f_high_hz - ch.f_low_hz);
+        float w0 = 2.0f * (float)M_PI * f0 / fs;
+        float alpha = sinf(w0) / (2.0f * q);
+        float a0 = 1.0f + alpha;
+        b.b0[c] = alpha / a0;
+        b.a1[c] = -2.0f * cosf(w0) / a0;
+        b.a2[c] = (1.0f - alpha) / a0;
+
+        // DC steady state for the resting magnitude: y = 0, z1 = z2 = -b0 * x
+        b.z1[c] = -b.b0[c] * seed_mag;
+        b.z2[c] = b.z1[c];
+
+        b.alpha_sta[c] = emaAlpha(ch.sta_s, fs);
+        b.alpha_lta[c] = emaAlpha(ch.lta_s, fs);
+        b.ratio[c] = ch.trigger_ratio;
+        b.floor[c] = ch.noise_floor;
+        b.weight[c] = ch.weight;
+    }
+
+    b.vote_threshold = cfg.vote_threshold;
+    b.min_on = (uint32_t)(cfg.min_on_s * fs);
+    if (b.min_on == 0) b.min_on = 1;
+    b.vote_window = (uint32_t)(cfg.vote_window_s * fs);
+    b.cooldown_samples = (uint32_t)(cfg.cooldown_s * fs);
+    b.dropout_ms2 = cfg.dropout_ms2;
+    b.lta_floor = cfg.lta_floor;
+    return b.vote_threshold > 0;
+}
+
+size_t bankProcessMagnitudes(DetectorBank &b, const float *mag, size_t n,
+                             BankTrigger *trigs, size_t maxTrigs) {
+    size_t found = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (b.inAlarm && ++b.alarmSamples > b.cooldown_samples) {
+            b.inAlarm = false;
+        }
+        for (size_t c = 0; c < BANK_MAX_CHANNELS; c++) {
+            if (b.age[c] < AGE_IDLE) b.age[c]++;
+        }
+
+        // Signal Dropout Protection: hold every filter on a dropped frame
+        const float x = mag[i];
+        if (x < b.dropout_ms2) continue;
+
+        // Channel lanes: fixed trip count over contiguous rows
+        for (size_t c = 0; c < BANK_MAX_CHANNELS; c++) {
+            float y = b.b0[c] * x + b.z1[c];
+            b.z1[c] = b.z2[c] - b.a1[c] * y;
+            b.z2[c] = -b.b0[c] * x - b.a2[c] * y;
+
+            float a = fabsf(y);
+            a = a < b.floor[c] ? 0.0f : a;
+            b.sta[c] += b.alpha_sta[c] * (a - b.sta[c]);
+            b.lta[c] += b.alpha_lta[c] * (a - b.lta[c]);
+            b.lta[c] = b.lta[c] < b.lta_floor ? b.lta_floor : b.lta[c];
+
+            // sta / lta >= ratio, evaluated without a division
+            bool on = b.sta[c] >= b.ratio[c] * b.lta[c] && b.sta[c] > b.floor[c];
+            b.run[c] = on ? (b.run[c] < b.min_on ? b.run[c] + 1 : b.run[c]) : 0;
+            b.age[c] = b.run[c] >= b.min_on ? 0 : b.age[c];
+        }
+
+        // Voting
+        int32_t votes = 0;
+        uint8_t mask = 0;
+        for (size_t c = 0; c < BANK_MAX_CHANNELS; c++) {
+            if (b.weight[c] == 0 || b.age[c] > b.vote_window) continue;
+            votes += b.weight[c];
+            if (b.weight[c] > 0) mask |= (uint8_t)(1u << c);
+        }
+        if (b.inAlarm || votes < b.vote_threshold) continue;
+
+        b.inAlarm = true;
+        b.alarmSamples = 0;
+        if (found < maxTrigs) {
+            BankTrigger &t = trigs[found];
+            t.index = i;
+            t.mask = mask;
+            t.ratio = 0.0f;
+            t.sta = 0.0f;
+            for (size_t c = 0; c < BANK_MAX_CHANNELS; c++) {
+                if (!(mask & (1u << c))) continue;
+                float r = b.sta[c] / b.lta[c];
+                if (r > t.ratio) {
+                    t.ratio = r;
+                    t.sta = b.sta[c];
+                }
+            }
+        }
+        found++;
+    }
+    return found;
+}
+
+size_t bankProcessBlock(DetectorBank &b, const RawSample *in, size_t n,
+                        BankTrigger *trigs, size_t maxTrigs) {
+    float mag[DSP_BLOCK_CHUNK];
+    size_t found = 0;
+
+    for (size_t off = 0; off < n; off += DSP_BLOCK_CHUNK) {
+        size_t len = n - off < DSP_BLOCK_CHUNK ? n - off : DSP_BLOCK_CHUNK;
+        blockMagnitude(in + off, mag, len);
+
+        size_t stored = found < maxTrigs ? found : maxTrigs;
+        size_t got = bankProcessMagnitudes(b, mag, len, trigs + stored, maxTrigs - stored);
+        for (size_t t = stored; t < found + got && t < maxTrigs; t++) {
+            trigs[t].index += off;
+        }
+        found += got;
+    }
+    return found;
+}
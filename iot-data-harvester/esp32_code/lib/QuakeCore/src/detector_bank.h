@@ -0,0 +1,134 @@
+/**
+ * Module: Multi-Band Detector Bank
+ *
+ * Description:
+ * Runs up to BANK_MAX_CHANNELS band-pass + STA/LTA detectors on the same
+ * magnitude stream and only reports an event when enough of them agree.
+ * Single-band STA/LTA (sta_lta.h) confuses narrow-band domestic sources
+ * (washing machines, doors) with earthquakes and reacts poorly to
+ * long-period motion; splitting the signal into bands lets the voting rule
+ * reject energy that shows up in one band only.
+ *
+ * Per channel:
+ *   band-pass biquad -> |y| -> Noise Gate -> STA/LTA -> "on" flag
+ * Voting:
+ *   A channel votes once it has been "on" for min_on consecutive samples;
+ *   impulses (doors, knocks) ring the bands for well under 0.5 s while
+ *   earthquake shaking keeps them on for seconds. It then keeps voting for
+ *   vote_window samples after its last qualifying sample. An event is declared when the summed weight of the voting
+ *   channels reaches vote_threshold, followed by the bank cooldown.
+ *   A channel with weight >= vote_threshold can trigger alone (e.g. the
+ *   long-period band); a negative weight turns a channel into a veto
+ *   (the high band, where impulses and appliances put most of their energy).
+ *
+ * Layout:
+ * Channel state is struct-of-arrays: every field is a float[BANK_MAX_CHANNELS]
+ * row, and the per-sample loop always walks all BANK_MAX_CHANNELS lanes
+ * (unused lanes have zero coefficients and weight 0). The inner loop has a
+ * fixed trip count over contiguous rows, so host compilers map it onto one
+ * 4-wide SIMD register and the MCU walks sequential memory.
+ */
+
+#pragma once
+
+#include "quake_types.h"
+
+#define BANK_MAX_CHANNELS 4
+
+/**
+ * @brief User-facing configuration of one channel.
+ */
+struct BankChannelConfig {
+    float f_low_hz;      // Band-pass lower edge (-3 dB)
+    float f_high_hz;     // Band-pass upper edge (-3 dB)
+    float sta_s;         // STA time constant
+    float lta_s;         // LTA time constant
+    float trigger_ratio; // STA/LTA threshold
+    float noise_floor;   // Gate on the band-passed signal (m/s^2)
+    int8_t weight;       // Vote weight (0 = monitor only, < 0 = veto)
+};
+
+/**
+ * @brief Bank configuration. Time values are in seconds so one profile works
+ * at every ODR; bankInit() converts them to per-sample coefficients.
+ */
+struct BankConfig {
+    size_t channels;
+    BankChannelConfig ch[BANK_MAX_CHANNELS];
+    int8_t vote_threshold;  // Summed weight required for an event (> 0)
+    float min_on_s;         // Time a channel must stay "on" before it votes
+    float vote_window_s;    // Coincidence window between channels
+    float cooldown_s;       // Events ignored after a trigger
+    float dropout_ms2;      // Magnitudes below this are discarded
+    float lta_floor;        // Safety floor for every LTA
+};
+
+/**
+ * @brief Running state, struct-of-arrays (one lane per channel).
+ */
+struct DetectorBank {
+    // Biquad (transposed direct form II, band-pass: b1 = 0, b2 = -b0)
+    float b0[BANK_MAX_CHANNELS];
+    float a1[BANK_MAX_CHANNELS];
+    float a2[BANK_MAX_CHANNELS];
+    float z1[BANK_MAX_CHANNELS];
+    float z2[BANK_MAX_CHANNELS];
+    // STA/LTA
+    float alpha_sta[BANK_MAX_CHANNELS];
+    float alpha_lta[BANK_MAX_CHANNELS];
+    float sta[BANK_MAX_CHANNELS];
+    float lta[BANK_MAX_CHANNELS];
+    float ratio[BANK_MAX_CHANNELS];
+    float floor[BANK_MAX_CHANNELS];
+    // Voting
+    uint32_t run[BANK_MAX_CHANNELS]; // Consecutive "on" samples
+    uint32_t age[BANK_MAX_CHANNELS]; // Samples since the channel last qualified
+    int8_t weight[BANK_MAX_CHANNELS];
+
+    int8_t vote_threshold;
+    uint32_t min_on;
+    uint32_t vote_window;
+    uint32_t cooldown_samples;
+    float dropout_ms2;
+    float lta_floor;
+    bool inAlarm;
+    uint32_t alarmSamples;
+};
+
+/**
+ * @brief Event declared by the bank.
+ */
+struct BankTrigger {
+    size_t index;  // Sample index inside the block
+    uint8_t mask;  // Channels with a positive vote (bit c = channel c)
+    float ratio;   // Highest STA/LTA ratio among those channels
+    float sta;     // STA of that channel (m/s^2)
+};
+
+/**
+ * @brief Four-band profile: long-period (0.3-1.5 Hz, may trigger alone)
+ * plus three 1-20 Hz bands of which two must agree.
+ */
+BankConfig bankDefaultConfig();
+
+/**
+ * @brief Computes coefficients for odr_hz and resets the state, seeding the
+ * filters with a resting magnitude (m/s^2).
+ * @return false if a band edge is at or above Nyquist or the config is invalid.
+ */
+bool bankInit(DetectorBank &b, const BankConfig &cfg, uint32_t odr_hz, float seed_mag);
+
+/**
+ * @brief Runs a block of magnitudes (m/s^2) through every channel.
+ * @param trigs Receives the first maxTrigs events of the block, in order.
+ * @return Number of events in the block (may exceed maxTrigs).
+ */
+size_t bankProcessMagnitudes(DetectorBank &b, const float *mag, size_t n,
+                             BankTrigger *trigs, size_t maxTrigs);
+
+/**
+ * @brief Same as bankProcessMagnitudes() for raw samples; the magnitude is
+ * computed with the block kernel (dsp_block.h).
+ */
+size_t bankProcessBlock(DetectorBank &b, const RawSample *in, size_t n,
+                        BankTrigger *trigs, size_t maxTrigs);
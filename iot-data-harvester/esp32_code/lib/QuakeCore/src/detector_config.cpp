@@ -0,0 +1,73 @@
+/**
+ * Module: Remote Detector Configuration
+ * See detector_config.h for the blob format and the hand-over model.
+ */
+
+#include "detector_config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Limits a remote configuration must stay within. Wide enough for any site,
+// tight enough that a typo cannot silence the detector or make it fire on noise.
+static const float    CFG_RATIO_MIN       = 1.2f;
+static const float    CFG_RATIO_MAX       = 10.0f;
+static const float    CFG_NOISE_MIN       = 0.005f;
+static const float    CFG_NOISE_MAX       = 1.0f;
+static const float    CFG_ALPHA_LTA_MIN   = 0.001f;
+static const float    CFG_ALPHA_LTA_MAX   = 0.5f;
+static const float    CFG_ALPHA_STA_MAX   = 1.0f;
+static const uint32_t CFG_COOLDOWN_MIN_MS = 500;
+static const uint32_t CFG_COOLDOWN_MAX_MS = 60000;
+
+bool detectorConfigParse(const char *blob, DetectorConfig &out) {
+    if (blob == NULL || strlen(blob) >= DETECTOR_CONFIG_MAX_LEN) return false;
+
+    long id = 0;
+    unsigned long version = 0, cooldown = 0;
+    int consumed = 0;
+    if (sscanf(blob, "config:%ld:%lu:%f:%f:%f:%f:%lu%n", &id, &version, &out.trigger_ratio,
+               &out.noise_floor, &out.alpha_lta, &out.alpha_sta, &cooldown, &consumed) != 7) {
+        return false;
+    }
+    if (blob[consumed] != '\0') return false;
+    out.misurator_id = (int32_t)id;
+    out.version = (uint32_t)version;
+    out.cooldown_ms = (uint32_t)cooldown;
+    return true;
+}
+
+const char *detectorConfigCheck(const DetectorConfig &c, uint32_t odr_hz) {
+    // Written so that NaN fails every test
+    if (!(c.trigger_ratio >= CFG_RATIO_MIN && c.trigger_ratio <= CFG_RATIO_MAX)) return "trigger ratio out of range";
+    if (!(c.noise_floor >= CFG_NOISE_MIN && c.noise_floor <= CFG_NOISE_MAX)) return "noise floor out of range";
+    if (!(c.alpha_lta >= CFG_ALPHA_LTA_MIN && c.alpha_lta <= CFG_ALPHA_LTA_MAX)) return "LTA alpha out of range";
+    if (!(c.alpha_sta > c.alpha_lta && c.alpha_sta <= CFG_ALPHA_STA_MAX)) return "STA alpha must be above the LTA alpha";
+    if (c.cooldown_ms < CFG_COOLDOWN_MIN_MS || c.cooldown_ms > CFG_COOLDOWN_MAX_MS) return "cooldown out of range";
+
+    // The Q15 path re-derives the alphas for the ODR: they must not round to zero
+    // (only the alphas of q are looked at, the other arguments are placeholders)
+    const FixedParams q = fixedParamsFromFloat(c.alpha_lta, c.alpha_sta, 0.9f, c.trigger_ratio, c.noise_floor,
+                                               0.0f, 0.0f, odr_hz, c.cooldown_ms);
+    if (q.alpha_lta_q15 <= 0 || q.alpha_sta_q15 <= 0) return "alpha underflows Q15 at this ODR";
+    return NULL;
+}
+
+LiveDetectorParams detectorConfigApply(const DetectorConfig &c, const DetectorParams &profile,
+                                       uint32_t odr_hz) {
+    LiveDetectorParams live;
+    live.version = c.version;
+
+    // Float path: per-sample constants as given, like StaticDetectorParams
+    live.f = profile;
+    live.f.alpha_lta = c.alpha_lta;
+    live.f.alpha_sta = c.alpha_sta;
+    live.f.trigger_ratio = c.trigger_ratio;
+    live.f.noise_floor = c.noise_floor;
+    live.f.cooldown_samples = (c.cooldown_ms * odr_hz) / 1000;
+
+    live.q = fixedParamsFromFloat(c.alpha_lta, c.alpha_sta, profile.hpf_coeff, c.trigger_ratio,
+                                  c.noise_floor, profile.dropout_ms2, profile.lta_floor, odr_hz,
+                                  c.cooldown_ms);
+    return live;
+}
@@ -0,0 +1,114 @@
+/**
+ * Module: Remote Detector Configuration
+ *
+ * Description:
+ * Detector tuning pushed by the backend at run time, overriding the
+ * compile-time profile (detector_profile.h) without a reflash. The backend
+ * signs a one-line text blob (the firmware side, include/remote_config.h,
+ * verifies and stores it):
+ *
+ *   config:<misurator_id>:<version>:<trigger_ratio>:<noise_floor>:<alpha_lta>:<alpha_sta>:<cooldown_ms>
+ *
+ * As in the profiles, the alphas are per-sample factors at the 100 Hz
+ * reference rate and the noise floor is in m/s^2. The HPF pole, the dropout
+ * threshold and the LTA floor stay those of the profile. Versions increase
+ * per sensor; a blob never replaces one with the same or a higher version.
+ *
+ * ConfigSwap hands a configuration from the network task to the sensor task
+ * without a lock and without pausing acquisition. It is double-buffered:
+ * the sensor task runs from its own live copy, the writer fills a back
+ * buffer and flags it, and the sensor task copies it over between two
+ * blocks. The writer does not touch the back buffer again until that copy
+ * is done, so a block always runs with one complete parameter set. Only
+ * atomic loads and stores are used (as in spsc_ring.h), which the ESP32-C3
+ * supports without the 'A' extension.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "quake_types.h"
+#include "sta_lta.h"
+#include "dsp_fixed.h"
+
+#define DETECTOR_CONFIG_MAX_LEN 128 // Blob length including the terminator
+
+/**
+ * @brief One parsed configuration blob.
+ */
+struct DetectorConfig {
+    int32_t misurator_id;
+    uint32_t version;
+    float trigger_ratio;
+    float noise_floor;     // m/s^2
+    float alpha_lta;       // At 100 Hz
+    float alpha_sta;       // At 100 Hz
+    uint32_t cooldown_ms;
+};
+
+/**
+ * @brief Both detector parameter forms of one configuration, as the sensor
+ * task consumes them. Derived on the writer side, so the sensor task only
+ * copies.
+ */
+struct LiveDetectorParams {
+    uint32_t version;
+    DetectorParams f;  // sta_lta.h / dsp_block.h path
+    FixedParams q;     // dsp_fixed.h path
+};
+
+/**
+ * @brief Parses a blob (the exact signed text).
+ * @return false if the blob is malformed; ranges are not checked.
+ */
+bool detectorConfigParse(const char *blob, DetectorConfig &out);
+
+/**
+ * @brief Range checks for a parsed configuration at the given ODR.
+ * @return NULL if the configuration is usable, otherwise the reason.
+ */
+const char *detectorConfigCheck(const DetectorConfig &c, uint32_t odr_hz);
+
+/**
+ * @brief Builds both parameter forms from a checked configuration.
+ * @param profile Runtime form of the compile-time profile: supplies the HPF
+ *        pole, dropout threshold and LTA floor.
+ */
+LiveDetectorParams detectorConfigApply(const DetectorConfig &c, const DetectorParams &profile,
+                                       uint32_t odr_hz);
+
+/**
+ * @brief Lock-free double buffer, one writer task and one reader task.
+ */
+template <typename T>
+class ConfigSwap {
+public:
+    ConfigSwap() : staged(0) {}
+
+    /**
+     * @brief Writer: stages a new value.
+     * @return false while the previous value has not been taken yet.
+     */
+    bool publish(const T &value) {
+        if (staged.load(std::memory_order_acquire)) return false;
+        back = value;
+        staged.store(1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Reader: copies a staged value into its live copy.
+     * @return true if live was replaced.
+     */
+    bool take(T &live) {
+        if (!staged.load(std::memory_order_acquire)) return false;
+        live = back;
+        staged.store(0, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T back;
+    std::atomic<uint32_t> staged;
+};
@@ -0,0 +1,207 @@
+/**
+ * Module: Compile-Time Detector Profiles
+ *
+ * Description:
+ * Deployment profiles for the single broadband detector (sta_lta.h,
+ * dsp_block.h, dsp_fixed.h), turned into parameter types whose members are
+ * static constexpr. The detector kernels are templates over the parameter
+ * type, so instantiating them with a profile lets the compiler:
+ * - fold (1 - alpha), the Q15 re-derivation for the ODR and the
+ *   m/s^2 -> counts conversions into immediates,
+ * - turn a power-of-two alpha into an exact shift in the Q15 EMA
+ *   ((v * 2^(15-s)) >> 15 == v >> s),
+ * - drop the parameter loads from the per-sample loop.
+ *
+ * Profiles (selected with DETECTOR_PROFILE in esp32_config.env):
+ * - REFERENCE (0): the original tuning, equivalent to the runtime parameters.
+ * - BUILDING  (1): upper floors / timber frames. Sway and footsteps raise the
+ *                  background: higher ratio (2.0) and noise floor (0.05), a
+ *                  fast STA (1/2) and a slow LTA (1/32).
+ * - BEDROCK   (2): vault or basement on rock. Quiet background: lower ratio
+ *                  (1.6) and noise floor (0.03), a smoother STA (1/4) so
+ *                  small sustained motion is weighed over single spikes,
+ *                  and the same slow LTA (1/32).
+ * The building and bedrock alphas are powers of two.
+ *
+ * A profile is a struct with the constants below at the 100 Hz reference
+ * rate. Values must be set with C++11 constexpr rules in mind (the firmware
+ * toolchain), so the helpers are single-expression recursive functions.
+ *
+ * In the Q15 path a power-of-two alpha is re-derived for the ODR as
+ * alpha / k (k = ODR/100), which keeps it a shift, as long as that is within
+ * 5% of the exact 1 - (1 - alpha)^(1/k); this holds for the small LTA alphas
+ * at every ODR. Larger alphas (the STAs) fall back to the exact value above
+ * 100 Hz, as do the reference alphas everywhere, so the reference profile
+ * reproduces fixedParamsFromFloat() exactly.
+ */
+
+#pragma once
+
+#include "quake_types.h"
+#include "sta_lta.h"
+#include "dsp_fixed.h"
+
+#define DETECTOR_PROFILE_REFERENCE 0
+#define DETECTOR_PROFILE_BUILDING  1
+#define DETECTOR_PROFILE_BEDROCK   2
+
+// --------------------------------------------------------------------------
+// PROFILES (constants at the 100 Hz reference rate)
+// --------------------------------------------------------------------------
+struct ProfileReference {
+    static const char *name() { return "reference"; }
+    static constexpr float ALPHA_LTA     = 0.05f;
+    static constexpr float ALPHA_STA     = 0.40f;
+    static constexpr float TRIGGER_RATIO = 1.8f;
+    static constexpr float NOISE_FLOOR   = 0.04f;
+    static constexpr float HPF_COEFF     = 0.9f;
+    static constexpr float DROPOUT_MS2   = 2.0f;
+    static constexpr float LTA_FLOOR     = 0.05f;
+    static constexpr uint32_t COOLDOWN_MS = 5000;
+};
+
+struct ProfileBuilding {
+    static const char *name() { return "building"; }
+    static constexpr float ALPHA_LTA     = 0.03125f; // 1/32
+    static constexpr float ALPHA_STA     = 0.5f;     // 1/2
+    static constexpr float TRIGGER_RATIO = 2.0f;
+    static constexpr float NOISE_FLOOR   = 0.05f;
+    static constexpr float HPF_COEFF     = 0.9f;
+    static constexpr float DROPOUT_MS2   = 2.0f;
+    static constexpr float LTA_FLOOR     = 0.05f;
+    static constexpr uint32_t COOLDOWN_MS = 5000;
+};
+
+struct ProfileBedrock {
+    static const char *name() { return "bedrock"; }
+    static constexpr float ALPHA_LTA     = 0.03125f; // 1/32
+    static constexpr float ALPHA_STA     = 0.25f;    // 1/4
+    static constexpr float TRIGGER_RATIO = 1.6f;
+    static constexpr float NOISE_FLOOR   = 0.03f;
+    static constexpr float HPF_COEFF     = 0.9f;
+    static constexpr float DROPOUT_MS2   = 2.0f;
+    static constexpr float LTA_FLOOR     = 0.05f;
+    static constexpr uint32_t COOLDOWN_MS = 5000;
+};
+
+// --------------------------------------------------------------------------
+// CONSTEXPR HELPERS
+// --------------------------------------------------------------------------
+// Newton iterations from 1.0 converge to double precision well within 40 steps for (0, 1]
+constexpr double profileSqrtStep(double x, double g, int n) {
+    return n == 0 ? g : profileSqrtStep(x, 0.5 * (g + x / g), n - 1);
+}
+constexpr double profileSqrt(double x) {
+    return x <= 0.0 ? 0.0 : profileSqrtStep(x, x < 1.0 ? 1.0 : x, 40);
+}
+// x^(1/k) for a power-of-two k
+constexpr double profileRoot(double x, uint32_t k) {
+    return k <= 1 ? x : profileRoot(profileSqrt(x), k / 2);
+}
+constexpr uint32_t profileLog2(uint32_t k) {
+    return k <= 1 ? 0 : 1 + profileLog2(k / 2);
+}
+// s if v == 2^-s (s = 1..15), otherwise -1
+constexpr int profileShiftOf(double v, int s) {
+    return s > 15 ? -1 : (v == 1.0 / (double)(1L << s) ? s : profileShiftOf(v, s + 1));
+}
+// Round to nearest, as lrintf() does for the runtime conversion
+constexpr int32_t profileQ(double v, int frac_bits) {
+    return (int32_t)(v * (double)(1L << frac_bits) + (v < 0.0 ? -0.5 : 0.5));
+}
+constexpr int32_t profileCounts(double ms2, int frac_bits) {
+    return profileQ(ms2 / (double)ADXL345_LSB_TO_MS2, frac_bits);
+}
+// Q15 alpha at k times the reference rate: exact re-derivation, as fixedParamsFromFloat()
+constexpr int32_t profileAlphaExactQ15(double alpha, uint32_t k) {
+    return profileQ(1.0 - profileRoot(1.0 - alpha, k), 15);
+}
+// 2^-s at the reference rate -> 2^-(s + log2 k), i.e. alpha / k
+constexpr int32_t profileAlphaShiftQ15(double alpha, uint32_t k) {
+    return (int32_t)(DSP_Q15_ONE >> (profileShiftOf(alpha, 1) + profileLog2(k)));
+}
+// Shift form when alpha is a power of two and alpha / k is within 5% of the exact value
+constexpr int32_t profileAlphaQ15(double alpha, uint32_t k) {
+    return profileShiftOf(alpha, 1) > 0 &&
+           20 * (profileAlphaExactQ15(alpha, k) - profileAlphaShiftQ15(alpha, k)) <= profileAlphaExactQ15(alpha, k)
+        ? profileAlphaShiftQ15(alpha, k)
+        : profileAlphaExactQ15(alpha, k);
+}
+
+// --------------------------------------------------------------------------
+// SPECIALIZED PARAMETER TYPES
+// --------------------------------------------------------------------------
+/**
+ * @brief Compile-time DetectorParams for profile P. The float path keeps the
+ * per-sample constants of the profile as they are (as the runtime
+ * DETECTOR_PARAMS did); only the cooldown follows the ODR.
+ */
+template <class P, uint32_t ODR>
+struct StaticDetectorParams {
+    static constexpr float alpha_lta = P::ALPHA_LTA;
+    static constexpr float alpha_sta = P::ALPHA_STA;
+    static constexpr float trigger_ratio = P::TRIGGER_RATIO;
+    static constexpr float noise_floor = P::NOISE_FLOOR;
+    static constexpr float hpf_coeff = P::HPF_COEFF;
+    static constexpr float dropout_ms2 = P::DROPOUT_MS2;
+    static constexpr float lta_floor = P::LTA_FLOOR;
+    static constexpr uint32_t cooldown_samples = (P::COOLDOWN_MS * ODR) / 1000;
+
+    /** Same values as a runtime struct (logging, the non-template API). */
+    static DetectorParams runtime() {
+        DetectorParams p = {alpha_lta, alpha_sta, trigger_ratio, noise_floor,
+                            hpf_coeff, dropout_ms2, lta_floor, cooldown_samples};
+        return p;
+    }
+};
+
+template <class P, uint32_t ODR> constexpr float StaticDetectorParams<P, ODR>::alpha_lta;
+template <class P, uint32_t ODR> constexpr float StaticDetectorParams<P, ODR>::alpha_sta;
+template <class P, uint32_t ODR> constexpr float StaticDetectorParams<P, ODR>::trigger_ratio;
+template <class P, uint32_t ODR> constexpr float StaticDetectorParams<P, ODR>::noise_floor;
+template <class P, uint32_t ODR> constexpr float StaticDetectorParams<P, ODR>::hpf_coeff;
+template <class P, uint32_t ODR> constexpr float StaticDetectorParams<P, ODR>::dropout_ms2;
+template <class P, uint32_t ODR> constexpr float StaticDetectorParams<P, ODR>::lta_floor;
+template <class P, uint32_t ODR> constexpr uint32_t StaticDetectorParams<P, ODR>::cooldown_samples;
+
+/**
+ * @brief Compile-time FixedParams for profile P at ODR, derived the same way
+ * as fixedParamsFromFloat() except for power-of-two alphas (header comment).
+ */
+template <class P, uint32_t ODR>
+struct StaticFixedParams {
+    static_assert(ODR == 100 || ODR == 200 || ODR == 400 || ODR == 800,
+                  "ODR must be 100, 200, 400 or 800 Hz");
+    static constexpr uint32_t K = ODR / 100;
+
+    static constexpr int32_t hpf_coeff_q15 = profileQ(profileRoot(P::HPF_COEFF, K), 15);
+    static constexpr int32_t alpha_lta_q15 = profileAlphaQ15(P::ALPHA_LTA, K);
+    static constexpr int32_t alpha_sta_q15 = profileAlphaQ15(P::ALPHA_STA, K);
+    static constexpr int32_t trigger_ratio_q8 = profileQ(P::TRIGGER_RATIO, 8);
+    static constexpr int32_t noise_floor_q4 = profileCounts(P::NOISE_FLOOR, DSP_MAG_FRAC_BITS);
+    static constexpr int32_t dropout_q4 = profileCounts(P::DROPOUT_MS2, DSP_MAG_FRAC_BITS);
+    static constexpr int32_t lta_floor_q12 = profileCounts(P::LTA_FLOOR, DSP_EMA_FRAC_BITS);
+    static constexpr int32_t sta_min_q12 = profileCounts(P::NOISE_FLOOR, DSP_EMA_FRAC_BITS);
+    static constexpr uint32_t cooldown_samples = (P::COOLDOWN_MS * ODR) / 1000;
+
+    static_assert(alpha_lta_q15 > 0 && alpha_sta_q15 > 0, "alpha underflows Q15 at this ODR");
+
+    /** Same values as a runtime struct (fixedDetectorInit(), logging). */
+    static FixedParams runtime() {
+        FixedParams p = {hpf_coeff_q15, alpha_lta_q15, alpha_sta_q15, trigger_ratio_q8,
+                         noise_floor_q4, dropout_q4, lta_floor_q12, sta_min_q12,
+                         cooldown_samples};
+        return p;
+    }
+};
+
+template <class P, uint32_t ODR> constexpr uint32_t StaticFixedParams<P, ODR>::K;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::hpf_coeff_q15;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::alpha_lta_q15;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::alpha_sta_q15;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::trigger_ratio_q8;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::noise_floor_q4;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::dropout_q4;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::lta_floor_q12;
+template <class P, uint32_t ODR> constexpr int32_t StaticFixedParams<P, ODR>::sta_min_q12;
+template <class P, uint32_t ODR> constexpr uint32_t StaticFixedParams<P, ODR>::cooldown_samples;
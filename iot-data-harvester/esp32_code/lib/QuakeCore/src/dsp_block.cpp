@@ -0,0 +1,96 @@
+/**
+ * Module: Float Block Kernels for the STA/LTA Detector
+ * See dsp_block.h for the pass structure and kernel selection.
+ */
+
+#include "dsp_block.h"
+
+#include <math.h>
+
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+  #define DSP_BLOCK_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  #include <arm_neon.h>
+  #define DSP_BLOCK_NEON 1
+#endif
+
+const char *dspBlockKernel() {
+#if defined(DSP_BLOCK_SSE2)
+    return "SSE2";
+#elif defined(DSP_BLOCK_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+static inline float magnitudeOne(const RawSample &s) {
+    float x = s.x, y = s.y, z = s.z;
+    return sqrtf(x * x + y * y + z * z) * ADXL345_LSB_TO_MS2;
+}
+
+void blockMagnitude(const RawSample *in, float *mag, size_t n) {
+    size_t i = 0;
+#if defined(DSP_BLOCK_SSE2)
+    const __m128 scale = _mm_set1_ps(ADXL345_LSB_TO_MS2);
+    for (; i + 4 <= n; i += 4) {
+        // AoS int16 -> SoA float, one lane per sample
+        __m128 x = _mm_setr_ps(in[i].x, in[i + 1].x, in[i + 2].x, in[i + 3].x);
+        __m128 y = _mm_setr_ps(in[i].y, in[i + 1].y, in[i + 2].y, in[i + 3].y);
+        __m128 z = _mm_setr_ps(in[i].z, in[i + 1].z, in[i + 2].z, in[i + 3].z);
+        __m128 sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        _mm_storeu_ps(mag + i, _mm_mul_ps(_mm_sqrt_ps(sq), scale));
+    }
+#elif defined(DSP_BLOCK_NEON)
+    const float32x4_t scale = vdupq_n_f32(ADXL345_LSB_TO_MS2);
+    for (; i + 4 <= n; i += 4) {
+        int16x4x3_t v = vld3_s16((const int16_t *)&in[i]); // De-interleave x/y/z
+        float32x4_t x = vcvtq_f32_s32(vmovl_s16(v.val[0]));
+        float32x4_t y = vcvtq_f32_s32(vmovl_s16(v.val[1]));
+        float32x4_t z = vcvtq_f32_s32(vmovl_s16(v.val[2]));
+        // Explicit mul + add (no vfma) to keep results identical to the scalar kernel
+        float32x4_t sq = vaddq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)), vmulq_f32(z, z));
+        vst1q_f32(mag + i, vmulq_f32(vsqrtq_f32(sq), scale));
+    }
+#else
+    for (; i + 4 <= n; i += 4) {
+        mag[i]     = magnitudeOne(in[i]);
+        mag[i + 1] = magnitudeOne(in[i + 1]);
+        mag[i + 2] = magnitudeOne(in[i + 2]);
+        mag[i + 3] = magnitudeOne(in[i + 3]);
+    }
+#endif
+    for (; i < n; i++) {
+        mag[i] = magnitudeOne(in[i]);
+    }
+}
+
+void blockAbsGate(const float *in, float *out, size_t n, float floor) {
+    size_t i = 0;
+#if defined(DSP_BLOCK_SSE2)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 thr = _mm_set1_ps(floor);
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_andnot_ps(signMask, _mm_loadu_ps(in + i));
+        _mm_storeu_ps(out + i, _mm_and_ps(a, _mm_cmpge_ps(a, thr)));
+    }
+#elif defined(DSP_BLOCK_NEON)
+    const float32x4_t thr = vdupq_n_f32(floor);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t a = vabsq_f32(vld1q_f32(in + i));
+        uint32x4_t keep = vcgeq_f32(a, thr);
+        vst1q_f32(out + i, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), keep)));
+    }
+#endif
+    for (; i < n; i++) {
+        float a = fabsf(in[i]);
+        out[i] = a < floor ? 0.0f : a;
+    }
+}
+
+size_t detectorProcessBlock(const DetectorParams &p, DetectorState &st,
+                            const RawSample *in, size_t n,
+                            BlockTrigger *trigs, size_t maxTrigs) {
+    return detectorProcessBlockT(p, st, in, n, trigs, maxTrigs);
+}
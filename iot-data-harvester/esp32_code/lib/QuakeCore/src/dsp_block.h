@@ -0,0 +1,140 @@
+/**
+ * Module: Float Block Kernels for the STA/LTA Detector
+ *
+ * Description:
+ * Block version of detectorStep() (sta_lta.h) for FIFO bursts and archive
+ * scans. Each block is processed in passes:
+ *   1. Vector magnitude of every sample          (packed, data-parallel)
+ *   2. Dropout check + HPF recurrence             (scalar, loop-carried)
+ *   3. |HPF| + Noise Gate                         (packed, data-parallel)
+ *   4. STA/LTA recurrences + cooldown + trigger   (scalar, loop-carried)
+ * Passes 2 and 4 depend on the previous sample and cannot be vectorized
+ * across time; they run over the scratch arrays of passes 1 and 3.
+ *
+ * Kernels (selected at compile time, see dspBlockKernel()):
+ * - SSE2:   x86-64 hosts (replay harness, backend tooling).
+ * - NEON:   AArch64 hosts (vld3 de-interleaves x/y/z in one load).
+ * - scalar: 4x unrolled C, used on the ESP32-C3. The RISC-V core has no FPU
+ *           or packed-SIMD extension and ESP-DSP ships only plain C for it,
+ *           so the MCU high-rate path stays on the Q15 pipeline (dsp_fixed.h).
+ *
+ * All kernels compute the magnitude as sqrt(x*x + y*y + z*z) in float with
+ * the same operation order, so they produce identical results. The
+ * sqrt(pow()) per-sample path in the firmware remains the reference the
+ * replay harness checks this module against.
+ */
+
+#pragma once
+
+#include "quake_types.h"
+#include "sta_lta.h"
+
+#define DSP_BLOCK_CHUNK 64 // Scratch array length; longer blocks are processed in chunks
+
+/**
+ * @brief Trigger found inside a block.
+ */
+struct BlockTrigger {
+    size_t index; // Sample index inside the block
+    float ratio;  // STA/LTA ratio at trigger time
+    float sta;    // STA at trigger time (m/s^2)
+};
+
+/** Name of the compiled-in kernel ("SSE2", "NEON" or "scalar"). */
+const char *dspBlockKernel();
+
+/**
+ * @brief Vector magnitude of n samples in m/s^2.
+ */
+void blockMagnitude(const RawSample *in, float *mag, size_t n);
+
+/**
+ * @brief out[i] = |in[i]|, or 0 if below floor (Noise Gate).
+ */
+void blockAbsGate(const float *in, float *out, size_t n, float floor);
+
+/**
+ * @brief Runs a block of any length through the detector.
+ * Produces the same state and triggers as calling detectorStep() on every
+ * sample's float magnitude.
+ * @param trigs Receives the first maxTrigs triggers of the block, in order.
+ *              A FIFO burst is shorter than the cooldown, so one entry is
+ *              enough there; archive scans pass a larger array.
+ * @return Number of triggers in the block (may exceed maxTrigs).
+ */
+size_t detectorProcessBlock(const DetectorParams &p, DetectorState &st,
+                            const RawSample *in, size_t n,
+                            BlockTrigger *trigs, size_t maxTrigs);
+
+/**
+ * @brief Detector passes over one chunk (n <= DSP_BLOCK_CHUNK) starting at
+ * sample base of the block. Appends triggers after the found already stored.
+ * @return Updated trigger count.
+ */
+template <class Params>
+static inline size_t detectorProcessChunkT(const Params &p, DetectorState &st,
+                                           const RawSample *in, size_t n, size_t base,
+                                           BlockTrigger *trigs, size_t maxTrigs, size_t found) {
+    float mag[DSP_BLOCK_CHUNK];
+    float hpf[DSP_BLOCK_CHUNK];
+
+    // Pass 1: magnitudes
+    blockMagnitude(in, mag, n);
+
+    // Pass 2: Dropout Protection + High-Pass Filter. A dropped frame leaves
+    // the filter state untouched, exactly as detectorStep() does.
+    for (size_t i = 0; i < n; i++) {
+        if (mag[i] < p.dropout_ms2) {
+            hpf[i] = 0.0f; // Gated below, never read by pass 4
+            continue;
+        }
+        st.filtered_mag = p.hpf_coeff * (st.filtered_mag + mag[i] - st.prev_raw_mag);
+        st.prev_raw_mag = mag[i];
+        hpf[i] = st.filtered_mag;
+    }
+
+    // Pass 3: Noise Gate
+    blockAbsGate(hpf, hpf, n, p.noise_floor);
+
+    // Pass 4: cooldown, STA/LTA and trigger
+    for (size_t i = 0; i < n; i++) {
+        if (st.inAlarm && ++st.alarmSamples > p.cooldown_samples) {
+            st.inAlarm = false;
+        }
+        if (mag[i] < p.dropout_ms2) continue;
+
+        float abs_signal = hpf[i];
+        st.lta = (p.alpha_lta * abs_signal) + ((1.0f - p.alpha_lta) * st.lta);
+        st.sta = (p.alpha_sta * abs_signal) + ((1.0f - p.alpha_sta) * st.sta);
+        if (st.lta < p.lta_floor) st.lta = p.lta_floor;
+
+        float ratio = st.sta / st.lta;
+        if (ratio >= p.trigger_ratio && st.sta > p.noise_floor && !st.inAlarm) {
+            st.inAlarm = true;
+            st.alarmSamples = 0;
+            if (found < maxTrigs) {
+                trigs[found].index = base + i;
+                trigs[found].ratio = ratio;
+                trigs[found].sta = st.sta;
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief detectorProcessBlock() for any parameter type with the
+ * DetectorParams field names (see detectorStepT() in sta_lta.h).
+ */
+template <class Params>
+size_t detectorProcessBlockT(const Params &p, DetectorState &st,
+                             const RawSample *in, size_t n,
+                             BlockTrigger *trigs, size_t maxTrigs) {
+    size_t found = 0;
+    for (size_t off = 0; off < n; off += DSP_BLOCK_CHUNK) {
+        size_t len = n - off < DSP_BLOCK_CHUNK ? n - off : DSP_BLOCK_CHUNK;
+        found = detectorProcessChunkT(p, st, in + off, len, off, trigs, maxTrigs, found);
+    }
+    return found;
+}
@@ -0,0 +1,86 @@
+/**
+ * Module: Fixed-Point STA/LTA Detector
+ * See dsp_fixed.h for number formats and the block processing model.
+ */
+
+#include "dsp_fixed.h"
+
+#include <math.h>
+
+// Output data rate the float constants were tuned at.
+static const float REFERENCE_ODR_HZ = 100.0f;
+
+// Largest sum of squares that still fits the Q4 shift (|a| <= 4096 counts ~ 16G).
+static const uint32_t MAG_SQ_CLAMP = 0x00FFFFFFUL;
+
+static int32_t toQ(float value, int frac_bits) {
+    return (int32_t)lrintf(value * (float)(1L << frac_bits));
+}
+
+static int32_t ms2ToCounts(float ms2, int frac_bits) {
+    return toQ(ms2 / ADXL345_LSB_TO_MS2, frac_bits);
+}
+
+FixedParams fixedParamsFromFloat(float alpha_lta, float alpha_sta, float hpf_coeff,
+                                 float trigger_ratio, float noise_floor_ms2,
+                                 float dropout_ms2, float lta_floor_ms2,
+                                 uint32_t odr_hz, uint32_t cooldown_ms) {
+    // An EMA/pole applied k times per reference period must decay by the same
+    // amount: a' = a^(1/k), alpha' = 1 - (1 - alpha)^(1/k).
+    const float k = (float)odr_hz / REFERENCE_ODR_HZ;
+
+    FixedParams p;
+    p.hpf_coeff_q15    = toQ(powf(hpf_coeff, 1.0f / k), 15);
+    p.alpha_lta_q15    = toQ(1.0f - powf(1.0f - alpha_lta, 1.0f / k), 15);
+    p.alpha_sta_q15    = toQ(1.0f - powf(1.0f - alpha_sta, 1.0f / k), 15);
+    p.trigger_ratio_q8 = toQ(trigger_ratio, 8);
+    p.noise_floor_q4   = ms2ToCounts(noise_floor_ms2, DSP_MAG_FRAC_BITS);
+    p.dropout_q4       = ms2ToCounts(dropout_ms2, DSP_MAG_FRAC_BITS);
+    p.lta_floor_q12    = ms2ToCounts(lta_floor_ms2, DSP_EMA_FRAC_BITS);
+    p.sta_min_q12      = ms2ToCounts(noise_floor_ms2, DSP_EMA_FRAC_BITS);
+    p.cooldown_samples = (cooldown_ms * odr_hz) / 1000;
+    return p;
+}
+
+void fixedDetectorInit(FixedDetector &d, const FixedParams &p, float seed_mag_ms2) {
+    d.p = p;
+    d.prev_mag_q4 = ms2ToCounts(seed_mag_ms2, DSP_MAG_FRAC_BITS);
+    d.hpf_q4 = 0;
+    d.lta_q12 = ms2ToCounts(seed_mag_ms2, DSP_EMA_FRAC_BITS);
+    d.sta_q12 = d.lta_q12;
+    d.inAlarm = false;
+    d.alarmSamples = 0;
+}
+
+uint32_t isqrt32(uint32_t v) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+void fixedMagnitudeBlock(const RawSample *in, int32_t *mag_q4, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int32_t x = in[i].x;
+        int32_t y = in[i].y;
+        int32_t z = in[i].z;
+        uint32_t sq = (uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z);
+        if (sq > MAG_SQ_CLAMP) sq = MAG_SQ_CLAMP;
+        // sqrt(sq * 2^8) = sqrt(sq) * 2^4 -> Q4 counts
+        mag_q4[i] = (int32_t)isqrt32(sq << (2 * DSP_MAG_FRAC_BITS));
+    }
+}
+
+bool fixedProcessBlock(FixedDetector &d, const RawSample *in, size_t n, FixedTrigger *trig) {
+    return fixedProcessBlockT(d.p, d, in, n, trig);
+}
@@ -0,0 +1,169 @@
+/**
+ * Module: Fixed-Point STA/LTA Detector
+ *
+ * Description:
+ * Integer implementation of the sensorTask pipeline (Dropout Protection,
+ * High-Pass Filter, Noise Gate, STA/LTA) for the high-rate (400-800 Hz)
+ * acquisition mode. The ESP32-C3 has no FPU, so the float path with
+ * sqrt(pow()) costs thousands of cycles per sample; this path works on raw
+ * ADXL345 counts and only uses 32x32->64 multiplies and an integer sqrt.
+ *
+ * Number formats:
+ * - Magnitude / HPF output: Q4 counts (1/16 LSB = 0.00245 m/s^2).
+ * - STA / LTA state:        Q12 counts (extra guard bits for small alphas).
+ * - Coefficients:           Q15 (0x8000 = 1.0).
+ * - Trigger ratio:          Q8.
+ *
+ * Samples are processed per block: magnitudes for the whole block are
+ * computed first, then the recurrences run over the scratch array.
+ * The recurrences are a template over the parameter type
+ * (fixedProcessBlockT) so compile-time profiles (detector_profile.h) turn the
+ * Q15 coefficients into immediates, and power-of-two alphas into shifts.
+ */
+
+#pragma once
+
+#include "quake_types.h"
+
+#define DSP_Q15_ONE        32768
+#define DSP_MAG_FRAC_BITS  4
+#define DSP_EMA_FRAC_BITS  12
+#define DSP_MAX_BLOCK      32
+
+/**
+ * @brief Detector constants in fixed-point form. Built once at boot with
+ * fixedParamsFromFloat() so the float tuning constants stay the reference.
+ */
+struct FixedParams {
+    int32_t hpf_coeff_q15;     // HPF pole (0.9 at 100 Hz)
+    int32_t alpha_lta_q15;
+    int32_t alpha_sta_q15;
+    int32_t trigger_ratio_q8;
+    int32_t noise_floor_q4;    // Noise Gate threshold
+    int32_t dropout_q4;        // Frames below this magnitude are discarded
+    int32_t lta_floor_q12;     // Safety floor for the LTA
+    int32_t sta_min_q12;       // Minimum STA for a valid trigger (noise floor)
+    uint32_t cooldown_samples; // Samples to ignore after a trigger
+};
+
+/**
+ * @brief Running state of the fixed-point detector.
+ */
+struct FixedDetector {
+    FixedParams p;
+    int32_t prev_mag_q4;
+    int32_t hpf_q4;
+    int32_t lta_q12;
+    int32_t sta_q12;
+    bool inAlarm;
+    uint32_t alarmSamples;
+};
+
+/**
+ * @brief Result of a trigger found inside a block.
+ */
+struct FixedTrigger {
+    size_t index;      // Sample index inside the block
+    int32_t ratio_q8;  // STA/LTA ratio at trigger time
+    int32_t sta_q12;   // STA at trigger time
+};
+
+/**
+ * @brief Q15 multiply: (value * coeff) >> 15 with a 64-bit product.
+ */
+static inline int32_t mulQ15(int32_t value, int32_t coeff_q15) {
+    return (int32_t)(((int64_t)value * coeff_q15) >> 15);
+}
+
+/**
+ * @brief Converts the float tuning constants into fixed-point parameters.
+ * The alphas and the HPF pole are re-derived for odr_hz so the filter time
+ * constants stay the same as the 100 Hz reference tuning.
+ * @param odr_hz Sensor output data rate.
+ * @param cooldown_ms Alarm cooldown expressed in milliseconds.
+ */
+FixedParams fixedParamsFromFloat(float alpha_lta, float alpha_sta, float hpf_coeff,
+                                 float trigger_ratio, float noise_floor_ms2,
+                                 float dropout_ms2, float lta_floor_ms2,
+                                 uint32_t odr_hz, uint32_t cooldown_ms);
+
+/**
+ * @brief Resets the detector state, seeding the filters with a magnitude
+ * measured during the stabilization phase (m/s^2).
+ */
+void fixedDetectorInit(FixedDetector &d, const FixedParams &p, float seed_mag_ms2);
+
+/**
+ * @brief Integer square root (floor) of a 32-bit value.
+ */
+uint32_t isqrt32(uint32_t v);
+
+/**
+ * @brief Vector magnitude of a block of samples in Q4 counts.
+ * @param n Number of samples (at most DSP_MAX_BLOCK).
+ */
+void fixedMagnitudeBlock(const RawSample *in, int32_t *mag_q4, size_t n);
+
+/**
+ * @brief Runs one block through Dropout / HPF / Noise Gate / STA/LTA.
+ * @param trig Filled with the first trigger in the block, if any.
+ * @return true if the block contains a trigger.
+ */
+bool fixedProcessBlock(FixedDetector &d, const RawSample *in, size_t n, FixedTrigger *trig);
+
+/**
+ * @brief fixedProcessBlock() with the parameters taken from p instead of d.p:
+ * a FixedParams, or a StaticFixedParams profile (detector_profile.h).
+ */
+template <class Params>
+bool fixedProcessBlockT(const Params &p, FixedDetector &d, const RawSample *in, size_t n,
+                        FixedTrigger *trig) {
+    int32_t mag_q4[DSP_MAX_BLOCK];
+    bool triggered = false;
+
+    if (n > DSP_MAX_BLOCK) n = DSP_MAX_BLOCK;
+    fixedMagnitudeBlock(in, mag_q4, n);
+
+    for (size_t i = 0; i < n; i++) {
+        // Alarm cooldown counted in samples (sensor clock)
+        if (d.inAlarm && ++d.alarmSamples > p.cooldown_samples) {
+            d.inAlarm = false;
+        }
+
+        // Signal Dropout Protection
+        int32_t mag = mag_q4[i];
+        if (mag < p.dropout_q4) {
+            continue;
+        }
+
+        // High-Pass Filter (removes gravity)
+        d.hpf_q4 = mulQ15(d.hpf_q4 + mag - d.prev_mag_q4, p.hpf_coeff_q15);
+        d.prev_mag_q4 = mag;
+        int32_t abs_signal = d.hpf_q4 < 0 ? -d.hpf_q4 : d.hpf_q4;
+
+        // Noise Gate
+        if (abs_signal < p.noise_floor_q4) {
+            abs_signal = 0;
+        }
+
+        // STA/LTA update: avg += alpha * (x - avg)
+        int32_t x_q12 = abs_signal << (DSP_EMA_FRAC_BITS - DSP_MAG_FRAC_BITS);
+        d.lta_q12 += mulQ15(x_q12 - d.lta_q12, p.alpha_lta_q15);
+        d.sta_q12 += mulQ15(x_q12 - d.sta_q12, p.alpha_sta_q15);
+        if (d.lta_q12 < p.lta_floor_q12) d.lta_q12 = p.lta_floor_q12;
+
+        // Trigger: sta / lta >= ratio, evaluated without a division
+        if (!d.inAlarm && d.sta_q12 > p.sta_min_q12 &&
+            ((int64_t)d.sta_q12 << 8) >= (int64_t)d.lta_q12 * p.trigger_ratio_q8) {
+            d.inAlarm = true;
+            d.alarmSamples = 0;
+            if (!triggered && trig != NULL) {
+                trig->index = i;
+                trig->ratio_q8 = (int32_t)(((int64_t)d.sta_q12 << 8) / d.lta_q12);
+                trig->sta_q12 = d.sta_q12;
+            }
+            triggered = true;
+        }
+    }
+    return triggered;
+}
@@ -0,0 +1,74 @@
+/**
+ * Module: Event Backlog
+ *
+ * Description:
+ * Fixed-capacity FIFO that holds trigger events while the uplink is down, so
+ * they are flushed in order once it is back instead of being dropped. Owned
+ * by a single task (the network task), so there is no locking.
+ *
+ * When the backlog is full the OLDEST entry is overwritten and counted in
+ * dropped(): for a live alarm the most recent events matter most. Storage is
+ * a fixed array inside the object (static RAM for a global instance).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+template <typename T, size_t N>
+class EventBacklog {
+    static_assert(N >= 1, "EventBacklog needs at least one slot");
+
+public:
+    EventBacklog() : first(0), count(0), drops(0), peak(0) {}
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /**
+     * @brief Appends an item, overwriting the oldest one when full.
+     * @return false if an older item was dropped to make room.
+     */
+    bool push(const T &item) {
+        bool kept = true;
+        if (count == N) {
+            first = (first + 1) % N;
+            count--;
+            drops++;
+            kept = false;
+        }
+        storage[(first + count) % N] = item;
+        count++;
+        if (count > peak) peak = count;
+        return kept;
+    }
+
+    /**
+     * @brief Copies up to max of the oldest items, without removing them.
+     * @return Number of items copied.
+     */
+    size_t peek(T *out, size_t max) const {
+        size_t n = count < max ? count : max;
+        for (size_t i = 0; i < n; i++) out[i] = storage[(first + i) % N];
+        return n;
+    }
+
+    /** Removes the n oldest items (after they were delivered). */
+    void pop(size_t n) {
+        if (n > count) n = count;
+        first = (first + n) % N;
+        count -= n;
+    }
+
+    uint32_t dropped() const { return drops; }
+    size_t highWater() const { return peak; }
+
+private:
+    T storage[N];
+    size_t first;
+    size_t count;
+    uint32_t drops;
+    size_t peak;
+};
@@ -0,0 +1,192 @@
+/**
+ * Module: Event Features and Local Pre-Classification
+ * See event_features.h for the feature definitions.
+ */
+
+#include "event_features.h"
+
+#include <math.h>
+
+// Goertzel bins: 1 Hz apart where earthquakes put their energy, wider above.
+// With the default 1 s window every bin is an exact DFT bin.
+static const uint8_t FEATURE_BIN_HZ[FEATURE_BINS] = {
+    1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, 24, 28, 32
+};
+
+// --------------------------------------------------------------------------
+// CLASSIFIER
+// --------------------------------------------------------------------------
+enum FeatureIndex { FEAT_DURATION_MS, FEAT_DOMINANT_HZ, FEAT_PGA_MMS2 };
+
+/**
+ * @brief One tree node: feature < threshold goes to below, otherwise to above.
+ * A child >= 0 is a node index, a child < 0 the leaf class -child.
+ */
+struct ClassifierNode {
+    uint8_t feature;
+    uint32_t threshold;
+    int8_t below;
+    int8_t above;
+};
+
+#define LEAF(c) ((int8_t)-(c))
+
+static constexpr ClassifierNode CLASSIFIER_TREE[] = {
+    // 0: above the trigger level for less than 150 ms of the window: a shock, not shaking
+    { FEAT_DURATION_MS, 150, LEAF(EVENT_CLASS_IMPULSIVE), 1 },
+    // 1: sustained and dominated by earthquake frequencies
+    { FEAT_DOMINANT_HZ, 10, LEAF(EVENT_CLASS_SEISMIC), 2 },
+    // 2: high-frequency: steady for most of the window (machine) or a ringing impulse
+    { FEAT_DURATION_MS, 600, LEAF(EVENT_CLASS_IMPULSIVE), LEAF(EVENT_CLASS_MACHINERY) },
+};
+static constexpr size_t CLASSIFIER_NODES = sizeof(CLASSIFIER_TREE) / sizeof(CLASSIFIER_TREE[0]);
+
+// Children must point forward (so the walk ends within CLASSIFIER_NODES steps)
+// or to a valid class.
+static constexpr bool childValid(int8_t child, size_t node) {
+    return child < 0 ? -child <= EVENT_CLASS_MAX : (size_t)child > node && (size_t)child < CLASSIFIER_NODES;
+}
+static constexpr bool treeValid(size_t node) {
+    return node >= CLASSIFIER_NODES ||
+           (CLASSIFIER_TREE[node].feature <= FEAT_PGA_MMS2 && childValid(CLASSIFIER_TREE[node].below, node) &&
+            childValid(CLASSIFIER_TREE[node].above, node) && treeValid(node + 1));
+}
+static_assert(treeValid(0), "CLASSIFIER_TREE has a backward edge or an invalid leaf");
+
+uint8_t eventClassify(const EventFeatures &f) {
+    const uint32_t values[] = { f.duration_ms, f.dominant_hz, f.pga_mms2 };
+    int8_t node = 0;
+    while (node >= 0) {
+        const ClassifierNode &n = CLASSIFIER_TREE[node];
+        node = values[n.feature] < n.threshold ? n.below : n.above;
+    }
+    return (uint8_t)-node;
+}
+
+const char *eventClassName(uint8_t event_class) {
+    switch (event_class) {
+        case EVENT_CLASS_SEISMIC:   return "seismic";
+        case EVENT_CLASS_IMPULSIVE: return "impulsive";
+        case EVENT_CLASS_MACHINERY: return "machinery";
+        default:                    return "none";
+    }
+}
+
+// --------------------------------------------------------------------------
+// EXTRACTOR
+// --------------------------------------------------------------------------
+bool featureInit(FeatureExtractor &fx, uint32_t odr_hz, uint32_t window_ms) {
+    fx.active = false;
+    fx.seeded = false;
+    fx.odr_hz = odr_hz;
+    fx.window = (window_ms * odr_hz) / 1000;
+    if (odr_hz == 0 || window_ms == 0 || window_ms > FEATURE_MAX_WINDOW_MS || fx.window == 0) return false;
+
+    // Rest time constant ~2 s: largest 2^k <= 2 * odr
+    fx.rest_shift = 0;
+    while ((2u << fx.rest_shift) <= 2 * odr_hz) fx.rest_shift++;
+
+    fx.bins = 0;
+    for (size_t b = 0; b < FEATURE_BINS; b++) {
+        const uint32_t hz = FEATURE_BIN_HZ[b];
+        if (2 * hz >= odr_hz || hz * window_ms < 1000) continue;
+        fx.bin_hz[fx.bins] = (uint8_t)hz;
+        fx.coeff[fx.bins] = 2.0f * cosf(2.0f * (float)M_PI * hz / odr_hz);
+        fx.bins++;
+    }
+    return fx.bins > 0;
+}
+
+bool featureBegin(FeatureExtractor &fx, uint32_t trigger_index, float level_ms2) {
+    if (fx.active) return false;
+    const float level = level_ms2 / ADXL345_LSB_TO_MS2;
+    fx.level_sq = level > 1.0f ? (uint32_t)(level * level) : 1;
+    fx.start_index = trigger_index;
+    fx.seen = 0;
+    fx.active = true;
+    return true;
+}
+
+/**
+ * @brief Zeroes the window sums and freezes the rest estimate.
+ */
+static void openWindow(FeatureExtractor &fx) {
+    fx.peak_sq = 0;
+    fx.above = 0;
+    for (int a = 0; a < 3; a++) {
+        fx.rest[a] = (fx.rest_q8[a] + 128) >> 8;
+        fx.energy[a] = 0;
+        for (size_t b = 0; b < fx.bins; b++) fx.s1[a][b] = fx.s2[a][b] = 0.0f;
+    }
+}
+
+bool featureFeed(FeatureExtractor &fx, const RawSample *block, size_t count, uint32_t first_index) {
+    bool done = false;
+    for (size_t i = 0; i < count; i++) {
+        const int32_t v[3] = { block[i].x, block[i].y, block[i].z };
+        if (!fx.seeded) {
+            for (int a = 0; a < 3; a++) fx.rest_q8[a] = v[a] * 256;
+            fx.seeded = true;
+        }
+
+        // Wraps with the sample counter
+        const bool inWindow = fx.active && (int32_t)(first_index + (uint32_t)i - fx.start_index) >= 0;
+        if (!inWindow) {
+            for (int a = 0; a < 3; a++) fx.rest_q8[a] += (v[a] * 256 - fx.rest_q8[a]) >> fx.rest_shift;
+            continue;
+        }
+
+        if (fx.seen == 0) openWindow(fx);
+        uint32_t mag_sq = 0;
+        for (int a = 0; a < 3; a++) {
+            const int32_t d = v[a] - fx.rest[a];
+            const uint32_t d_sq = (uint32_t)(d * d);
+            mag_sq += d_sq;
+            fx.energy[a] += d_sq;
+
+            const float x = (float)d;
+            for (size_t b = 0; b < fx.bins; b++) {
+                const float s0 = x + fx.coeff[b] * fx.s1[a][b] - fx.s2[a][b];
+                fx.s2[a][b] = fx.s1[a][b];
+                fx.s1[a][b] = s0;
+            }
+        }
+        if (mag_sq > fx.peak_sq) fx.peak_sq = mag_sq;
+        if (mag_sq > fx.level_sq) fx.above++;
+
+        if (++fx.seen == fx.window) {
+            fx.active = false;
+            done = true;
+        }
+    }
+    return done;
+}
+
+static uint32_t saturateU32(float v) {
+    return v >= 4294967295.0f ? 0xFFFFFFFFUL : (uint32_t)v;
+}
+
+void featureResult(const FeatureExtractor &fx, EventFeatures &out) {
+    const float mms2 = ADXL345_LSB_TO_MS2 * 1000.0f;
+    out.pga_mms2 = saturateU32(sqrtf((float)fx.peak_sq) * mms2 + 0.5f);
+    const uint32_t duration = (uint32_t)(((uint64_t)fx.above * 1000) / fx.odr_hz);
+    out.duration_ms = (uint16_t)(duration > 0xFFFF ? 0xFFFF : duration);
+    for (int a = 0; a < 3; a++) {
+        out.energy[a] = saturateU32((float)fx.energy[a] * mms2 * mms2 / fx.odr_hz + 0.5f);
+    }
+
+    float best = 0.0f;
+    out.dominant_hz = 0;
+    for (size_t b = 0; b < fx.bins; b++) {
+        float power = 0.0f;
+        for (int a = 0; a < 3; a++) {
+            const float s1 = fx.s1[a][b], s2 = fx.s2[a][b];
+            power += s1 * s1 + s2 * s2 - fx.coeff[b] * s1 * s2;
+        }
+        if (power > best) {
+            best = power;
+            out.dominant_hz = fx.bin_hz[b];
+        }
+    }
+    out.event_class = eventClassify(out);
+}
@@ -0,0 +1,118 @@
+/**
+ * Module: Event Features and Local Pre-Classification
+ *
+ * Description:
+ * Summarizes the first FEATURE_WINDOW_MS of a trigger in a few integers, so
+ * the backend can sort events without the waveform and the sensor can drop the
+ * obvious non-seismic ones (doors, knocks, dropped objects) before they cost a
+ * signed request:
+ *
+ *   pga_mms2     peak of |a - rest| over the window, mm/s^2
+ *   duration_ms  time |a - rest| stays above the trigger level
+ *   dominant_hz  strongest bin of a Goertzel bank (FEATURE_BIN_HZ), summed
+ *                over the three axes
+ *   energy[3]    per-axis integral of (a - rest)^2 dt, (mm/s^2)^2 * s
+ *
+ * "rest" is a slow per-axis integer average (gravity plus offset, ~2 s time
+ * constant) that is frozen at the trigger sample. The extractor sees every
+ * sample, but only the rest tracking (three shifts and adds) runs outside a
+ * window; the Goertzel bank and the sums only run for the window after a
+ * trigger, and nothing is buffered.
+ *
+ * eventClassify() walks a threshold tree compiled in as a constexpr table
+ * (event_features.cpp) and checked at compile time to terminate.
+ */
+
+#pragma once
+
+#include "quake_types.h"
+
+#define FEATURE_BINS       16
+#define FEATURE_MAX_WINDOW_MS 10000
+
+/**
+ * @brief Event classes. 0 means "not classified" (no feature window).
+ */
+enum EventClass {
+    EVENT_CLASS_NONE      = 0,
+    EVENT_CLASS_SEISMIC   = 1, // Low-frequency, sustained shaking
+    EVENT_CLASS_IMPULSIVE = 2, // Short burst: door slam, knock, dropped object
+    EVENT_CLASS_MACHINERY = 3, // Sustained high-frequency: appliances, pumps, traffic
+    EVENT_CLASS_MAX       = EVENT_CLASS_MACHINERY
+};
+
+/**
+ * @brief Features of one trigger window, in the integer units sent on the wire.
+ */
+struct EventFeatures {
+    uint8_t event_class;   // EventClass
+    uint8_t dominant_hz;   // 0 if no bin saw any energy
+    uint16_t duration_ms;
+    uint32_t pga_mms2;
+    uint32_t energy[3];    // x, y, z; saturates at UINT32_MAX
+};
+
+/**
+ * @brief Extractor state: rest tracking plus the window in progress.
+ */
+struct FeatureExtractor {
+    uint32_t window;               // Samples per feature window
+    uint32_t odr_hz;
+    uint8_t rest_shift;            // Rest EMA factor 2^-rest_shift
+    bool seeded;
+    int32_t rest_q8[3];            // Rest per axis, counts << 8
+
+    bool active;
+    uint32_t start_index;          // Sample index of the trigger
+    uint32_t seen;                 // Window samples accumulated
+    int32_t rest[3];               // Frozen at the trigger, counts
+    uint32_t level_sq;             // Trigger level, counts^2
+    uint32_t peak_sq;
+    uint32_t above;
+    uint64_t energy[3];            // Sum of (a - rest)^2, counts^2
+
+    size_t bins;                   // Usable bins at this ODR and window
+    uint8_t bin_hz[FEATURE_BINS];
+    float coeff[FEATURE_BINS];     // 2 cos(2 pi f / odr)
+    float s1[3][FEATURE_BINS];
+    float s2[3][FEATURE_BINS];
+};
+
+/**
+ * @brief Sets up the extractor for a sample rate and window length.
+ * Bins at or above Nyquist, or with less than one cycle in the window, are left out.
+ * @return false if window_ms is 0 or above FEATURE_MAX_WINDOW_MS, or no bin is usable.
+ */
+bool featureInit(FeatureExtractor &fx, uint32_t odr_hz, uint32_t window_ms);
+
+/**
+ * @brief Starts a window at a trigger sample not fed yet (or fed in the
+ * current block: actual accumulation starts with that index).
+ * @param level_ms2 Trigger level in m/s^2 (LTA x trigger ratio) for duration_ms.
+ * @return false if a window is already in progress.
+ */
+bool featureBegin(FeatureExtractor &fx, uint32_t trigger_index, float level_ms2);
+
+/** true while a window is in progress. */
+inline bool featureActive(const FeatureExtractor &fx) { return fx.active; }
+
+/**
+ * @brief Feeds consecutive samples; call for every sample, with or without a window.
+ * @param first_index Sample index of block[0].
+ * @return true if the window completed inside this block (read it with featureResult()).
+ */
+bool featureFeed(FeatureExtractor &fx, const RawSample *block, size_t count, uint32_t first_index);
+
+/**
+ * @brief Converts the completed window to wire units and classifies it.
+ */
+void featureResult(const FeatureExtractor &fx, EventFeatures &out);
+
+/**
+ * @brief Runs the threshold tree on the features (event_class is ignored).
+ * @return EVENT_CLASS_SEISMIC, _IMPULSIVE or _MACHINERY.
+ */
+uint8_t eventClassify(const EventFeatures &f);
+
+/** Name of an event class for logs ("none" for 0). */
+const char *eventClassName(uint8_t event_class);
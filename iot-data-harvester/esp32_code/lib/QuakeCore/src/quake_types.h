@@ -0,0 +1,26 @@
+/**
+ * Module: QuakeCore Shared Types
+ *
+ * Description:
+ * Plain data types shared between the hardware drivers (src/) and the
+ * hardware-independent processing code in this library. Nothing in here may
+ * depend on Arduino or FreeRTOS headers.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief One raw 3-axis accelerometer sample in sensor counts.
+ * In FULL_RES mode one count is 4 mg regardless of the selected range.
+ */
+struct RawSample {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+// Scale factor of the FULL_RES format (4 mg/LSB at every range) in m/s^2.
+#define ADXL345_LSB_TO_MS2        (0.004f * 9.80665f)
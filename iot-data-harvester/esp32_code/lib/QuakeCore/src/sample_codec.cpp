@@ -0,0 +1,94 @@
+/**
+ * Module: Delta + ZigZag + Varint Sample Codec
+ * See sample_codec.h for the format.
+ */
+
+#include "sample_codec.h"
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static inline size_t varintSize(uint32_t v) {
+    return v < (1u << 7) ? 1 : v < (1u << 14) ? 2 : 3; // 17-bit max for int16 deltas
+}
+
+static inline uint8_t *putVarint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+size_t deltaSampleSize(const RawSample &s, const RawSample &prev) {
+    return varintSize(zigzag((int32_t)s.x - prev.x)) +
+           varintSize(zigzag((int32_t)s.y - prev.y)) +
+           varintSize(zigzag((int32_t)s.z - prev.z));
+}
+
+size_t deltaEncode(const RawSample *in, size_t n, RawSample &prev,
+                   uint8_t *out, size_t outSize, size_t *consumed) {
+    uint8_t *p = out;
+    uint8_t *const end = out + outSize;
+    size_t i = 0;
+
+    for (; i < n; i++) {
+        const RawSample &s = in[i];
+        uint32_t dx = zigzag((int32_t)s.x - prev.x);
+        uint32_t dy = zigzag((int32_t)s.y - prev.y);
+        uint32_t dz = zigzag((int32_t)s.z - prev.z);
+
+        // Fast path: room for the worst case, no per-sample size computation
+        if ((size_t)(end - p) < DELTA_MAX_SAMPLE_BYTES &&
+            (size_t)(end - p) < varintSize(dx) + varintSize(dy) + varintSize(dz)) {
+            break;
+        }
+        p = putVarint(p, dx);
+        p = putVarint(p, dy);
+        p = putVarint(p, dz);
+        prev = s;
+    }
+
+    if (consumed) *consumed = i;
+    return (size_t)(p - out);
+}
+
+// Reads one varint; returns false if the input ends mid-value.
+static bool getVarint(const uint8_t *&p, const uint8_t *end, uint32_t &v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 32; shift += 7) {
+        uint8_t b = *p++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+size_t deltaDecode(const uint8_t *in, size_t len, RawSample &prev,
+                   RawSample *out, size_t maxOut, size_t *used) {
+    const uint8_t *p = in;
+    const uint8_t *const end = in + len;
+    size_t n = 0;
+
+    while (n < maxOut && p < end) {
+        const uint8_t *start = p;
+        uint32_t dx, dy, dz;
+        if (!getVarint(p, end, dx) || !getVarint(p, end, dy) || !getVarint(p, end, dz)) {
+            p = start;
+            break;
+        }
+        prev.x = (int16_t)(prev.x + unzigzag(dx));
+        prev.y = (int16_t)(prev.y + unzigzag(dy));
+        prev.z = (int16_t)(prev.z + unzigzag(dz));
+        out[n++] = prev;
+    }
+
+    if (used) *used = (size_t)(p - in);
+    return n;
+}
@@ -0,0 +1,52 @@
+/**
+ * Module: Delta + ZigZag + Varint Sample Codec
+ *
+ * Description:
+ * Lossless integer encoding for raw 3-axis ADXL345 samples
+ * (WAVEFORM_ENC_DELTA_VARINT). Each axis is coded as the difference to the
+ * previous sample, mapped to unsigned with ZigZag (0,-1,1,-2... -> 0,1,2,3...)
+ * and written as a little-endian base-128 varint (7 bits per byte, MSB set
+ * on all but the last byte).
+ *
+ * Sizes per sample:
+ * - Quiet sensor (|delta| < 64 counts on every axis): 3 bytes
+ * - Strong shaking (|delta| < 8192):                  up to 6 bytes
+ * - Worst case (full-scale step):                     9 bytes
+ * against 6 bytes for raw int16 x, y, z.
+ *
+ * The predictor state (previous sample) is carried across calls, so a
+ * capture split over several chunks decodes as one continuous stream.
+ * A fresh stream starts from prev = {0, 0, 0}.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "quake_types.h"
+
+#define DELTA_MAX_SAMPLE_BYTES 9
+
+/**
+ * @brief Exact encoded size of one sample given the previous one.
+ */
+size_t deltaSampleSize(const RawSample &s, const RawSample &prev);
+
+/**
+ * @brief Encodes samples until the input ends or the next one does not fit.
+ * @param prev Predictor state, updated to the last encoded sample.
+ * @param consumed Receives the number of samples encoded.
+ * @return Bytes written to out.
+ */
+size_t deltaEncode(const RawSample *in, size_t n, RawSample &prev,
+                   uint8_t *out, size_t outSize, size_t *consumed);
+
+/**
+ * @brief Decodes up to maxOut samples.
+ * @param prev Predictor state, updated to the last decoded sample.
+ * @param used Receives the number of input bytes consumed.
+ * @return Samples decoded (stops early on a truncated varint).
+ */
+size_t deltaDecode(const uint8_t *in, size_t len, RawSample &prev,
+                   RawSample *out, size_t maxOut, size_t *used);
@@ -0,0 +1,120 @@
+/**
+ * Module: Single-Producer / Single-Consumer Ring Buffer
+ *
+ * Description:
+ * Lock-free ring for the high-volume sample path between the acquisition
+ * task (producer) and the network task (consumer). Storage is a fixed array
+ * inside the object, so a global instance lives in static RAM.
+ *
+ * Zero-copy consumption: peek() returns a pointer into the ring and the
+ * length of the contiguous readable span (up to the wrap point); the
+ * consumer transmits straight from that memory and then calls release().
+ *
+ * Concurrency model:
+ * - head is written only by the producer, tail only by the consumer.
+ * - Only atomic loads and stores are used (acquire/release), no
+ *   read-modify-write, so the ring works on cores without the RISC-V 'A'
+ *   extension such as the ESP32-C3.
+ * - When the ring is full the producer drops the NEW samples and counts
+ *   them in overruns(); it never blocks and never touches tail.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0), peak(0) {}
+
+    static constexpr size_t capacity() { return N; }
+
+    // ----------------------------------------------------------------------
+    // PRODUCER SIDE
+    // ----------------------------------------------------------------------
+
+    /**
+     * @brief Copies up to n items into the ring.
+     * @return Number of items accepted; the rest is counted as overrun.
+     */
+    size_t write(const T *src, size_t n) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        const uint32_t t = tail.load(std::memory_order_acquire);
+        const size_t space = N - (size_t)(h - t);
+
+        size_t accepted = n < space ? n : space;
+        size_t first = N - (h & (N - 1));
+        if (first > accepted) first = accepted;
+
+        memcpy(&storage[h & (N - 1)], src, first * sizeof(T));
+        memcpy(&storage[0], src + first, (accepted - first) * sizeof(T));
+
+        publish(h, accepted, t);
+        if (accepted < n) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + (uint32_t)(n - accepted),
+                          std::memory_order_relaxed);
+        }
+        return accepted;
+    }
+
+    // ----------------------------------------------------------------------
+    // CONSUMER SIDE
+    // ----------------------------------------------------------------------
+
+    /**
+     * @brief Borrows the oldest contiguous readable span without copying.
+     * @param n Receives the number of items in the span (0 if empty).
+     * @return Pointer into the ring, valid until release() is called.
+     */
+    const T *peek(size_t &n) const {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        const uint32_t h = head.load(std::memory_order_acquire);
+        const size_t used = (size_t)(h - t);
+        const size_t toWrap = N - (t & (N - 1));
+        n = used < toWrap ? used : toWrap;
+        return &storage[t & (N - 1)];
+    }
+
+    /**
+     * @brief Returns n items obtained through peek() to the producer.
+     */
+    void release(size_t n) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        tail.store(t + (uint32_t)n, std::memory_order_release);
+    }
+
+    // ----------------------------------------------------------------------
+    // STATISTICS (safe to read from any task)
+    // ----------------------------------------------------------------------
+
+    size_t size() const {
+        return (size_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+
+    /** Items dropped because the consumer fell behind. */
+    uint32_t overruns() const { return dropped.load(std::memory_order_relaxed); }
+
+    /** Highest fill level observed by the producer. */
+    uint32_t highWater() const { return peak.load(std::memory_order_relaxed); }
+
+private:
+    void publish(uint32_t h, size_t n, uint32_t t) {
+        head.store(h + (uint32_t)n, std::memory_order_release);
+        const uint32_t level = (h + (uint32_t)n) - t;
+        if (level > peak.load(std::memory_order_relaxed)) {
+            peak.store(level, std::memory_order_relaxed);
+        }
+    }
+
+    T storage[N];
+    std::atomic<uint32_t> head;    // Next slot to write (producer-owned)
+    std::atomic<uint32_t> tail;    // Next slot to read (consumer-owned)
+    std::atomic<uint32_t> dropped; // Producer-owned overrun counter
+    std::atomic<uint32_t> peak;    // Producer-owned high-water mark
+};
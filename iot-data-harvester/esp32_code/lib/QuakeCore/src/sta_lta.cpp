@@ -0,0 +1,19 @@
+/**
+ * Module: Float STA/LTA Detector
+ * See sta_lta.h for the interface description.
+ */
+
+#include "sta_lta.h"
+
+void detectorInit(DetectorState &st, float seed_mag) {
+    st.lta = seed_mag;
+    st.sta = seed_mag;
+    st.prev_raw_mag = seed_mag;
+    st.filtered_mag = 0.0f;
+    st.inAlarm = false;
+    st.alarmSamples = 0;
+}
+
+bool detectorStep(const DetectorParams &p, DetectorState &st, float raw_mag, float *ratio) {
+    return detectorStepT(p, st, raw_mag, ratio);
+}
@@ -0,0 +1,111 @@
+/**
+ * Module: Float STA/LTA Detector
+ *
+ * Description:
+ * Reference implementation of the sensorTask pipeline, one magnitude sample
+ * at a time: Dropout Protection, High-Pass Filter, Noise Gate, STA/LTA and
+ * the post-trigger cooldown. It has no hardware or RTOS dependencies, so the
+ * firmware and the host replay harness (tools/replay) run the same code.
+ *
+ * The fixed-point block pipeline (dsp_fixed.h) is derived from these
+ * parameters and must stay equivalent to this path. The detector is written
+ * once as a template over the parameter type (detectorStepT) so the same
+ * code runs with runtime parameters or with a compile-time profile.
+ */
+
+#pragma once
+
+#include "quake_types.h"
+
+/**
+ * @brief Tuning constants of the detector, expressed at the sample rate the
+ * detector runs at (alphas and HPF pole are per-sample factors).
+ */
+struct DetectorParams {
+    float alpha_lta;           // Long Term Average smoothing factor
+    float alpha_sta;           // Short Term Average smoothing factor
+    float trigger_ratio;       // Threshold ratio for alarm triggering
+    float noise_floor;         // Noise Gate threshold (m/s^2)
+    float hpf_coeff;           // HPF pole (removes the gravity component)
+    float dropout_ms2;         // Samples below this magnitude are discarded
+    float lta_floor;           // Safety floor for the LTA
+    uint32_t cooldown_samples; // Samples to ignore after a trigger
+};
+
+/**
+ * @brief Running state of the STA/LTA detector.
+ */
+struct DetectorState {
+    float lta;
+    float sta;
+    float prev_raw_mag;
+    float filtered_mag;
+    bool inAlarm;
+    uint32_t alarmSamples; // Samples elapsed since the last trigger
+};
+
+/**
+ * @brief Resets the detector, seeding the filters with a resting magnitude
+ * (m/s^2) measured during the stabilization phase.
+ */
+void detectorInit(DetectorState &st, float seed_mag);
+
+/**
+ * @brief Runs one magnitude sample through HPF, Noise Gate and STA/LTA.
+ * @param raw_mag Vector magnitude of the sample in m/s^2.
+ * @param ratio Receives the STA/LTA ratio of the sample (untouched when the
+ *              sample is discarded by the dropout check).
+ * @return true on a new trigger.
+ */
+bool detectorStep(const DetectorParams &p, DetectorState &st, float raw_mag, float *ratio);
+
+/**
+ * @brief detectorStep() for any parameter type with the DetectorParams field
+ * names: the runtime struct, or a compile-time profile
+ * (StaticDetectorParams in detector_profile.h) whose members are
+ * static constexpr, so terms like (1 - alpha) fold into constants.
+ */
+template <class Params>
+inline bool detectorStepT(const Params &p, DetectorState &st, float raw_mag, float *ratio) {
+    // Alarm Cooldown, counted in samples so it follows the sensor clock
+    if (st.inAlarm && ++st.alarmSamples > p.cooldown_samples) {
+        st.inAlarm = false;
+    }
+
+    // --- SIGNAL DROPOUT PROTECTION ---
+    // If magnitude drops below 2.0 m/s^2 (~0.2G), it indicates a wiring failure or I2C bus error.
+    // We discard this frame to prevent the High Pass Filter from creating a false spike.
+    if (raw_mag < p.dropout_ms2) {
+        return false;
+    }
+
+    // Digital High Pass Filter (Removes Gravity component)
+    st.filtered_mag = p.hpf_coeff * (st.filtered_mag + raw_mag - st.prev_raw_mag);
+    st.prev_raw_mag = raw_mag;
+    float abs_signal = st.filtered_mag < 0.0f ? -st.filtered_mag : st.filtered_mag;
+
+    // --- NOISE GATE ---
+    // Zero out signals below the hardware noise floor to prevent STA/LTA drift.
+    if (abs_signal < p.noise_floor) {
+        abs_signal = 0.0f;
+    }
+
+    // STA/LTA Algorithm Update
+    st.lta = (p.alpha_lta * abs_signal) + ((1.0f - p.alpha_lta) * st.lta);
+    st.sta = (p.alpha_sta * abs_signal) + ((1.0f - p.alpha_sta) * st.sta);
+
+    // Safety floor for LTA to avoid division by zero or extreme ratios
+    if (st.lta < p.lta_floor) st.lta = p.lta_floor;
+
+    *ratio = st.sta / st.lta;
+
+    // TRIGGER LOGIC
+    // Condition 1: Ratio exceeds threshold.
+    // Condition 2: Actual signal intensity exceeds noise floor (Real event verification).
+    if (*ratio >= p.trigger_ratio && st.sta > p.noise_floor && !st.inAlarm) {
+        st.inAlarm = true;
+        st.alarmSamples = 0;
+        return true;
+    }
+    return false;
+}
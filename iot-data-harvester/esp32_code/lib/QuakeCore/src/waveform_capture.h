@@ -0,0 +1,155 @@
+/**
+ * Module: Pre/Post-Trigger Waveform Capture
+ *
+ * Description:
+ * Keeps the most recent raw samples in a fixed circular buffer so that a
+ * trigger can be reported together with the waveform around it: up to PRE
+ * samples before the trigger and POST samples from the trigger on.
+ *
+ * Life cycle:
+ *   RECORDING    -> push() overwrites the oldest samples
+ *   POST_TRIGGER -> trigger() armed; recording continues for the post window
+ *   READY        -> window frozen; the uploader reads it, then release()
+ *
+ * While a window is READY new samples are not recorded and further
+ * triggers are counted in skipped(): the footprint stays fixed at
+ * (PRE + POST) * sizeof(RawSample) with no second buffer.
+ *
+ * Concurrency model (same rules as SpscRing):
+ * - push()/trigger() run only in the acquisition task, the READY-side
+ *   accessors and release() only in the uploader.
+ * - Ownership of the buffer is handed over through one atomic state byte
+ *   (acquire/release loads and stores only, no read-modify-write).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "quake_types.h"
+
+template <size_t PRE, size_t POST>
+class WaveformCapture {
+    static_assert(POST >= 1, "Post-trigger window must hold the trigger sample");
+
+public:
+    static constexpr size_t N = PRE + POST;
+
+    WaveformCapture() : state(RECORDING), skips(0) {}
+
+    static constexpr size_t capacity() { return N; }
+
+    // ----------------------------------------------------------------------
+    // PRODUCER SIDE (acquisition task)
+    // ----------------------------------------------------------------------
+
+    /**
+     * @brief Records n consecutive samples. Ignored while a window is READY.
+     */
+    void push(const RawSample *src, size_t n) {
+        uint8_t s = state.load(std::memory_order_acquire);
+        if (s == READY) return;
+
+        for (size_t i = 0; i < n; i++) {
+            storage[head % N] = src[i];
+            head++;
+            if (s == POST_TRIGGER && --postRemaining == 0) {
+                freeze(head);
+                return; // Rest of the block falls outside the window
+            }
+        }
+    }
+
+    /**
+     * @brief Arms the post-trigger window.
+     * @param age Samples pushed after the trigger sample (0 = newest sample).
+     * @param meta Caller data stored with the window (e.g. trigger millis).
+     * @return false if the trigger was not captured (window busy uploading).
+     */
+    bool trigger(size_t age, uint32_t meta) {
+        uint8_t s = state.load(std::memory_order_acquire);
+        if (s == POST_TRIGGER) return true; // Already inside a captured window
+        if (s == READY) {
+            skips.store(skips.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t triggerPos = age < head ? head - 1 - (uint32_t)age : 0;
+        size_t pre = triggerPos < PRE ? triggerPos : PRE;
+
+        winStart = triggerPos - (uint32_t)pre;
+        winPre = pre;
+        winMeta = meta;
+
+        size_t seen = head - triggerPos; // Post samples already recorded
+        if (seen >= POST) {
+            freeze(triggerPos + POST);
+        } else {
+            postRemaining = POST - seen;
+            state.store(POST_TRIGGER, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // ----------------------------------------------------------------------
+    // CONSUMER SIDE (uploader)
+    // ----------------------------------------------------------------------
+
+    /** true once a complete window is frozen and owned by the uploader. */
+    bool ready() const { return state.load(std::memory_order_acquire) == READY; }
+
+    /** Samples in the frozen window. */
+    size_t length() const { return winLength; }
+
+    /** Samples before the trigger (index of the trigger sample in the window). */
+    size_t preSamples() const { return winPre; }
+
+    /** Value passed to trigger() for this window. */
+    uint32_t meta() const { return winMeta; }
+
+    /**
+     * @brief Copies n window samples starting at offset into dst.
+     * @return Number of samples copied (clipped at the window end).
+     */
+    size_t read(size_t offset, RawSample *dst, size_t n) const {
+        if (offset >= winLength) return 0;
+        if (n > winLength - offset) n = winLength - offset;
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = storage[(winStart + offset + i) % N];
+        }
+        return n;
+    }
+
+    /**
+     * @brief Hands the buffer back to the acquisition task.
+     * History restarts empty, so a new window never mixes in stale samples.
+     */
+    void release() {
+        head = 0;
+        state.store(RECORDING, std::memory_order_release);
+    }
+
+    /** Triggers that arrived while a window was still being uploaded. */
+    uint32_t skipped() const { return skips.load(std::memory_order_relaxed); }
+
+private:
+    enum : uint8_t { RECORDING, POST_TRIGGER, READY };
+
+    void freeze(uint32_t end) {
+        winLength = end - winStart;
+        state.store(READY, std::memory_order_release);
+    }
+
+    RawSample storage[N];
+    std::atomic<uint8_t> state;
+    std::atomic<uint32_t> skips;
+
+    // Producer-owned until READY is published, then read-only for the consumer
+    uint32_t head = 0;   // Samples recorded since the last release()
+    size_t postRemaining = 0;
+    uint32_t winStart = 0;
+    size_t winLength = 0;
+    size_t winPre = 0;
+    uint32_t winMeta = 0;
+};
@@ -0,0 +1,73 @@
+/**
+ * Module: Binary Event Wire Format (v1)
+ * See wire_format.h for the frame layout.
+ */
+
+#include "wire_format.h"
+
+// Explicit byte stores: independent of host endianness and struct packing.
+static inline void putLe16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void putLe32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+size_t wireEncodeFrame(uint32_t misurator_id, const WireEntry *entries, size_t count,
+                       uint8_t *out, size_t outSize, uint16_t flags) {
+    if (count == 0 || count > WIRE_MAX_ENTRIES || outSize < WIRE_FRAME_SIZE_FLAGS(count, flags)) return 0;
+
+    out[0] = WIRE_VERSION;
+    out[1] = (uint8_t)count;
+    putLe16(out + 2, flags);
+    putLe32(out + 4, misurator_id);
+
+    uint8_t *p = out + WIRE_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        putLe32(p, (uint32_t)entries[i].value);
+        putLe32(p + 4, entries[i].device_timestamp);
+        p += WIRE_ENTRY_SIZE;
+        if (flags & WIRE_FLAG_SEQUENCE) {
+            putLe32(p, entries[i].seq);
+            p += WIRE_SEQ_SIZE;
+        }
+        if (flags & WIRE_FLAG_TIME_US) {
+            putLe32(p, entries[i].usec);
+            p += WIRE_USEC_SIZE;
+        }
+        if (flags & WIRE_FLAG_FEATURES) {
+            const EventFeatures &f = entries[i].features;
+            p[0] = f.event_class;
+            p[1] = f.dominant_hz;
+            putLe16(p + 2, f.duration_ms);
+            putLe32(p + 4, f.pga_mms2);
+            for (int a = 0; a < 3; a++) putLe32(p + 8 + 4 * a, f.energy[a]);
+            p += WIRE_FEATURES_SIZE;
+        }
+    }
+    return (size_t)(p - out);
+}
+
+size_t wireEncodeWaveformHeader(const WaveformDescriptor &desc, uint16_t chunk_index,
+                                uint16_t payload_len, uint8_t *out, size_t outSize) {
+    if (outSize < WAVEFORM_HEADER_SIZE) return 0;
+
+    putLe32(out, WAVEFORM_MAGIC);
+    out[4] = WIRE_VERSION;
+    out[5] = desc.encoding;
+    putLe16(out + 6, desc.odr_hz);
+    putLe32(out + 8, desc.misurator_id);
+    putLe32(out + 12, desc.capture_id);
+    putLe32(out + 16, desc.trigger_timestamp);
+    putLe32(out + 20, desc.total_samples);
+    putLe16(out + 24, desc.pre_samples);
+    putLe16(out + 26, desc.chunk_count);
+    putLe16(out + 28, chunk_index);
+    putLe16(out + 30, payload_len);
+    return WAVEFORM_HEADER_SIZE;
+}
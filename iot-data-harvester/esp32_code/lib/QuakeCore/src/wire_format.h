@@ -0,0 +1,123 @@
+/**
+ * Module: Binary Event Wire Format (v1)
+ *
+ * Description:
+ * Compact alternative to the JSON + signature_hex body. One frame carries
+ * one or more trigger entries and a single raw ECDSA signature:
+ *
+ *   offset  size  field
+ *   0       1     version (WIRE_VERSION)
+ *   1       1     entry count (1..WIRE_MAX_ENTRIES)
+ *   2       2     flags (WIRE_FLAG_*, 0 = none)
+ *   4       4     misurator_id
+ *   8       8*n   entries: int32 value, uint32 device_timestamp (Unix s)
+ *   8+8n    64    signature r||s (SECP256R1, SHA-256 over bytes [0, 8+8n))
+ *
+ * With WIRE_FLAG_SEQUENCE a uint32 journal sequence number follows
+ * device_timestamp (0 = not journaled). The backend uses it to drop entries
+ * replayed after a lost acknowledgement. With WIRE_FLAG_TIME_US a uint32
+ * microsecond fraction (0..999999) of device_timestamp follows next. Each
+ * of these flags adds 4 bytes per entry. With WIRE_FLAG_FEATURES the event
+ * features (event_features.h) come last, 20 bytes:
+ *
+ *   u8 event_class (0 = unclassified) | u8 dominant_hz | u16 duration_ms |
+ *   u32 pga_mms2 | u32 energy_x | u32 energy_y | u32 energy_z
+ *
+ * All integers are little-endian. A single event is 80 bytes, against
+ * ~230 bytes of JSON with a hex DER signature. The frame is sent with
+ * Content-Type WIRE_CONTENT_TYPE to the regular ingestion routes.
+ *
+ * Waveform chunks (WAVEFORM_CONTENT_TYPE, POST /waveforms/) carry the raw
+ * samples captured around a trigger, split to fit one request each:
+ *
+ *   offset  size  field
+ *   0       4     magic "QGWF"
+ *   4       1     version (WIRE_VERSION)
+ *   5       1     sample encoding (WAVEFORM_ENC_*)
+ *   6       2     odr_hz
+ *   8       4     misurator_id
+ *   12      4     capture_id
+ *   16      4     trigger_timestamp (Unix s)
+ *   20      4     total_samples
+ *   24      2     pre_samples (index of the trigger sample)
+ *   26      2     chunk_count
+ *   28      2     chunk_index
+ *   30      2     payload_len (bytes)
+ *   32      ...   payload (samples in the capture's encoding)
+ *   (last chunk only) 64-byte signature r||s
+ *
+ * Bytes [0, 28) describe the whole capture and are identical in every chunk.
+ * The signature covers SHA-256(descriptor || payload_0 || ... || payload_n-1).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "event_features.h"
+
+#define WIRE_VERSION        1
+#define WIRE_CONTENT_TYPE   "application/x-quakeguard-event"
+#define WIRE_HEADER_SIZE    8
+#define WIRE_ENTRY_SIZE     8
+#define WIRE_FLAG_SEQUENCE  0x0001 // Entries carry a uint32 sequence number
+#define WIRE_FLAG_TIME_US   0x0002 // Entries carry a uint32 µs fraction of device_timestamp
+#define WIRE_FLAG_FEATURES  0x0004 // Entries carry the event features
+#define WIRE_SEQ_SIZE       4
+#define WIRE_USEC_SIZE      4
+#define WIRE_FEATURES_SIZE  20
+#define WIRE_SIG_SIZE       64
+#define WIRE_MAX_ENTRIES    100 // Matches the backend batch limit
+
+// Total frame size for n entries, signature included.
+#define WIRE_FRAME_SIZE(n)  (WIRE_HEADER_SIZE + (n) * WIRE_ENTRY_SIZE + WIRE_SIG_SIZE)
+#define WIRE_ENTRY_SIZE_FLAGS(flags) \
+    (WIRE_ENTRY_SIZE + (((flags) & WIRE_FLAG_SEQUENCE) ? WIRE_SEQ_SIZE : 0) + \
+     (((flags) & WIRE_FLAG_TIME_US) ? WIRE_USEC_SIZE : 0) + \
+     (((flags) & WIRE_FLAG_FEATURES) ? WIRE_FEATURES_SIZE : 0))
+#define WIRE_FRAME_SIZE_FLAGS(n, flags) \
+    (WIRE_HEADER_SIZE + (n) * WIRE_ENTRY_SIZE_FLAGS(flags) + WIRE_SIG_SIZE)
+
+#define WAVEFORM_CONTENT_TYPE   "application/x-quakeguard-waveform"
+#define WAVEFORM_MAGIC          0x46574751UL // "QGWF" little-endian
+#define WAVEFORM_HEADER_SIZE    32
+#define WAVEFORM_DESCRIPTOR_SIZE 28
+#define WAVEFORM_ENC_RAW16        0 // int16 x, y, z per sample
+#define WAVEFORM_ENC_DELTA_VARINT 1 // sample_codec.h, one stream across all chunks
+
+struct WireEntry {
+    int32_t value;             // STA/LTA ratio * 100
+    uint32_t device_timestamp; // Unix time, seconds
+    uint32_t seq;              // Sent only with WIRE_FLAG_SEQUENCE
+    uint32_t usec;             // Sent only with WIRE_FLAG_TIME_US
+    EventFeatures features;    // Sent only with WIRE_FLAG_FEATURES
+};
+
+/**
+ * @brief Writes header and entries (the signed part of a frame).
+ * The caller signs out[0, return) and appends the 64-byte r||s at out + return.
+ * @param flags WIRE_FLAG_* set in the header; selects the entry layout.
+ * @return Length of the signed part, or 0 if count is out of range or
+ *         outSize cannot hold the complete frame.
+ */
+size_t wireEncodeFrame(uint32_t misurator_id, const WireEntry *entries, size_t count,
+                       uint8_t *out, size_t outSize, uint16_t flags = 0);
+
+struct WaveformDescriptor {
+    uint8_t encoding;
+    uint16_t odr_hz;
+    uint32_t misurator_id;
+    uint32_t capture_id;
+    uint32_t trigger_timestamp;
+    uint32_t total_samples;
+    uint16_t pre_samples;
+    uint16_t chunk_count;
+};
+
+/**
+ * @brief Writes the 32-byte header of one waveform chunk.
+ * @return WAVEFORM_HEADER_SIZE, or 0 if outSize is too small.
+ */
+size_t wireEncodeWaveformHeader(const WaveformDescriptor &desc, uint16_t chunk_index,
+                                uint16_t payload_len, uint8_t *out, size_t outSize);
@@ -0,0 +1,221 @@
+/**
+ * Module: ADXL345 FIFO Acquisition Driver
+ * See include/adxl345_fifo.h for the interface description.
+ */
+
+#include "adxl345_fifo.h"
+
+#include "driver/gpio.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+
+TaskHandle_t Adxl345Fifo::notifyTask = NULL;
+int Adxl345Fifo::levelPin = -1;
+volatile int64_t Adxl345Fifo::lastWatermarkUs = 0;
+
+/**
+ * @brief INT1 watermark ISR. Only wakes the acquisition task; all bus
+ * traffic happens in task context.
+ */
+void IRAM_ATTR Adxl345Fifo::onWatermark() {
+    lastWatermarkUs = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+    if (notifyTask != NULL) {
+        vTaskNotifyGiveFromISR(notifyTask, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Level-triggered variant: INT1 stays high until the FIFO is drained,
+ * so the pin is masked here and unmasked by drain().
+ */
+void IRAM_ATTR Adxl345Fifo::onWatermarkLevel() {
+    gpio_intr_disable((gpio_num_t)levelPin);
+    onWatermark();
+}
+
+void Adxl345Fifo::attach(TwoWire &wire, uint8_t addr, I2cBus *health) {
+    bus = &wire;
+    busHealth = health;
+    address = addr;
+    spiBus = NULL;
+}
+
+void Adxl345Fifo::attach(SPIClass &spi, int csPin, uint32_t clockHz) {
+    spiBus = &spi;
+    chipSelect = csPin;
+    spiHz = clockHz < ADXL345_SPI_MAX_HZ ? clockHz : ADXL345_SPI_MAX_HZ;
+    bus = NULL;
+    busHealth = NULL;
+    pinMode(chipSelect, OUTPUT);
+    digitalWrite(chipSelect, HIGH);
+}
+
+bool Adxl345Fifo::begin(uint8_t rateCode, uint8_t watermark, int intPin, TaskHandle_t task) {
+    interruptPin = intPin;
+    notifyTask = task;
+
+    if (watermark < 1) watermark = 1;
+    if (watermark > ADXL345_FIFO_DEPTH - 1) watermark = ADXL345_FIFO_DEPTH - 1;
+
+    // SPI writes are not acknowledged: check that a sensor answers at all
+    if (spiBus != NULL && !identify()) return false;
+
+    // Reset the FIFO by cycling through BYPASS before selecting STREAM mode.
+    bool ok = writeRegister(ADXL345_REG_INT_ENABLE, 0x00);
+    ok &= writeRegister(ADXL345_REG_FIFO_CTL, ADXL345_FIFO_MODE_BYPASS);
+    ok &= writeRegister(ADXL345_REG_BW_RATE, rateCode & 0x0F);
+
+    // Route every interrupt source to INT1 (active high, default polarity).
+    ok &= writeRegister(ADXL345_REG_INT_MAP, 0x00);
+    ok &= writeRegister(ADXL345_REG_FIFO_CTL, ADXL345_FIFO_MODE_STREAM | watermark);
+    ok &= writeRegister(ADXL345_REG_INT_ENABLE, ADXL345_INT_WATERMARK | ADXL345_INT_OVERRUN);
+    ok &= writeRegister(ADXL345_REG_POWER_CTL, 0x08); // Measurement mode
+
+    // Clear any latched source so the first edge is not missed.
+    readRegister(ADXL345_REG_INT_SOURCE);
+
+    if (interruptPin >= 0) {
+        pinMode(interruptPin, INPUT);
+        attachInterrupt(digitalPinToInterrupt(interruptPin), onWatermark, RISING);
+    }
+    return ok;
+}
+
+bool Adxl345Fifo::enableWakeup() {
+    if (interruptPin < 0) return false;
+
+    // Wakeup and interrupt share the pin's trigger type, so both use the level.
+    detachInterrupt(digitalPinToInterrupt(interruptPin));
+    levelPin = interruptPin;
+    levelWake = true;
+    attachInterrupt(digitalPinToInterrupt(interruptPin), onWatermarkLevel, ONHIGH);
+    if (gpio_wakeup_enable((gpio_num_t)interruptPin, GPIO_INTR_HIGH_LEVEL) != ESP_OK) return false;
+    return esp_sleep_enable_gpio_wakeup() == ESP_OK;
+}
+
+void Adxl345Fifo::end() {
+    if (interruptPin >= 0) {
+        if (levelWake) gpio_wakeup_disable((gpio_num_t)interruptPin);
+        detachInterrupt(digitalPinToInterrupt(interruptPin));
+    }
+    levelWake = false;
+    writeRegister(ADXL345_REG_INT_ENABLE, 0x00);
+    writeRegister(ADXL345_REG_FIFO_CTL, ADXL345_FIFO_MODE_BYPASS);
+    notifyTask = NULL;
+}
+
+bool Adxl345Fifo::identify() {
+    return readRegister(ADXL345_REG_DEVID) == ADXL345_DEVICE_ID;
+}
+
+uint8_t Adxl345Fifo::entries() {
+    int status = readRegister(ADXL345_REG_FIFO_STATUS);
+    if (status < 0) return 0;
+    return (uint8_t)(status & 0x3F);
+}
+
+size_t Adxl345Fifo::drain(RawSample *out, size_t maxSamples) {
+    // INT_SOURCE is read first: it reports whether samples were lost since the
+    // previous drain. The watermark bit itself clears once the FIFO is emptied.
+    int source = readRegister(ADXL345_REG_INT_SOURCE);
+    if (source >= 0 && (source & ADXL345_INT_OVERRUN)) {
+        overrunCount++;
+    }
+
+    size_t pending = entries();
+    if (pending > maxSamples) pending = maxSamples;
+
+    size_t count = 0;
+    while (count < pending) {
+        if (!readEntry(out[count])) {
+            busErrorCount++;
+            break;
+        }
+        count++;
+    }
+    if (levelWake) {
+        // Re-arm: if INT1 is still high (FIFO refilled past the watermark) the ISR fires again
+        gpio_intr_enable((gpio_num_t)interruptPin);
+    }
+    return count;
+}
+
+/**
+ * @brief Hands the result of one transfer to the bus monitor.
+ */
+uint8_t Adxl345Fifo::finish(uint8_t status) {
+    if (busHealth != NULL) busHealth->noteTransfer(status);
+    return status;
+}
+
+/**
+ * @brief One CS-framed SPI transaction: command byte, then len bytes
+ * exchanged in place (written for a write, read back for a read).
+ */
+void Adxl345Fifo::spiTransfer(uint8_t command, uint8_t *data, size_t len) {
+    spiBus->beginTransaction(SPISettings(spiHz, MSBFIRST, SPI_MODE3));
+    digitalWrite(chipSelect, LOW);
+    spiBus->transfer(command);
+    spiBus->transfer(data, len);
+    digitalWrite(chipSelect, HIGH);
+    spiBus->endTransaction();
+}
+
+bool Adxl345Fifo::writeRegister(uint8_t reg, uint8_t value) {
+    if (spiBus != NULL) {
+        spiTransfer(reg & 0x3F, &value, 1);
+        return true; // SPI has no acknowledge; begin() checks DEVID instead
+    }
+    bus->beginTransmission(address);
+    bus->write(reg);
+    bus->write(value);
+    return finish(bus->endTransmission()) == I2C_STATUS_OK;
+}
+
+int Adxl345Fifo::readRegister(uint8_t reg) {
+    if (spiBus != NULL) {
+        uint8_t value = 0;
+        spiTransfer(ADXL345_SPI_READ | (reg & 0x3F), &value, 1);
+        return value;
+    }
+    bus->beginTransmission(address);
+    bus->write(reg);
+    uint8_t status = bus->endTransmission(false);
+    if (status == I2C_STATUS_OK && bus->requestFrom(address, (uint8_t)1) != 1) status = I2C_STATUS_SHORT_READ;
+    if (finish(status) != I2C_STATUS_OK) return -1;
+    return bus->read();
+}
+
+/**
+ * @brief Pops one FIFO entry with a single multi-byte read of DATAX0..DATAZ1.
+ * The sensor only advances the FIFO when the data registers are read as one
+ * transaction, so the six bytes must never be split.
+ */
+bool Adxl345Fifo::readEntry(RawSample &out) {
+    uint8_t raw[6];
+
+    if (spiBus != NULL) {
+        spiTransfer(ADXL345_SPI_READ | ADXL345_SPI_MULTI | ADXL345_REG_DATAX0, raw, sizeof(raw));
+        // Above 1.6 MHz the burst is shorter than the FIFO needs to move the next
+        // entry into the data registers
+        if (spiHz > 1600000) delayMicroseconds(ADXL345_FIFO_POP_US);
+    } else {
+        bus->beginTransmission(address);
+        bus->write(ADXL345_REG_DATAX0);
+        uint8_t status = bus->endTransmission(false);
+        if (status == I2C_STATUS_OK && bus->requestFrom(address, (uint8_t)sizeof(raw)) != sizeof(raw)) {
+            status = I2C_STATUS_SHORT_READ;
+        }
+        if (finish(status) != I2C_STATUS_OK) return false;
+        for (size_t i = 0; i < sizeof(raw); i++) {
+            raw[i] = bus->read();
+        }
+    }
+
+    out.x = (int16_t)((raw[1] << 8) | raw[0]);
+    out.y = (int16_t)((raw[3] << 8) | raw[2]);
+    out.z = (int16_t)((raw[5] << 8) | raw[4]);
+    return true;
+}
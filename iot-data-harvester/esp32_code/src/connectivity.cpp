@@ -0,0 +1,129 @@
+/**
+ * Module: Connectivity Manager
+ * See include/connectivity.h for the interface description.
+ */
+
+#include "connectivity.h"
+
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "timebase.h"
+
+const EventBits_t CONN_LINK_UP     = 1 << 0;
+const EventBits_t CONN_TIME_VALID  = 1 << 1;
+
+const uint32_t RETRY_MIN_MS = 500;
+const uint32_t RETRY_MAX_MS = 30000;
+
+Connectivity *Connectivity::instance = NULL;
+
+void Connectivity::begin(const char *ssid, const char *pass, const char *ntp1, const char *ntp2,
+                         Timebase *timebase) {
+    instance = this;
+    clock = timebase;
+    state = xEventGroupCreate();
+    retryTimer = xTimerCreate("WiFiRetry", pdMS_TO_TICKS(RETRY_MIN_MS), pdFALSE, this, onRetryTimer);
+
+    // The RTC keeps counting across software resets: no need to wait for SNTP then
+    if (time(NULL) >= CONN_MIN_VALID_UNIX) xEventGroupSetBits(state, CONN_TIME_VALID);
+    sntp_set_time_sync_notification_cb(onTimeSync);
+
+    WiFi.onEvent(onWifiEvent);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false); // Retries are scheduled with back-off below
+
+    // SNTP keeps polling on its own, so it can be started before the link is up
+    sntp_set_sync_interval(CONN_SNTP_INTERVAL_MS);
+    configTime(0, 0, ntp1, ntp2);
+
+    Serial.printf("[NET] Connecting to Access Point: %s\n", ssid);
+    WiFi.begin(ssid, pass);
+}
+
+bool Connectivity::linkUp() const {
+    return state != NULL && (xEventGroupGetBits(state) & CONN_LINK_UP) != 0;
+}
+
+bool Connectivity::ready() const {
+    const EventBits_t all = CONN_LINK_UP | CONN_TIME_VALID;
+    return state != NULL && (xEventGroupGetBits(state) & all) == all;
+}
+
+bool Connectivity::waitReady(TickType_t timeout) {
+    xEventGroupWaitBits(state, CONN_LINK_UP | CONN_TIME_VALID, pdFALSE, pdTRUE, timeout);
+    return ready();
+}
+
+void Connectivity::scheduleRetry() {
+    backoffMs = backoffMs == 0 ? RETRY_MIN_MS : (backoffMs * 2 > RETRY_MAX_MS ? RETRY_MAX_MS : backoffMs * 2);
+    // Also (re)starts the one-shot timer
+    xTimerChangePeriod(retryTimer, pdMS_TO_TICKS(backoffMs), 0);
+}
+
+void Connectivity::onRetryTimer(TimerHandle_t timer) {
+    // Timer service task: esp_wifi_connect() only starts the attempt. A failure
+    // raises another disconnect event, which schedules the next retry.
+    esp_wifi_connect();
+}
+
+void Connectivity::onWifiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    Connectivity *self = instance;
+    if (self == NULL) return;
+    const int64_t now = esp_timer_get_time();
+
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            xTimerStop(self->retryTimer, 0);
+            self->backoffMs = 0;
+            if (self->downSinceUs != 0) {
+                self->lastReconnect = (uint32_t)((now - self->downSinceUs) / 1000);
+                if (self->lastReconnect > self->maxReconnect) self->maxReconnect = self->lastReconnect;
+                self->downSinceUs = 0;
+                Serial.printf("[NET] WiFi reconnected in %lu ms.\n", (unsigned long)self->lastReconnect);
+            } else if (!self->everConnected) {
+                Serial.printf("[NET] WiFi Connected (%lu ms after boot).\n", (unsigned long)(now / 1000));
+            }
+            self->everConnected = true;
+            xEventGroupSetBits(self->state, CONN_LINK_UP);
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            if (xEventGroupGetBits(self->state) & CONN_LINK_UP) {
+                xEventGroupClearBits(self->state, CONN_LINK_UP);
+                self->disconnectCount++;
+                self->downSinceUs = now;
+                if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+                    Serial.printf("[NET] WiFi link lost (reason %u). Events are held until it is back.\n",
+                                  (unsigned)info.wifi_sta_disconnected.reason);
+                } else {
+                    Serial.println("[NET] IP lost. Events are held until it is back.");
+                }
+            }
+            // Still associated after LOST_IP: DHCP renews by itself
+            if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) self->scheduleRetry();
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Connectivity::onTimeSync(struct timeval *tv) {
+    Connectivity *self = instance;
+    if (self == NULL) return;
+    if (self->clock != NULL) self->clock->onSync(tv);
+    if (self->firstSyncMs == 0) {
+        self->firstSyncMs = (uint32_t)(esp_timer_get_time() / 1000);
+        Serial.printf("[NET] NTP synchronized (%lu ms after boot).\n", (unsigned long)self->firstSyncMs);
+    }
+    xEventGroupSetBits(self->state, CONN_TIME_VALID);
+}
+
+void Connectivity::report() const {
+    Serial.printf("[NET] Link %s | Disconnects: %lu | Reconnect last/max: %lu/%lu ms | First NTP sync: %lu ms\n",
+                  ready() ? "ready" : (linkUp() ? "up (no time)" : "down"),
+                  (unsigned long)disconnectCount, (unsigned long)lastReconnect,
+                  (unsigned long)maxReconnect, (unsigned long)firstSyncMs);
+}
@@ -0,0 +1,244 @@
+/**
+ * Module: Store-and-Forward Event Journal
+ * See include/event_journal.h for the layout and the delivery model.
+ */
+
+#include "event_journal.h"
+
+#include <string.h>
+#include "esp_rom_crc.h"
+
+static const uint32_t JOURNAL_MAGIC = 0x314A4751UL; // "QGJ1" little-endian
+static const size_t   RECORD_CRC_SPAN = offsetof(JournalRecord, crc);
+
+static_assert(sizeof(JournalRecord) == JOURNAL_RECORD_SIZE, "JournalRecord must fill one slot");
+
+static uint32_t recordCrc(const JournalRecord &r) {
+    return esp_rom_crc32_le(0, (const uint8_t *)&r, RECORD_CRC_SPAN);
+}
+
+static bool slotErased(const JournalRecord &r) {
+    const uint32_t *w = (const uint32_t *)&r;
+    for (size_t i = 0; i < JOURNAL_RECORD_SIZE / 4; i++) {
+        if (w[i] != 0xFFFFFFFFUL) return false;
+    }
+    return true;
+}
+
+bool EventJournal::begin() {
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "journal");
+    if (part == NULL) {
+        part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+    }
+    if (part == NULL || part->size < 2 * JOURNAL_SECTOR_SIZE) {
+        part = NULL;
+        Serial.println("[JOURNAL] No journal/spiffs partition. Events are kept in RAM only.");
+        return false;
+    }
+    sectors = part->size / JOURNAL_SECTOR_SIZE;
+    if (sectors > JOURNAL_MAX_SECTORS) sectors = JOURNAL_MAX_SECTORS;
+
+    lock = xSemaphoreCreateMutex();
+    queue = xQueueCreate(JOURNAL_QUEUE_DEPTH, sizeof(JournalRecord));
+
+    prefs.begin("quake-journal", false);
+    boot = prefs.getUInt("boot", 0) + 1;
+    prefs.putUInt("boot", boot);
+    ackedSeq = prefs.getUInt("acked", 0);
+
+    // Newest sector = highest sector counter among valid headers
+    bool found = false;
+    SectorHeader h;
+    for (uint32_t s = 0; s < sectors; s++) {
+        if (readHeader(s, h) && (!found || h.sector_seq > headSectorSeq)) {
+            found = true;
+            headSector = s;
+            headSectorSeq = h.sector_seq;
+            headFirstSeq = h.first_seq;
+        }
+    }
+
+    if (!found) {
+        // Blank or foreign partition. Continue after the cursor so sequence
+        // numbers are never reused, even if the partition was erased.
+        if (!openSector(0, 1, ackedSeq + 1)) {
+            part = NULL;
+            Serial.println("[JOURNAL] Format failed. Events are kept in RAM only.");
+            return false;
+        }
+        writeEnd = headFirstSeq;
+    } else {
+        // Write position: first erased slot of the head sector
+        uint32_t slot = 1;
+        JournalRecord r;
+        for (; slot < JOURNAL_SLOTS; slot++) {
+            esp_partition_read(part, headSector * JOURNAL_SECTOR_SIZE + slot * JOURNAL_RECORD_SIZE, &r, sizeof(r));
+            if (slotErased(r)) break;
+        }
+        writeEnd = headFirstSeq + (slot - 1);
+    }
+    // Events can be acknowledged before the writer persisted them: never hand
+    // out an acknowledged number again (the writer voids the skipped slots)
+    nextSeq = ackedSeq + 1 > writeEnd ? ackedSeq + 1 : writeEnd;
+
+    Serial.printf("[JOURNAL] Partition '%s': %lu sectors (%lu events) | Next seq %lu | Pending %lu | Boot %lu\n",
+                  part->label, (unsigned long)sectors, (unsigned long)(sectors * JOURNAL_RECORDS),
+                  (unsigned long)nextSeq, (unsigned long)pendingCount(), (unsigned long)boot);
+    return true;
+}
+
+bool EventJournal::readHeader(uint32_t sector, SectorHeader &h) const {
+    if (esp_partition_read(part, sector * JOURNAL_SECTOR_SIZE, &h, sizeof(h)) != ESP_OK) return false;
+    return h.magic == JOURNAL_MAGIC &&
+           h.crc == esp_rom_crc32_le(0, (const uint8_t *)&h, offsetof(SectorHeader, crc));
+}
+
+bool EventJournal::openSector(uint32_t sector, uint32_t sectorSeq, uint32_t firstSeq) {
+    if (esp_partition_erase_range(part, sector * JOURNAL_SECTOR_SIZE, JOURNAL_SECTOR_SIZE) != ESP_OK) {
+        writeErrors++;
+        return false;
+    }
+    SectorHeader h;
+    h.magic = JOURNAL_MAGIC;
+    h.sector_seq = sectorSeq;
+    h.first_seq = firstSeq;
+    h.crc = esp_rom_crc32_le(0, (const uint8_t *)&h, offsetof(SectorHeader, crc));
+    if (esp_partition_write(part, sector * JOURNAL_SECTOR_SIZE, &h, sizeof(h)) != ESP_OK) {
+        writeErrors++;
+        return false;
+    }
+    headSector = sector;
+    headSectorSeq = sectorSeq;
+    headFirstSeq = firstSeq;
+    return true;
+}
+
+bool EventJournal::locate(uint32_t seq, uint32_t *offset) const {
+    if (seq == 0 || seq >= writeEnd) return false;
+    // Every sector behind the head is full, so seq maps straight to a sector
+    uint32_t back = seq >= headFirstSeq ? 0 : (headFirstSeq - 1 - seq) / JOURNAL_RECORDS + 1;
+    if (back >= sectors) return false; // Overwritten by the ring
+    uint32_t sector = (headSector + sectors - back) % sectors;
+    uint32_t first = headFirstSeq - back * JOURNAL_RECORDS;
+
+    SectorHeader h;
+    if (back > 0 && (!readHeader(sector, h) || h.first_seq != first)) return false;
+    *offset = sector * JOURNAL_SECTOR_SIZE + (1 + seq - first) * JOURNAL_RECORD_SIZE;
+    return true;
+}
+
+uint32_t EventJournal::append(float magnitude, uint32_t uptime_ms, int64_t unix_us, uint32_t sample_index) {
+    if (part == NULL) return 0;
+    JournalRecord r;
+    r.seq = nextSeq++;
+    r.boot_id = boot;
+    r.uptime_ms = uptime_ms;
+    r.unix_time = unix_us > 0 ? (uint32_t)(unix_us / 1000000) : JOURNAL_TIME_UNKNOWN;
+    r.unix_usec = unix_us > 0 ? (uint32_t)(unix_us % 1000000) : 0;
+    r.magnitude = magnitude;
+    r.sample_index = sample_index;
+    r.crc = 0; // Computed by the writer
+    if (xQueueSend(queue, &r, 0) != pdTRUE) {
+        queueDrops++; // The writer leaves a void slot for this seq
+    }
+    return r.seq;
+}
+
+void EventJournal::writerTask(void *pvParameters) {
+    EventJournal *self = (EventJournal *)pvParameters;
+    static JournalRecord batch[JOURNAL_QUEUE_DEPTH];
+    for(;;) {
+        // Block for the first record, then take whatever else is queued
+        if (xQueueReceive(self->queue, &batch[0], portMAX_DELAY) != pdTRUE) continue;
+        size_t n = 1;
+        while (n < JOURNAL_QUEUE_DEPTH && xQueueReceive(self->queue, &batch[n], 0) == pdTRUE) n++;
+        self->writeBatch(batch, n);
+    }
+}
+
+void EventJournal::writeBatch(JournalRecord *records, size_t count) {
+    static JournalRecord stage[JOURNAL_QUEUE_DEPTH];
+    xSemaphoreTake(lock, portMAX_DELAY);
+
+    size_t i = 0;
+    while (i < count) {
+        uint32_t slot = writeEnd - headFirstSeq + 1;
+        if (slot >= JOURNAL_SLOTS) {
+            // Head full: reuse the next sector of the ring
+            uint32_t next = (headSector + 1) % sectors;
+            SectorHeader old;
+            if (readHeader(next, old) && old.first_seq + JOURNAL_RECORDS > ackedSeq + 1) {
+                uint32_t from = old.first_seq > ackedSeq + 1 ? old.first_seq : ackedSeq + 1;
+                overwritten += old.first_seq + JOURNAL_RECORDS - from;
+            }
+            if (!openSector(next, headSectorSeq + 1, writeEnd)) break;
+            slot = 1;
+        }
+
+        // Stage consecutive slots of this sector: one flash write per batch.
+        // A seq whose record never reached the queue gets a void slot (bad CRC),
+        // which keeps the seq -> slot mapping intact.
+        size_t room = JOURNAL_SLOTS - slot;
+        size_t n = 0;
+        while (n < room && n < JOURNAL_QUEUE_DEPTH && i < count) {
+            const uint32_t seq = writeEnd + n;
+            if (records[i].seq < seq) {
+                i++;
+                continue;
+            }
+            if (records[i].seq == seq) {
+                stage[n] = records[i++];
+                stage[n].crc = recordCrc(stage[n]);
+                written++;
+            } else {
+                memset(&stage[n], 0, sizeof(stage[n]));
+                stage[n].seq = seq;
+            }
+            n++;
+        }
+        if (n == 0) continue;
+
+        uint32_t offset = headSector * JOURNAL_SECTOR_SIZE + slot * JOURNAL_RECORD_SIZE;
+        if (esp_partition_write(part, offset, stage, n * JOURNAL_RECORD_SIZE) != ESP_OK) {
+            writeErrors++; // The slots are consumed anyway; replay sees bad CRCs
+        }
+        writeEnd += n;
+    }
+    xSemaphoreGive(lock);
+}
+
+size_t EventJournal::read(uint32_t fromSeq, JournalRecord *out, size_t max, uint32_t *scanEnd) {
+    size_t n = 0;
+    uint32_t seq = fromSeq;
+    if (part != NULL) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        for (; seq < writeEnd && n < max; seq++) {
+            uint32_t offset;
+            if (locate(seq, &offset) &&
+                esp_partition_read(part, offset, &out[n], sizeof(JournalRecord)) == ESP_OK &&
+                out[n].seq == seq && out[n].crc == recordCrc(out[n])) {
+                n++;
+            } else {
+                corrupt++;
+            }
+        }
+        xSemaphoreGive(lock);
+    }
+    *scanEnd = seq;
+    return n;
+}
+
+void EventJournal::acknowledge(uint32_t seq) {
+    if (part == NULL || seq <= ackedSeq) return;
+    ackedSeq = seq;
+    prefs.putUInt("acked", seq);
+}
+
+void EventJournal::report() const {
+    if (part == NULL) return;
+    Serial.printf("[JOURNAL] Written: %lu | Next seq %lu | Acked %lu | Pending %lu | Lost: queue %lu, overwritten %lu, "
+                  "unreadable %lu | Write errors %lu\n",
+                  (unsigned long)written, (unsigned long)nextSeq, (unsigned long)ackedSeq,
+                  (unsigned long)pendingCount(), (unsigned long)queueDrops,
+                  (unsigned long)overwritten, (unsigned long)corrupt, (unsigned long)writeErrors);
+}
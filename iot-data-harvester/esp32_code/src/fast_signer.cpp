@@ -0,0 +1,214 @@
+/**
+ * Module: Fast ECDSA Signer (SECP256R1)
+ * See include/fast_signer.h for the interface description.
+ */
+
+#include "fast_signer.h"
+
+// Bail out of a block of mbedtls calls on the first error
+#define FS_CHK(f) do { if ((ret = (f)) != 0) goto cleanup; } while (0)
+
+bool FastSigner::begin(mbedtls_pk_context *pk,
+                       int (*rng)(void *, unsigned char *, size_t), void *rngCtx) {
+    if (mbedtls_pk_get_type(pk) != MBEDTLS_PK_ECKEY) return false;
+    fallbackRng = rng;
+    fallbackRngCtx = rngCtx;
+
+    // Private group + DRBG for the presign task (ecp_mul caches tables in the group)
+    mbedtls_ecp_group_init(&presignGroup);
+    mbedtls_entropy_init(&presignEntropy);
+    mbedtls_ctr_drbg_init(&presignDrbg);
+
+    const char *pers = "quake_guard_presign";
+    if (mbedtls_ecp_group_load(&presignGroup, MBEDTLS_ECP_DP_SECP256R1) != 0 ||
+        mbedtls_ctr_drbg_seed(&presignDrbg, mbedtls_entropy_func, &presignEntropy,
+                              (const unsigned char *)pers, strlen(pers)) != 0) {
+        return false;
+    }
+    key = mbedtls_pk_ec(*pk); // Marks the signer ready
+    return true;
+}
+
+bool FastSigner::computePreSignature(PreSignature &out) {
+    int ret;
+    mbedtls_mpi k, b, kbinv, r;
+    mbedtls_ecp_point R;
+    mbedtls_mpi_init(&k);
+    mbedtls_mpi_init(&b);
+    mbedtls_mpi_init(&kbinv);
+    mbedtls_mpi_init(&r);
+    mbedtls_ecp_point_init(&R);
+
+    // k uniform in [1, n-1]; r = (k*G).x mod n, retried in the (negligible) r == 0 case
+    do {
+        FS_CHK(mbedtls_ecp_gen_privkey(&presignGroup, &k, mbedtls_ctr_drbg_random, &presignDrbg));
+        FS_CHK(mbedtls_ecp_mul(&presignGroup, &R, &k, &presignGroup.G,
+                               mbedtls_ctr_drbg_random, &presignDrbg));
+        FS_CHK(mbedtls_mpi_mod_mpi(&r, &R.X, &presignGroup.N));
+    } while (mbedtls_mpi_cmp_int(&r, 0) == 0);
+
+    // Blinding factor b uniform in [1, n-1]; finish() never touches d or k^-1 unblinded
+    FS_CHK(mbedtls_ecp_gen_privkey(&presignGroup, &b, mbedtls_ctr_drbg_random, &presignDrbg));
+    FS_CHK(mbedtls_mpi_mul_mpi(&kbinv, &k, &b));
+    FS_CHK(mbedtls_mpi_mod_mpi(&kbinv, &kbinv, &presignGroup.N));
+    FS_CHK(mbedtls_mpi_inv_mod(&kbinv, &kbinv, &presignGroup.N));
+    FS_CHK(mbedtls_mpi_write_binary(&r, out.r, sizeof(out.r)));
+    FS_CHK(mbedtls_mpi_write_binary(&kbinv, out.kbinv, sizeof(out.kbinv)));
+    FS_CHK(mbedtls_mpi_write_binary(&b, out.b, sizeof(out.b)));
+
+cleanup:
+    mbedtls_mpi_free(&k);
+    mbedtls_mpi_free(&b);
+    mbedtls_mpi_free(&kbinv);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_point_free(&R);
+    return ret == 0;
+}
+
+size_t FastSigner::refill() {
+    size_t added = 0;
+    PreSignature ps;
+    while (pool.size() < pool.capacity()) {
+        if (!computePreSignature(ps)) break;
+        pool.write(&ps, 1);
+        added++;
+    }
+    memset(&ps, 0, sizeof(ps)); // Do not leave a nonce inverse on the stack
+    return added;
+}
+
+void FastSigner::presignTask(void *pvParameters) {
+    FastSigner *self = (FastSigner *)pvParameters;
+    self->refillTask = xTaskGetCurrentTaskHandle();
+
+    for (;;) {
+        size_t added = self->refill();
+        if (added > 0) {
+            Serial.printf("[SEC] Pre-signature pool: %u/%u\n",
+                          (unsigned)self->pool.size(), (unsigned)self->pool.capacity());
+        }
+        // Sleep until signRaw() consumes an entry
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+int FastSigner::finish(const PreSignature &ps, const uint8_t hash[32], uint8_t rs[2 * ECDSA_P256_BYTES]) {
+    int ret;
+    mbedtls_mpi e, r, kbinv, b, bd, s;
+    mbedtls_mpi_init(&e);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&kbinv);
+    mbedtls_mpi_init(&b);
+    mbedtls_mpi_init(&bd);
+    mbedtls_mpi_init(&s);
+
+    // For P-256 the SHA-256 digest has exactly the bit length of n: no truncation.
+    FS_CHK(mbedtls_mpi_read_binary(&e, hash, 32));
+    FS_CHK(mbedtls_mpi_read_binary(&r, ps.r, sizeof(ps.r)));
+    FS_CHK(mbedtls_mpi_read_binary(&kbinv, ps.kbinv, sizeof(ps.kbinv)));
+    FS_CHK(mbedtls_mpi_read_binary(&b, ps.b, sizeof(ps.b)));
+
+    // s = (k*b)^-1 * (b*e + r*(b*d)) mod n = k^-1 * (e + r*d) mod n.
+    // mbedtls_mpi arithmetic is not constant-time: d only enters multiplied
+    // by the one-time random b, as in mbedtls_ecdsa_sign()'s blinding.
+    FS_CHK(mbedtls_mpi_mul_mpi(&bd, &b, &key->d));
+    FS_CHK(mbedtls_mpi_mod_mpi(&bd, &bd, &key->grp.N));
+    FS_CHK(mbedtls_mpi_mul_mpi(&s, &r, &bd));
+    FS_CHK(mbedtls_mpi_mod_mpi(&s, &s, &key->grp.N));
+    FS_CHK(mbedtls_mpi_mul_mpi(&e, &e, &b));
+    FS_CHK(mbedtls_mpi_add_mpi(&s, &s, &e));
+    FS_CHK(mbedtls_mpi_mod_mpi(&s, &s, &key->grp.N));
+    FS_CHK(mbedtls_mpi_mul_mpi(&s, &s, &kbinv));
+    FS_CHK(mbedtls_mpi_mod_mpi(&s, &s, &key->grp.N));
+    if (mbedtls_mpi_cmp_int(&s, 0) == 0) {
+        ret = -1; // Invalid signature, caller falls back to the deterministic path
+        goto cleanup;
+    }
+
+    memcpy(rs, ps.r, ECDSA_P256_BYTES);
+    FS_CHK(mbedtls_mpi_write_binary(&s, rs + ECDSA_P256_BYTES, ECDSA_P256_BYTES));
+
+cleanup:
+    mbedtls_mpi_free(&e);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&kbinv);
+    mbedtls_mpi_free(&b);
+    mbedtls_mpi_free(&bd);
+    mbedtls_mpi_free(&s);
+    return ret;
+}
+
+int FastSigner::signDeterministic(const uint8_t hash[32], uint8_t rs[2 * ECDSA_P256_BYTES]) {
+    int ret;
+    mbedtls_mpi r, s;
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    // RFC 6979: nonce derived from (d, hash), the DRBG only blinds the computation
+    FS_CHK(mbedtls_ecdsa_sign_det_ext(&key->grp, &r, &s, &key->d, hash, 32,
+                                      MBEDTLS_MD_SHA256, fallbackRng, fallbackRngCtx));
+    FS_CHK(mbedtls_mpi_write_binary(&r, rs, ECDSA_P256_BYTES));
+    FS_CHK(mbedtls_mpi_write_binary(&s, rs + ECDSA_P256_BYTES, ECDSA_P256_BYTES));
+
+cleanup:
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    return ret;
+}
+
+int FastSigner::signRaw(const uint8_t hash[32], uint8_t rs[2 * ECDSA_P256_BYTES], bool *fromPool) {
+    if (key == NULL) return -1;
+
+    size_t avail = 0;
+    const PreSignature *ps = pool.peek(avail);
+    if (avail > 0) {
+        PreSignature local = *ps;
+        pool.release(1); // Consumed before use: a nonce is never handed out twice
+        if (refillTask != NULL) xTaskNotifyGive(refillTask);
+
+        int ret = finish(local, hash, rs);
+        memset(&local, 0, sizeof(local));
+        if (ret == 0) {
+            if (fromPool) *fromPool = true;
+            return 0;
+        }
+    } else {
+        misses++;
+    }
+
+    if (fromPool) *fromPool = false;
+    return signDeterministic(hash, rs);
+}
+
+size_t FastSigner::signDer(const uint8_t hash[32], uint8_t *der, size_t derSize, bool *fromPool) {
+    uint8_t rs[2 * ECDSA_P256_BYTES];
+    if (signRaw(hash, rs, fromPool) != 0) return 0;
+    return derEncode(rs, der, derSize);
+}
+
+// Appends one ASN.1 INTEGER (minimal, non-negative encoding of a big-endian value)
+static size_t derInteger(const uint8_t *v, size_t len, uint8_t *out) {
+    while (len > 1 && v[0] == 0) {
+        v++;
+        len--;
+    }
+    bool pad = (v[0] & 0x80) != 0;
+    out[0] = 0x02;
+    out[1] = (uint8_t)(len + pad);
+    out[2] = 0x00;
+    memcpy(out + 2 + pad, v, len);
+    return 2 + pad + len;
+}
+
+size_t FastSigner::derEncode(const uint8_t rs[2 * ECDSA_P256_BYTES], uint8_t *der, size_t derSize) {
+    uint8_t body[2 * (3 + ECDSA_P256_BYTES)];
+    size_t n = derInteger(rs, ECDSA_P256_BYTES, body);
+    n += derInteger(rs + ECDSA_P256_BYTES, ECDSA_P256_BYTES, body + n);
+
+    // Body is at most 70 bytes, so the SEQUENCE length always fits one byte
+    if (derSize < n + 2) return 0;
+    der[0] = 0x30;
+    der[1] = (uint8_t)n;
+    memcpy(der + 2, body, n);
+    return n + 2;
+}
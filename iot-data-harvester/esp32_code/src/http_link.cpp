@@ -0,0 +1,156 @@
+/**
+ * Module: Persistent HTTP/1.1 Link
+ * See include/http_link.h for the interface description.
+ */
+
+#include "http_link.h"
+
+static const uint32_t LINK_CONNECT_TIMEOUT_MS = 3000;
+static const uint32_t LINK_RETRY_MS           = 2000; // Background reconnect back-off
+
+HttpLink::HttpLink(const char *host, uint16_t port) : host(host), port(port) {}
+
+bool HttpLink::connected() {
+    return client.connected();
+}
+
+bool HttpLink::ensureConnected() {
+    if (client.connected()) {
+        lastReused = true;
+        return true;
+    }
+    lastReused = false;
+
+    client.stop(); // Release a half-closed socket before reconnecting
+    unsigned long t0 = millis();
+    lastAttempt = t0;
+    if (!client.connect(host, port, LINK_CONNECT_TIMEOUT_MS)) {
+        return false;
+    }
+    connectMs = millis() - t0;
+    if (connectMs > worstConnectMs) worstConnectMs = connectMs;
+    connects++;
+
+    // Pipelined requests are small; do not let Nagle hold them back.
+    client.setNoDelay(true);
+    return true;
+}
+
+void HttpLink::maintain() {
+    if (client.connected() || WiFi.status() != WL_CONNECTED) return;
+    if (millis() - lastAttempt < LINK_RETRY_MS) return;
+
+    if (ensureConnected()) {
+        Serial.printf("[NET] Link warm: connected to %s:%u in %lu ms\n",
+                      host, port, (unsigned long)connectMs);
+    }
+}
+
+void HttpLink::close() {
+    client.stop();
+}
+
+bool HttpLink::sendPost(const char *path, const char *contentType, const uint8_t *body, size_t len) {
+    int headLen = snprintf((char *)txBuf, sizeof(txBuf),
+                           "POST %s HTTP/1.1\r\n"
+                           "Host: %s\r\n"
+                           "Content-Type: %s\r\n"
+                           "Content-Length: %u\r\n"
+                           "Connection: keep-alive\r\n"
+                           "\r\n",
+                           path, host, contentType, (unsigned)len);
+    if (headLen <= 0 || (size_t)headLen + len > sizeof(txBuf)) return false;
+
+    memcpy(txBuf + headLen, body, len);
+    size_t total = headLen + len;
+    return client.write(txBuf, total) == total;
+}
+
+bool HttpLink::sendGet(const char *path) {
+    int headLen = snprintf((char *)txBuf, sizeof(txBuf),
+                           "GET %s HTTP/1.1\r\n"
+                           "Host: %s\r\n"
+                           "Connection: keep-alive\r\n"
+                           "\r\n",
+                           path, host);
+    if (headLen <= 0 || (size_t)headLen >= sizeof(txBuf)) return false;
+    return client.write(txBuf, headLen) == (size_t)headLen;
+}
+
+bool HttpLink::readLine(char *buf, size_t size, unsigned long deadline) {
+    size_t n = 0;
+    while ((long)(deadline - millis()) > 0) {
+        if (!client.available()) {
+            if (!client.connected()) return false;
+            vTaskDelay(pdMS_TO_TICKS(1));
+            continue;
+        }
+        int c = client.read();
+        if (c == '\n') {
+            if (n > 0 && buf[n - 1] == '\r') n--;
+            buf[n] = '\0';
+            return true;
+        }
+        if (n < size - 1) buf[n++] = (char)c; // Over-long lines are truncated
+    }
+    return false;
+}
+
+int HttpLink::readResponse(uint32_t timeout_ms, char *body, size_t bodySize) {
+    unsigned long deadline = millis() + timeout_ms;
+    char line[128];
+
+    // Status line: "HTTP/1.1 202 Accepted"
+    if (!readLine(line, sizeof(line), deadline)) return -1;
+    int status = -1;
+    if (sscanf(line, "HTTP/%*d.%*d %d", &status) != 1) return -1;
+
+    // Headers
+    long contentLength = 0;
+    bool serverClosing = false;
+    for (;;) {
+        if (!readLine(line, sizeof(line), deadline)) return -1;
+        if (line[0] == '\0') break;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            const char *value = line + 15;
+            while (*value == ' ' || *value == '\t') value++;
+            char *end;
+            contentLength = strtol(value, &end, 10);
+            while (*end == ' ' || *end == '\t') end++;
+            if (end == value || *end != '\0' || contentLength < 0) {
+                client.stop(); // Unknown body length: the next response could not be found
+                return -1;
+            }
+        } else if (strncasecmp(line, "Connection:", 11) == 0 && strcasestr(line + 11, "close")) {
+            serverClosing = true;
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            // Chunked bodies are not parsed; resync by reconnecting afterwards.
+            serverClosing = true;
+        }
+    }
+
+    // Body (discarded unless the caller wants it: the status code is the acknowledgement)
+    const bool keep = body != NULL && bodySize > 0 && contentLength < (long)bodySize;
+    size_t kept = 0;
+    while (contentLength > 0 && (long)(deadline - millis()) > 0) {
+        if (client.available()) {
+            int c = client.read();
+            if (keep) body[kept++] = (char)c;
+            contentLength--;
+        } else if (!client.connected()) {
+            break;
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+    }
+    if (contentLength != 0) {
+        // Body cut short (deadline or peer gone): its tail would be read as the next status line
+        if (body != NULL && bodySize > 0) body[0] = '\0';
+        client.stop();
+        return -1;
+    }
+    if (body != NULL && bodySize > 0) body[kept] = '\0';
+
+    if (serverClosing) client.stop();
+    return status;
+}
@@ -0,0 +1,198 @@
+/**
+ * Module: Adaptive I2C Bus
+ * See include/i2c_bus.h for the policy.
+ */
+
+#include "i2c_bus.h"
+
+static const uint32_t CLOCK_LADDER[] = { 400000, 100000, 10000 };
+static const uint32_t WINDOW_MS = 1000;
+
+void I2cBus::begin(TwoWire &wire, int sdaPin, int sclPin, uint32_t startHz, uint32_t sampleHz,
+                   bool adaptive, bool settle) {
+    bus = &wire;
+    sda = sdaPin;
+    scl = sclPin;
+    adaptiveClock = adaptive;
+
+    // Top rung: the requested clock (ADXL345 maximum 400 kHz), then every slower
+    // standard clock that still moves one second of samples in one second
+    const uint32_t floorHz = I2C_BITS_PER_SAMPLE * sampleHz;
+    rungs[0] = startHz < CLOCK_LADDER[0] ? startHz : CLOCK_LADDER[0];
+    rungCount = 1;
+    for (size_t i = 0; i < sizeof(CLOCK_LADDER) / sizeof(CLOCK_LADDER[0]) && rungCount < I2C_MAX_RUNGS; i++) {
+        if (CLOCK_LADDER[i] < rungs[0] && CLOCK_LADDER[i] >= floorHz) rungs[rungCount++] = CLOCK_LADDER[i];
+    }
+    rung = 0;
+
+    restart(settle);
+    windowStartMs = millis();
+    Serial.printf("[I2C] Bus at %lu kHz (%s, floor %lu kHz).\n", (unsigned long)(clockHz() / 1000),
+                  adaptiveClock ? "adaptive" : "fixed", (unsigned long)(rungs[rungCount - 1] / 1000));
+}
+
+/**
+ * @brief Frees a slave stuck mid-byte and restarts the driver.
+ * A slave that lost a clock edge holds SDA low waiting for the rest of its
+ * byte; up to nine SCL pulses let it finish, and a STOP resets its state
+ * machine. The driver must not own the pins meanwhile.
+ */
+void I2cBus::restart(bool settle) {
+    bus->end();
+
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, INPUT_PULLUP);
+    digitalWrite(sda, HIGH);
+    digitalWrite(scl, HIGH);
+    if (settle) delay(50);
+
+    pinMode(scl, OUTPUT_OPEN_DRAIN);
+    for (int i = 0; i < 9 && digitalRead(sda) == LOW; i++) {
+        digitalWrite(scl, LOW);
+        delayMicroseconds(5);
+        digitalWrite(scl, HIGH);
+        delayMicroseconds(5);
+    }
+    // STOP: SDA rises while SCL is high
+    pinMode(sda, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(sda, HIGH);
+    delayMicroseconds(5);
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, INPUT_PULLUP);
+
+    bus->setPins(sda, scl);
+    bus->begin();
+    bus->setClock(clockHz());
+    bus->setTimeOut(I2C_TIMEOUT_MS);
+    if (settle) delay(100);
+}
+
+void I2cBus::recover() {
+    restart(false);
+    portENTER_CRITICAL(&mux);
+    window.recoveries++;
+    total.recoveries++;
+    portEXIT_CRITICAL(&mux);
+}
+
+void I2cBus::changeRung(uint8_t next) {
+    const uint32_t from = clockHz();
+    const bool down = next > rung;
+    rung = next;
+    restart(false);
+    portENTER_CRITICAL(&mux);
+    if (down) {
+        window.stepsDown++;
+        total.stepsDown++;
+    } else {
+        window.stepsUp++;
+        total.stepsUp++;
+    }
+    portEXIT_CRITICAL(&mux);
+    Serial.printf("[I2C] Clock %lu -> %lu kHz.\n", (unsigned long)(from / 1000), (unsigned long)(clockHz() / 1000));
+}
+
+void I2cBus::noteTransfer(uint8_t status) {
+    portENTER_CRITICAL(&mux);
+    window.transfers++;
+    switch (status) {
+        case I2C_STATUS_OK:
+            break;
+        case I2C_STATUS_NACK_ADDR:
+        case I2C_STATUS_NACK_DATA:
+            window.nacks++;
+            break;
+        default: // Timeouts, short reads and bus errors all mean a held line
+            window.timeouts++;
+            break;
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+void I2cBus::noteDropouts(uint32_t frames) {
+    if (frames == 0) return;
+    portENTER_CRITICAL(&mux);
+    window.dropouts += frames;
+    portEXIT_CRITICAL(&mux);
+}
+
+bool I2cBus::service() {
+    const unsigned long now = millis();
+    if (now - windowStartMs < WINDOW_MS) return false;
+    windowStartMs = now;
+
+    portENTER_CRITICAL(&mux);
+    const BusCounters closed = window;
+    total.transfers += closed.transfers; // Recoveries and steps are added when they happen
+    total.nacks     += closed.nacks;
+    total.timeouts  += closed.timeouts;
+    total.dropouts  += closed.dropouts;
+    previous = closed;
+    if (closed.errors() > worst.errors()) worst = closed;
+    window = BusCounters();
+    portEXIT_CRITICAL(&mux);
+
+    if (closed.errors() >= I2C_ERROR_BUDGET) {
+        cleanSeconds = 0;
+        badSeconds++;
+        Serial.printf("[I2C] %lu errors in 1 s at %lu kHz (nack %lu, timeout %lu, dropout %lu).\n",
+                      (unsigned long)closed.errors(), (unsigned long)(clockHz() / 1000),
+                      (unsigned long)closed.nacks, (unsigned long)closed.timeouts, (unsigned long)closed.dropouts);
+        if (adaptiveClock && badSeconds >= 2 && rung + 1 < rungCount) {
+            if (tryingFaster) {
+                // The faster clock did not hold: wait longer before the next try
+                stepUpHold = stepUpHold * 2 < I2C_STEP_UP_MAX_S ? stepUpHold * 2 : I2C_STEP_UP_MAX_S;
+                tryingFaster = false;
+            }
+            badSeconds = 0;
+            changeRung(rung + 1);
+        } else {
+            recover();
+        }
+        return true;
+    }
+
+    badSeconds = 0;
+    cleanSeconds++;
+    if (tryingFaster && cleanSeconds >= I2C_STEP_UP_S) {
+        tryingFaster = false;
+        stepUpHold = I2C_STEP_UP_S;
+    }
+    if (adaptiveClock && rung > 0 && cleanSeconds >= stepUpHold) {
+        cleanSeconds = 0;
+        tryingFaster = true;
+        changeRung(rung - 1);
+        return true;
+    }
+    return false;
+}
+
+BusCounters I2cBus::lastSecond() const {
+    portENTER_CRITICAL(&mux);
+    const BusCounters c = previous;
+    portEXIT_CRITICAL(&mux);
+    return c;
+}
+
+BusCounters I2cBus::totals() const {
+    portENTER_CRITICAL(&mux);
+    const BusCounters c = total;
+    portEXIT_CRITICAL(&mux);
+    return c;
+}
+
+void I2cBus::report() {
+    portENTER_CRITICAL(&mux);
+    const BusCounters last = previous, peak = worst, sum = total;
+    worst = BusCounters();
+    portEXIT_CRITICAL(&mux);
+    Serial.printf("[I2C] %lu kHz | Last 1 s: %lu errors / %lu transfers | Worst 1 s: nack %lu, timeout %lu, "
+                  "dropout %lu\n",
+                  (unsigned long)(clockHz() / 1000), (unsigned long)last.errors(), (unsigned long)last.transfers,
+                  (unsigned long)peak.nacks, (unsigned long)peak.timeouts, (unsigned long)peak.dropouts);
+    Serial.printf("[I2C] Total: nack %lu, timeout %lu, dropout %lu | Recoveries %lu | Clock down %lu, up %lu\n",
+                  (unsigned long)sum.nacks, (unsigned long)sum.timeouts, (unsigned long)sum.dropouts,
+                  (unsigned long)sum.recoveries, (unsigned long)sum.stepsDown, (unsigned long)sum.stepsUp);
+}
@@ -17,12 +17,14 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <SPI.h>
 #include <Adafruit_Sensor.h>
 #include <Adafruit_ADXL345_U.h>
 #include <WiFi.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
 #include <time.h>
+#include "esp_timer.h"
 
 // Cryptographic Libraries (MbedTLS)
 #include "mbedtls/entropy.h"
@@ -31,6 +33,31 @@
 #include "mbedtls/pk.h"
 #include "mbedtls/error.h"
 
+#include "i2c_bus.h"
+#include "adxl345_fifo.h"
+#include "power_manager.h"
+#include "connectivity.h"
+#include "timebase.h"
+#include "task_layout.h"
+#include "metrics.h"
+#include "remote_config.h"
+#include "event_journal.h"
+#include "dsp_fixed.h"
+#include "sta_lta.h"
+#include "dsp_block.h"
+#include "detector_bank.h"
+#include "detector_profile.h"
+#include "detector_config.h"
+#include "event_features.h"
+#include "spsc_ring.h"
+#include "http_link.h"
+#include "json_arena.h"
+#include "fast_signer.h"
+#include "wire_format.h"
+#include "waveform_capture.h"
+#include "sample_codec.h"
+#include "event_backlog.h"
+
 // --------------------------------------------------------------------------
 // HARDWARE PIN DEFINITIONS (ESP32-C3 SuperMini)
 // --------------------------------------------------------------------------
@@ -38,10 +65,44 @@
 #define I2C_SDA_PIN 7
 #define I2C_SCL_PIN 8
 
+// Sensor transport. SPI (4-wire, mode 3) moves a FIFO entry in ~20 us instead of
+// ~250 us at 400kHz I2C. SCLK and SDI reuse the SCL/SDA wires; SDO and CS get
+// their own pins (the ADXL345 selects I2C while CS is high).
+#define SENSOR_BUS_I2C 0
+#define SENSOR_BUS_SPI 1
+#ifndef SENSOR_BUS
+  #define SENSOR_BUS SENSOR_BUS_I2C
+#endif
+#ifndef SENSOR_SPI_SCK_PIN
+  #define SENSOR_SPI_SCK_PIN  I2C_SCL_PIN
+#endif
+#ifndef SENSOR_SPI_MOSI_PIN
+  #define SENSOR_SPI_MOSI_PIN I2C_SDA_PIN
+#endif
+#ifndef SENSOR_SPI_MISO_PIN
+  #define SENSOR_SPI_MISO_PIN 5
+#endif
+#ifndef SENSOR_SPI_CS_PIN
+  #define SENSOR_SPI_CS_PIN   6
+#endif
+#ifndef SENSOR_SPI_HZ
+  #define SENSOR_SPI_HZ       5000000 // ADXL345 maximum
+#endif
+#ifndef BUS_BENCHMARK
+  #define BUS_BENCHMARK       0       // Time a FIFO burst over I2C and SPI at boot (needs SPI wiring)
+#endif
+
+// ADXL345 INT1 -> ESP32 GPIO (FIFO watermark interrupt line).
+#ifndef ADXL_INT1_PIN
+  #define ADXL_INT1_PIN 3
+#endif
+
 // Global Sensor Pointer
 // Initialized to NULL. Instantiated dynamically in setup() to prevent 
 // static initialization race conditions with the I2C bus.
 Adafruit_ADXL345_Unified *accel = NULL;
+uint8_t sensorAddress = 0; // I2C address that answered in setup()
+bool sensorFound = false;  // An ADXL345 answered in setup() (either transport)
 
 // --------------------------------------------------------------------------
 // NETWORK & SERVER CONFIGURATION
@@ -65,6 +126,108 @@ Adafruit_ADXL345_Unified *accel = NULL;
   #define SENSOR_ID 101
 #endif
 
+// Event batching: one signed request for every event drained from the queue
+#ifndef BATCH_MODE
+  #define BATCH_MODE 1
+#endif
+#ifndef BATCH_WINDOW_MS
+  #define BATCH_WINDOW_MS 20 // Extra wait for follow-up events after the first one
+#endif
+
+// Signed performance heartbeat (metrics.h) every HEARTBEAT_MS, 0 = off
+#ifndef HEARTBEAT_MS
+  #define HEARTBEAT_MS 60000
+#endif
+#ifndef HEARTBEAT_PATH
+  #define HEARTBEAT_PATH "/heartbeats/"
+#endif
+
+// Server-pushed detector configuration (remote_config.h), polled every REMOTE_CONFIG_POLL_MS.
+// On by default once REMOTE_CONFIG_PUBKEY (GET /config/public-key on the backend) is set.
+#ifndef REMOTE_CONFIG
+  #ifdef REMOTE_CONFIG_PUBKEY
+    #define REMOTE_CONFIG 1
+  #else
+    #define REMOTE_CONFIG 0
+  #endif
+#endif
+#ifndef REMOTE_CONFIG_POLL_MS
+  #define REMOTE_CONFIG_POLL_MS 300000
+#endif
+
+// Store-and-forward: every trigger is journaled in flash with a sequence number and
+// replayed after outages and reboots (see event_journal.h)
+#ifndef EVENT_JOURNAL
+  #define EVENT_JOURNAL 1
+#endif
+
+// Wire format: 0 = JSON + signature_hex, 1 = binary frame (see wire_format.h)
+#ifndef WIRE_BINARY
+  #define WIRE_BINARY 0
+#endif
+
+// Timestamps: 1 = signed µs device time (see timebase.h), 0 = whole Unix seconds
+// (backends that predate device_timestamp_us)
+#ifndef TIMESTAMP_US
+  #define TIMESTAMP_US 1
+#endif
+
+// Fast signing: idle-time pre-signature pool + RFC 6979 fallback (see fast_signer.h)
+#ifndef FAST_SIGN
+  #define FAST_SIGN 1
+#endif
+#ifndef SIGN_BENCHMARK
+  #define SIGN_BENCHMARK 1 // Print sign latency at boot
+#endif
+
+// Fast boot: once the server has accepted a signed event, later boots skip the serial
+// wait and the key countdown, and crypto init runs in parallel with sensor arming
+#ifndef FAST_BOOT
+  #define FAST_BOOT 1
+#endif
+
+// Raw waveform streaming (binary TCP, see StreamFrameHeader)
+#ifndef WAVEFORM_STREAM
+  #define WAVEFORM_STREAM 0
+#endif
+#ifndef STREAM_HOST
+  #define STREAM_HOST SERVER_HOST
+#endif
+#ifndef STREAM_PORT
+  #define STREAM_PORT 9000
+#endif
+
+// Pre/post-trigger waveform capture, uploaded in the background to /waveforms/
+#ifndef WAVEFORM_CAPTURE
+  #define WAVEFORM_CAPTURE 1
+#endif
+#ifndef CAPTURE_PRE_MS
+  #define CAPTURE_PRE_MS 4000
+#endif
+#ifndef CAPTURE_POST_MS
+  #define CAPTURE_POST_MS 6000
+#endif
+#ifndef WAVEFORM_ENCODING
+  #define WAVEFORM_ENCODING WAVEFORM_ENC_DELTA_VARINT // or WAVEFORM_ENC_RAW16
+#endif
+#ifndef CODEC_BENCHMARK
+  #define CODEC_BENCHMARK WAVEFORM_CAPTURE // Print bytes and cycles per sample at boot
+#endif
+
+// Event features and local pre-classification (lib/QuakeCore/src/event_features.h).
+// A trigger is held for FEATURE_WINDOW_MS while its features are computed, then sent
+// with them; with FEATURE_SUPPRESS impulsive events (doors, knocks) are not sent at all.
+// Off by default: the hold adds the whole window to the trigger-to-alert latency.
+#ifndef EVENT_FEATURES
+  #define EVENT_FEATURES 0
+#endif
+#ifndef FEATURE_WINDOW_MS
+  #define FEATURE_WINDOW_MS 1000
+#endif
+#ifndef FEATURE_SUPPRESS
+  #define FEATURE_SUPPRESS 1 // 0 = tag only, the backend filters
+#endif
+
 // Constant mapping for type safety
 const char* WIFI_SSID_CONF     = WIFI_SSID;
 const char* WIFI_PASS_CONF     = WIFI_PASS;
@@ -72,24 +235,200 @@ const char* SERVER_HOST_CONF   = SERVER_HOST;
 const int   SERVER_PORT_CONF   = SERVER_PORT;
 const char* SERVER_PATH_CONF   = SERVER_PATH;
 const int   SENSOR_ID_CONF     = SENSOR_ID;
+const char* STREAM_HOST_CONF   = STREAM_HOST;
+const int   STREAM_PORT_CONF   = STREAM_PORT;
 
 // --------------------------------------------------------------------------
 // RTOS HANDLES & DATA STRUCTURES
 // --------------------------------------------------------------------------
 QueueHandle_t eventQueue;
+#define EVENT_QUEUE_LENGTH 20
+TaskMonitor monitor;              // Task creation (task_layout.h) and run-time report
+Metrics metrics;                  // Field counters, sent in the heartbeat (metrics.h)
 
 struct SeismicEvent {
+    int64_t event_us;           // esp_timer time of the trigger sample (this boot)
+    int64_t device_time_us;     // Unix µs; 0 = derive from event_us (clock not set at trigger)
     float magnitude;            // Computed STA/LTA Ratio
-    unsigned long event_millis; // System timestamp at trigger time
+    uint32_t seq;               // Journal sequence number (0 = not journaled)
+    uint32_t sample_index;      // Sensor sample counter at the trigger sample
+    EventFeatures features;     // event_class EVENT_CLASS_NONE: sent without features
+};
+#define EVENT_TIME_UNKNOWN (-1) // Replayed from a boot that never had the clock set
+
+Timebase timebase;              // esp_timer -> Unix µs, disciplined by SNTP
+uint32_t sampleCounter = 0;     // Samples processed since boot (sensor task)
+
+#if EVENT_JOURNAL
+EventJournal journal;
+#endif
+
+// High-volume sample path: acquisition -> network, lock-free and zero-copy.
+// eventQueue stays the channel for discrete trigger events only.
+#if WAVEFORM_STREAM
+#define SAMPLE_RING_SIZE 2048 // 12 KB static RAM: ~20s at 100Hz, ~5s at 400Hz
+SpscRing<RawSample, SAMPLE_RING_SIZE> sampleRing;
+
+// Frame prepended to every span sent on the stream socket (little-endian).
+struct __attribute__((packed)) StreamFrameHeader {
+    uint32_t magic;     // STREAM_MAGIC
+    uint16_t sensor_id;
+    uint16_t odr_hz;
+    uint32_t seq;       // Frame counter, gaps reveal lost frames
+    uint32_t dropped;   // Producer overrun counter at send time
+    uint16_t count;     // RawSample entries following the header
+    uint16_t reserved;
 };
+const uint32_t STREAM_MAGIC = 0x53574751; // "QGWS"
+#endif
 
 // --------------------------------------------------------------------------
 // DSP ALGORITHM PARAMETERS
 // --------------------------------------------------------------------------
-const float ALPHA_LTA     = 0.05f; // Long Term Average smoothing factor
-const float ALPHA_STA     = 0.40f; // Short Term Average smoothing factor
-const float TRIGGER_RATIO = 1.8f;  // Threshold ratio for alarm triggering
-const float NOISE_FLOOR   = 0.04f; // Minimum G-force to consider valid signal (Noise Gate)
+// Detector tuning is a compile-time profile (lib/QuakeCore/src/detector_profile.h):
+// 0 = reference, 1 = building, 2 = bedrock. The kernels are specialized for it.
+#ifndef DETECTOR_PROFILE
+  #define DETECTOR_PROFILE DETECTOR_PROFILE_REFERENCE
+#endif
+#if DETECTOR_PROFILE == DETECTOR_PROFILE_REFERENCE
+typedef ProfileReference ActiveProfile;
+#elif DETECTOR_PROFILE == DETECTOR_PROFILE_BUILDING
+typedef ProfileBuilding ActiveProfile;
+#elif DETECTOR_PROFILE == DETECTOR_PROFILE_BEDROCK
+typedef ProfileBedrock ActiveProfile;
+#else
+  #error "DETECTOR_PROFILE must be 0 (reference), 1 (building) or 2 (bedrock)"
+#endif
+
+// --------------------------------------------------------------------------
+// ACQUISITION MODE
+// --------------------------------------------------------------------------
+// SENSOR_FIFO_MODE=1: ADXL345 STREAM FIFO + watermark interrupt, burst drained.
+// SENSOR_FIFO_MODE=0: legacy 100Hz getEvent() polling through vTaskDelayUntil.
+#ifndef SENSOR_FIFO_MODE
+  #define SENSOR_FIFO_MODE 1
+#endif
+#ifndef FIFO_WATERMARK
+  #define FIFO_WATERMARK 25 // Samples per wakeup (25 x 10ms = 250ms blocks)
+#endif
+
+// SENSOR_HIGH_RATE=1: 400-800 Hz sampling with the fixed-point block pipeline
+// (dsp_fixed.h) and a 400kHz I2C clock. Requires the FIFO acquisition path.
+#ifndef SENSOR_HIGH_RATE
+  #define SENSOR_HIGH_RATE 0
+#endif
+#ifndef SENSOR_ODR_HZ
+  #if SENSOR_HIGH_RATE
+    #define SENSOR_ODR_HZ 400
+  #else
+    #define SENSOR_ODR_HZ 100
+  #endif
+#endif
+// DETECTOR_BANK=1: multi-band band-pass + STA/LTA bank with voting
+// (detector_bank.h) instead of the single broadband detector. FIFO path only.
+#ifndef DETECTOR_BANK
+  #define DETECTOR_BANK 0
+#endif
+#ifndef DSP_BENCHMARK
+  #define DSP_BENCHMARK (SENSOR_HIGH_RATE || DETECTOR_BANK) // Print cycles/sample at boot
+#endif
+
+// LOW_POWER=1: battery / UPS operation (power_manager.h). Light sleep between FIFO
+// watermarks (INT1 wakes the chip), Wi-Fi in max modem sleep until an event is sent.
+#ifndef LOW_POWER
+  #define LOW_POWER 0
+#endif
+
+#if SENSOR_HIGH_RATE && !SENSOR_FIFO_MODE
+  #error "SENSOR_HIGH_RATE requires SENSOR_FIFO_MODE=1"
+#endif
+#if DETECTOR_BANK && !SENSOR_FIFO_MODE
+  #error "DETECTOR_BANK requires SENSOR_FIFO_MODE=1"
+#endif
+// I2C_ADAPTIVE=1: the bus starts at I2C_CLOCK_HZ (400kHz) and steps down or runs the
+// bus recovery on its own when errors pile up (i2c_bus.h).
+#ifndef I2C_ADAPTIVE
+  #define I2C_ADAPTIVE 1
+#endif
+#ifndef I2C_CLOCK_HZ
+  #if I2C_ADAPTIVE || SENSOR_HIGH_RATE
+    #define I2C_CLOCK_HZ 400000
+  #elif LOW_POWER
+    #define I2C_CLOCK_HZ 100000 // A 25-entry drain takes ~20ms instead of ~210ms of awake time per burst
+  #else
+    #define I2C_CLOCK_HZ 10000  // Legacy stability clock
+  #endif
+#endif
+
+#if SENSOR_BUS != SENSOR_BUS_I2C && SENSOR_BUS != SENSOR_BUS_SPI
+  #error "SENSOR_BUS must be 0 (I2C) or 1 (SPI)"
+#endif
+#if LOW_POWER && !SENSOR_FIFO_MODE
+  #error "LOW_POWER requires SENSOR_FIFO_MODE=1 (polling wakes the CPU every sample)"
+#endif
+#if LOW_POWER && WAVEFORM_STREAM
+  #error "LOW_POWER is incompatible with WAVEFORM_STREAM (the stream keeps the radio awake)"
+#endif
+#if SENSOR_ODR_HZ != 100 && SENSOR_ODR_HZ != 200 && SENSOR_ODR_HZ != 400 && SENSOR_ODR_HZ != 800
+  #error "SENSOR_ODR_HZ must be one of 100, 200, 400, 800"
+#endif
+#if EVENT_FEATURES && (FEATURE_WINDOW_MS < 100 || FEATURE_WINDOW_MS > FEATURE_MAX_WINDOW_MS)
+  #error "FEATURE_WINDOW_MS must be between 100 and 10000"
+#endif
+#if REMOTE_CONFIG && !defined(REMOTE_CONFIG_PUBKEY)
+  #error "REMOTE_CONFIG requires REMOTE_CONFIG_PUBKEY (the backend's configuration public key)"
+#endif
+
+const uint32_t SAMPLE_PERIOD_US   = 1000000UL / SENSOR_ODR_HZ;
+
+// Float (sta_lta.h, dsp_block.h) and Q15 (dsp_fixed.h) parameters of the active profile.
+// Every member is constexpr; the host replay harness (env:native) runs the same types.
+typedef StaticDetectorParams<ActiveProfile, SENSOR_ODR_HZ> ActiveDetectorParams;
+typedef StaticFixedParams<ActiveProfile, SENSOR_ODR_HZ>    ActiveFixedParams;
+const ActiveDetectorParams DETECTOR_PARAMS = {};
+const ActiveFixedParams    FIXED_PARAMS = {};
+// Dropout threshold as a squared raw magnitude: the FIFO path checks it without a sqrt
+const uint32_t DROPOUT_COUNTS_SQ = (uint32_t)((DETECTOR_PARAMS.dropout_ms2 / ADXL345_LSB_TO_MS2) *
+                                              (DETECTOR_PARAMS.dropout_ms2 / ADXL345_LSB_TO_MS2));
+
+// Pushed configuration (detector_config.h): staged by the network task, swapped in by
+// the sensor task between blocks. Until one arrives the profile kernels run; without
+// REMOTE_CONFIG remoteParamsActive is a constant and the runtime branch compiles away.
+static LiveDetectorParams remoteParams;
+#if REMOTE_CONFIG
+const char* REMOTE_CONFIG_PUBKEY_CONF = REMOTE_CONFIG_PUBKEY;
+ConfigSwap<LiveDetectorParams> configSwap;
+RemoteConfig remoteConfig;
+static bool remoteParamsActive = false;
+#else
+static const bool remoteParamsActive = false;
+#endif
+
+I2cBus i2c;
+
+Adxl345Fifo fifo;
+PowerManager power;
+
+#if WAVEFORM_CAPTURE
+#define CAPTURE_PRE_SAMPLES  ((CAPTURE_PRE_MS * SENSOR_ODR_HZ) / 1000)
+#define CAPTURE_POST_SAMPLES ((CAPTURE_POST_MS * SENSOR_ODR_HZ) / 1000)
+// Fixed static window: 6 KB at 100 Hz, 24 KB at 400 Hz (10 s of 3 x int16)
+WaveformCapture<CAPTURE_PRE_SAMPLES, CAPTURE_POST_SAMPLES> capture;
+#endif
+
+#if EVENT_FEATURES
+// Sensor task only. One window at a time: a trigger while it is open (a retrigger
+// right after the cooldown of a short FEATURE_WINDOW_MS) is sent without features.
+struct PendingTrigger {
+    float ratio;
+    float sta;
+    int64_t sample_us;
+    uint32_t sample_index;
+};
+static FeatureExtractor featureExtractor;
+static PendingTrigger pendingTrigger;
+static bool featuresReady = false;
+#endif
 
 // --------------------------------------------------------------------------
 // CRYPTOGRAPHY SUBSYSTEM
@@ -98,6 +437,55 @@ Preferences preferences;
 mbedtls_entropy_context entropy;
 mbedtls_ctr_drbg_context ctr_drbg;
 mbedtls_pk_context pk_context;
+#if FAST_SIGN
+FastSigner fastSigner;
+#endif
+
+// Boot state. "provisioned" lives next to priv_key and is set by the first 2xx
+// answer to a signed request, i.e. once the public key is registered on the server.
+const char *const NVS_KEY_PROVISIONED = "provisioned";
+const EventBits_t BOOT_CRYPTO_READY = 1 << 0;
+EventGroupHandle_t bootEvents = NULL;
+bool provisioned = false;
+
+/**
+ * @brief Reads the provisioned flag. Called in setup() before any task touches NVS.
+ */
+static bool loadProvisioned() {
+    Preferences prefs;
+    if (!prefs.begin("quake-keys", true)) return false; // Namespace absent on first boot
+    bool flag = prefs.isKey("priv_key") && prefs.getBool(NVS_KEY_PROVISIONED, false);
+    prefs.end();
+    return flag;
+}
+
+/**
+ * @brief Tracks whether the server knows our key, from the status of a signed request.
+ * 2xx marks the node provisioned; 403 (key not registered) clears it, so the next
+ * boot shows the countdown again. NVS is only written when the state changes.
+ */
+static void noteServerStatus(int status) {
+    bool accepted = status >= 200 && status < 300;
+    if (!accepted && status != 403) return;
+    if (accepted == provisioned) return;
+    provisioned = accepted;
+    preferences.putBool(NVS_KEY_PROVISIONED, accepted);
+    Serial.printf("[SEC] Provisioned flag %s (HTTP %d).\n", accepted ? "set" : "cleared", status);
+}
+
+/**
+ * @brief Blocks the calling task until initCrypto() has completed.
+ */
+static void waitCryptoReady() {
+    xEventGroupWaitBits(bootEvents, BOOT_CRYPTO_READY, pdFALSE, pdTRUE, portMAX_DELAY);
+}
+
+/**
+ * @brief Milliseconds since the application started (esp_timer starts at boot).
+ */
+static unsigned long bootMillis() {
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
 
 /**
  * @brief Initializes MbedTLS context and manages Device Identity.
@@ -147,280 +535,1991 @@ void initCrypto() {
 }
 
 /**
- * @brief Signs a payload string using the device's Private Key.
- * @param message Input string to sign.
- * @return Hexadecimal string of the ECDSA signature.
+ * @brief Signs a payload using the device's Private Key.
+ * Allocation-free: the hex signature is written into a caller-owned buffer.
+ * @param message Canonical message bytes to sign.
+ * @param len Message length.
+ * @param hexOut Destination for the NUL-terminated hex signature.
+ * @param hexSize Size of hexOut (SIG_HEX_SIZE covers any DER signature).
+ * @return Number of hex characters written (0 on failure).
  */
-String signMessage(String message) {
+size_t signMessage(const char *message, size_t len, char *hexOut, size_t hexSize) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
     unsigned char hash[32];
     unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
     size_t sig_len = 0;
 
-    // SHA-256 Hashing
-    mbedtls_md_context_t ctx;
-    mbedtls_md_init(&ctx);
-    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
-    mbedtls_md_starts(&ctx);
-    mbedtls_md_update(&ctx, (const unsigned char*)message.c_str(), message.length());
-    mbedtls_md_finish(&ctx, hash);
-    mbedtls_md_free(&ctx);
+    // SHA-256 Hashing (one-shot: no md context allocation)
+    const int64_t t0 = esp_timer_get_time();
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), (const unsigned char*)message, len, hash);
 
     // ECDSA Signing
-    mbedtls_pk_sign(&pk_context, MBEDTLS_MD_SHA256, hash, 0, sig, &sig_len, mbedtls_ctr_drbg_random, &ctr_drbg);
+#if FAST_SIGN
+    if (fastSigner.ready()) {
+        sig_len = fastSigner.signDer(hash, sig, sizeof(sig), NULL);
+    } else
+#endif
+    if (mbedtls_pk_sign(&pk_context, MBEDTLS_MD_SHA256, hash, 0, sig, &sig_len, mbedtls_ctr_drbg_random, &ctr_drbg) != 0) {
+        sig_len = 0;
+    }
+    metrics.noteSignUs((uint32_t)(esp_timer_get_time() - t0));
+    if (sig_len == 0 || hexSize < 2 * sig_len + 1) {
+        metrics.noteSignFailure();
+        if (hexSize > 0) hexOut[0] = '\0';
+        return 0;
+    }
 
     // Hex Encoding
-    String hexSig = "";
     for(size_t i = 0; i < sig_len; i++) {
-        char buf[3];
-        sprintf(buf, "%02x", sig[i]);
-        hexSig += buf;
+        hexOut[2 * i]     = HEX_DIGITS[sig[i] >> 4];
+        hexOut[2 * i + 1] = HEX_DIGITS[sig[i] & 0x0F];
     }
-    return hexSig;
+    hexOut[2 * sig_len] = '\0';
+    return 2 * sig_len;
 }
 
-// --------------------------------------------------------------------------
-// TASK: SENSOR ACQUISITION & PROCESSING
-// --------------------------------------------------------------------------
-void sensorTask(void *pvParameters) {
-    float lta = 0.0f;
-    float sta = 0.0f;
-    float prev_raw_mag = 9.81f; // Assumes 1G start
-    float filtered_mag = 0.0f;
-    sensors_event_t event;
-    
-    // Block until the sensor object is allocated in setup()
-    while (accel == NULL) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
+#if SIGN_BENCHMARK
+/**
+ * @brief Boot-time sign latency report.
+ * Compares the legacy mbedtls_pk_sign() path with the fast-sign paths and
+ * checks that a pool signature verifies. Leaves the pre-signature pool full.
+ */
+static void runSignBenchmark() {
+    static const char msg[] = "123:1700000000";
+    unsigned char hash[32];
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    size_t sig_len = 0;
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), (const unsigned char *)msg, strlen(msg), hash);
 
-    Serial.println("[SENSOR] Task Active. Beginning Stabilization Phase...");
+#if defined(CONFIG_MBEDTLS_HARDWARE_SHA) && defined(CONFIG_MBEDTLS_HARDWARE_MPI)
+    Serial.println("[BENCH] mbedtls accelerators: SHA=hw MPI=hw");
+#else
+    Serial.println("[BENCH] mbedtls accelerators: not all enabled in sdkconfig");
+#endif
 
-    // Initial Stabilization Loop (Populate Filters)
-    for(int i=0; i<20; i++) { 
-        if(accel->getEvent(&event)) { 
-             float mag = sqrt(pow(event.acceleration.x, 2) + pow(event.acceleration.y, 2) + pow(event.acceleration.z, 2));
-             lta = mag; 
-             sta = mag; 
-             prev_raw_mag = mag;
-        }
-        vTaskDelay(pdMS_TO_TICKS(50)); 
-    }
-    Serial.println("[SENSOR] Ready for detection.");
+    uint32_t t0 = micros();
+    mbedtls_pk_sign(&pk_context, MBEDTLS_MD_SHA256, hash, 0, sig, &sig_len, mbedtls_ctr_drbg_random, &ctr_drbg);
+    uint32_t legacyUs = micros() - t0;
+    Serial.printf("[BENCH] Sign mbedtls_pk_sign:  %lu us\n", (unsigned long)legacyUs);
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xFrequency = pdMS_TO_TICKS(10); // 100Hz Sampling Rate
-    bool inAlarm = false;
-    unsigned long alarmStart = 0;
+#if FAST_SIGN
+    if (!fastSigner.ready()) return;
+    bool fromPool = false;
+    t0 = micros();
+    fastSigner.signDer(hash, sig, sizeof(sig), &fromPool); // Pool still empty: RFC 6979 path
+    uint32_t detUs = micros() - t0;
 
-    for(;;) {
-        // Enforce strict timing
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
-        
-        // Retrieve Data (Access via pointer)
-        if (!accel->getEvent(&event)) {
-            continue; 
-        }
+    t0 = micros();
+    size_t added = fastSigner.refill();
+    uint32_t presignUs = added > 0 ? (micros() - t0) / added : 0;
 
-        float raw_mag = sqrt(pow(event.acceleration.x, 2) + pow(event.acceleration.y, 2) + pow(event.acceleration.z, 2));
+    t0 = micros();
+    sig_len = fastSigner.signDer(hash, sig, sizeof(sig), &fromPool);
+    uint32_t poolUs = micros() - t0;
+    fastSigner.refill(); // Top the pool back up before the tasks start
 
-        // --- SIGNAL DROPOUT PROTECTION ---
-        // If magnitude drops below 2.0 m/s^2 (~0.2G), it indicates a wiring failure or I2C bus error.
-        // We discard this frame to prevent the High Pass Filter from creating a false spike.
-        if (raw_mag < 2.0f) {
-            continue; 
-        }
-        
-        // Digital High Pass Filter (Removes Gravity component)
-        filtered_mag = 0.9f * (filtered_mag + raw_mag - prev_raw_mag);
-        prev_raw_mag = raw_mag;
-        float abs_signal = abs(filtered_mag);
+    bool ok = sig_len > 0 &&
+              mbedtls_pk_verify(&pk_context, MBEDTLS_MD_SHA256, hash, 0, sig, sig_len) == 0;
+    Serial.printf("[BENCH] Sign RFC 6979:         %lu us\n", (unsigned long)detUs);
+    Serial.printf("[BENCH] Pre-signature (idle):  %lu us each\n", (unsigned long)presignUs);
+    Serial.printf("[BENCH] Sign from pool:        %lu us (%s, verify %s)\n", (unsigned long)poolUs,
+                  fromPool ? "pool" : "fallback", ok ? "OK" : "FAILED");
+#endif
+}
+#endif
 
-        // --- NOISE GATE ---
-        // Zero out signals below the hardware noise floor to prevent STA/LTA drift.
-        if (abs_signal < NOISE_FLOOR) {
-            abs_signal = 0.0f;
-        }
+/**
+ * @brief Loads the device key and starts the signers, then releases the tasks
+ * waiting in waitCryptoReady().
+ * @param benchmark Run SIGN_BENCHMARK (provisioning boots only).
+ */
+static void startSecurity(bool benchmark) {
+    initCrypto();
+#if FAST_SIGN
+    if (!fastSigner.begin(&pk_context, mbedtls_ctr_drbg_random, &ctr_drbg)) {
+        Serial.println("[SEC] Fast signer unavailable, using mbedtls_pk_sign.");
+    }
+#endif
+#if SIGN_BENCHMARK
+    if (benchmark) runSignBenchmark();
+#endif
+#if FAST_SIGN
+    if (fastSigner.ready()) {
+        // Idle priority: nonces are precomputed only when nothing else needs the CPU
+        monitor.spawn(SIGN_TASK_SPEC, FastSigner::presignTask, &fastSigner);
+    }
+#endif
+    xEventGroupSetBits(bootEvents, BOOT_CRYPTO_READY);
+}
 
-        // STA/LTA Algorithm Update
-        lta = (ALPHA_LTA * abs_signal) + ((1.0f - ALPHA_LTA) * lta);
-        sta = (ALPHA_STA * abs_signal) + ((1.0f - ALPHA_STA) * sta);
-        
-        // Safety floor for LTA to avoid division by zero or extreme ratios
-        if (lta < 0.05f) lta = 0.05f; 
-        
-        float ratio = sta / lta;
+/**
+ * @brief Fast boot: key loading runs here while the sensor arms and Wi-Fi associates.
+ */
+void cryptoTask(void *pvParameters) {
+    startSecurity(false);
+    Serial.printf("[BOOT] Crypto ready %lu ms after boot.\n", bootMillis());
+    vTaskDelete(NULL);
+}
 
-        // TRIGGER LOGIC
-        // Condition 1: Ratio exceeds threshold.
-        // Condition 2: Actual signal intensity exceeds noise floor (Real event verification).
-        if (ratio >= TRIGGER_RATIO && sta > NOISE_FLOOR && !inAlarm) {
-            Serial.printf("[SENSOR] EARTHQUAKE DETECTED! Ratio: %.2f (Mag: %.3f G)\n", ratio, sta);
-            
-            SeismicEvent evt; 
-            evt.magnitude = ratio; 
-            evt.event_millis = millis();
-            xQueueSend(eventQueue, &evt, 0);
-            
-            inAlarm = true; 
-            alarmStart = millis();
-        }
+/**
+ * @brief Signs a binary message and returns the raw r||s signature.
+ * Used by the binary wire format, which carries no DER framing.
+ * @return true on success.
+ */
+bool signMessageRaw(const uint8_t *message, size_t len, uint8_t rs[2 * ECDSA_P256_BYTES]) {
+    unsigned char hash[32];
+    const int64_t t0 = esp_timer_get_time();
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), message, len, hash);
 
-        // Alarm Cooldown (5 Seconds)
-        if (inAlarm && (millis() - alarmStart > 5000)) {
-            inAlarm = false;
-        }
+#if FAST_SIGN
+    if (fastSigner.ready()) {
+        bool signedFast = fastSigner.signRaw(hash, rs, NULL) == 0;
+        metrics.noteSignUs((uint32_t)(esp_timer_get_time() - t0));
+        if (!signedFast) metrics.noteSignFailure();
+        return signedFast;
     }
+#endif
+    mbedtls_ecp_keypair *kp = mbedtls_pk_ec(pk_context);
+    mbedtls_mpi r, s;
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    bool ok = mbedtls_ecdsa_sign(&kp->grp, &r, &s, &kp->d, hash, sizeof(hash),
+                                 mbedtls_ctr_drbg_random, &ctr_drbg) == 0 &&
+              mbedtls_mpi_write_binary(&r, rs, ECDSA_P256_BYTES) == 0 &&
+              mbedtls_mpi_write_binary(&s, rs + ECDSA_P256_BYTES, ECDSA_P256_BYTES) == 0;
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    metrics.noteSignUs((uint32_t)(esp_timer_get_time() - t0));
+    if (!ok) metrics.noteSignFailure();
+    return ok;
 }
 
 // --------------------------------------------------------------------------
-// TASK: NETWORK DISPATCHER
+// TASK: SENSOR ACQUISITION & PROCESSING
 // --------------------------------------------------------------------------
-void networkTask(void *pvParameters) {
-    WiFiClient client;
-    
-    Serial.printf("[NET] Connecting to Access Point: %s\n", WIFI_SSID_CONF);
-    WiFi.begin(WIFI_SSID_CONF, WIFI_PASS_CONF);
-    
-    while (WiFi.status() != WL_CONNECTED) {
-        vTaskDelay(pdMS_TO_TICKS(500));
-        Serial.print(".");
+
+/**
+ * @brief Logs a trigger and hands it to the network task.
+ * @param ratio STA/LTA ratio at trigger time.
+ * @param sta Short Term Average at trigger time.
+ * @param sample_us esp_timer time at which the sensor latched the sample.
+ * @param sample_index Sensor sample counter of the trigger sample.
+ * @param features Features of the trigger window, NULL if none were computed.
+ */
+static void queueTrigger(float ratio, float sta, int64_t sample_us, uint32_t sample_index,
+                         const EventFeatures *features) {
+    Serial.printf("[SENSOR] EARTHQUAKE DETECTED! Ratio: %.2f (Mag: %.3f G) | Sample #%lu\n",
+                  ratio, sta, (unsigned long)sample_index);
+
+    SeismicEvent evt;
+    evt.magnitude = ratio;
+    evt.event_us = sample_us;
+    evt.sample_index = sample_index;
+    evt.seq = 0;
+    evt.features = features != NULL ? *features : EventFeatures();
+    if (features != NULL) {
+        Serial.printf("[SENSOR] Features: %s | %u Hz | %u ms above the trigger level | PGA %lu mm/s^2\n",
+                      eventClassName(features->event_class), features->dominant_hz, features->duration_ms,
+                      (unsigned long)features->pga_mms2);
+    }
+    // Converted now with the current anchor; 0 (clock not set) is resolved at send time
+    evt.device_time_us = timebase.toUnixUs(sample_us);
+#if EVENT_JOURNAL
+    // Journaled before the queue: a dropped or unsent trigger is replayed from flash
+    evt.seq = journal.append(ratio, (uint32_t)(sample_us / 1000), evt.device_time_us, sample_index);
+#endif
+    if (xQueueSend(eventQueue, &evt, 0) != pdTRUE) {
+        metrics.noteQueueDrop();
+        Serial.println("[SENSOR] Event queue full. Trigger dropped.");
     }
-    Serial.println("\n[NET] WiFi Connected.");
 
-    // NTP Time Synchronization (Critical for signature validity)
-    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+#if WAVEFORM_CAPTURE
+    // The alert above goes out on its own; the waveform follows in the background.
+    // Samples recorded since the trigger: 0 when polling, more in a block or after a feature window.
+    if (!capture.trigger(sampleCounter - 1 - sample_index, (uint32_t)(sample_us / 1000))) {
+        Serial.println("[CAPTURE] Previous window still uploading. Waveform skipped.");
+    }
+#endif
+}
 
-    SeismicEvent receivedEvt;
-    for(;;) {
-        // Block until event is received from Sensor Task
-        if (xQueueReceive(eventQueue, &receivedEvt, portMAX_DELAY) == pdTRUE) {
-            
-            // Connection Watchdog
-            if (WiFi.status() != WL_CONNECTED) { 
-                WiFi.disconnect(); 
-                WiFi.reconnect(); 
-                vTaskDelay(pdMS_TO_TICKS(1000));
-                continue; 
-            }
-            
-            // Timestamp Reconstruction
-            time_t now_unix; 
-            time(&now_unix);
-            unsigned long age_ms = millis() - receivedEvt.event_millis;
-            time_t evt_time = now_unix - (age_ms / 1000);
-            
-            // Payload Construction
-            int val = (int)(receivedEvt.magnitude * 100);
-            String payload = String(val) + ":" + String(evt_time);
-            
-            // Cryptographic Signing
-            String sig = signMessage(payload);
-
-            // JSON Serialization
-            JsonDocument doc;
-            doc["value"] = val; 
-            doc["misurator_id"] = SENSOR_ID_CONF;
-            doc["device_timestamp"] = evt_time; 
-            doc["signature_hex"] = sig;
-            String json; 
-            serializeJson(doc, json);
-
-            // HTTP POST Transmission
-            Serial.println("[NET] Transmitting Event to Server...");
-            if (client.connect(SERVER_HOST_CONF, SERVER_PORT_CONF)) {
-                client.println(String("POST ") + SERVER_PATH_CONF + " HTTP/1.1");
-                client.println(String("Host: ") + SERVER_HOST_CONF);
-                client.println("Content-Type: application/json");
-                client.print("Content-Length: "); client.println(json.length());
-                client.println("Connection: close"); 
-                client.println();
-                client.println(json);
-                
-                // Flush Response Buffer
-                while(client.connected() || client.available()) { 
-                    if(client.available()) client.readStringUntil('\n'); 
-                }
-                client.stop();
-                Serial.println("[NET] Transmission Successful.");
-            } else {
-                Serial.println("[NET] Connection Failed.");
-            }
-        }
+/**
+ * @brief Swaps in a configuration the network task staged. Sensor task only,
+ * between two blocks (or samples when polling).
+ */
+static inline void takeRemoteConfig() {
+#if REMOTE_CONFIG
+    if (configSwap.take(remoteParams)) remoteParamsActive = true;
+#endif
+}
+
+/**
+ * @brief Entry point of every detector path. With EVENT_FEATURES the trigger is
+ * held until its feature window completes (featureBlock()).
+ */
+static void onTrigger(float ratio, float sta, int64_t sample_us, uint32_t sample_index) {
+    metrics.noteTrigger();
+#if EVENT_FEATURES
+    // STA at the trigger sample is the trigger level (LTA x trigger ratio)
+    if (featuresReady && featureBegin(featureExtractor, sample_index, sta)) {
+        pendingTrigger.ratio = ratio;
+        pendingTrigger.sta = sta;
+        pendingTrigger.sample_us = sample_us;
+        pendingTrigger.sample_index = sample_index;
+        return;
     }
+#endif
+    queueTrigger(ratio, sta, sample_us, sample_index, NULL);
 }
 
-// --------------------------------------------------------------------------
-// SYSTEM INITIALIZATION
-// --------------------------------------------------------------------------
-void setup() {
-    Serial.begin(115200);
-    // Wait for the Serial Monitor to initialize
-    while(!Serial) delay(10); 
-    delay(2000); 
+/**
+ * @brief Feeds the feature extractor after the block went through the detector,
+ * and releases (or suppresses) the held trigger once its window is complete.
+ * @param first_index Sample counter of block[0].
+ */
+static void featureBlock(const RawSample *block, size_t count, uint32_t first_index) {
+#if EVENT_FEATURES
+    if (!featuresReady || !featureFeed(featureExtractor, block, count, first_index)) return;
+    EventFeatures f;
+    featureResult(featureExtractor, f);
+    const PendingTrigger &t = pendingTrigger;
+#if FEATURE_SUPPRESS
+    if (f.event_class == EVENT_CLASS_IMPULSIVE) {
+        metrics.noteSuppressed();
+        Serial.printf("[SENSOR] Trigger #%lu suppressed: impulsive (%u ms above the trigger level, PGA %lu mm/s^2).\n",
+                      (unsigned long)t.sample_index, f.duration_ms, (unsigned long)f.pga_mms2);
+        return;
+    }
+#endif
+    queueTrigger(t.ratio, t.sta, t.sample_us, t.sample_index, &f);
+#else
+    (void)block;
+    (void)count;
+    (void)first_index;
+#endif
+}
 
-    Serial.println("\n\n==================================================");
-    Serial.println("[BOOT] QuakeGuard Security System First...");
-    Serial.println("==================================================");
+static void processSample(DetectorState &st, float raw_mag, int64_t sample_us, uint32_t sample_index) {
+    float ratio;
+    takeRemoteConfig();
+    const bool fired = remoteParamsActive ? detectorStepT(remoteParams.f, st, raw_mag, &ratio)
+                                          : detectorStepT(DETECTOR_PARAMS, st, raw_mag, &ratio);
+    if (fired) {
+        onTrigger(ratio, st.sta, sample_us, sample_index);
+    }
+}
 
-    // 1. INITIALIZE CRYPTO SUBSYSTEM & DISPLAY KEY (PRIORITY OVER SENSOR)
-    initCrypto();
+#if DSP_BENCHMARK
+/**
+ * @brief Measures the per-sample cost of the float reference path, the float
+ * block kernels, the fixed-point block path and the detector bank on a
+ * synthetic signal (1G on Z plus noise).
+ * Results are printed in CPU cycles/sample next to the budget at SENSOR_ODR_HZ.
+ */
+static void runDspBenchmark() {
+    const size_t BLOCKS = 64;
+    static RawSample block[DSP_MAX_BLOCK];
 
-    Serial.println("\n⚠️  WARNING: You have 10 seconds to copy the Public Key above!");
-    Serial.println("    Register it in the server database to prevent 403 Forbidden errors.");
-    Serial.println("    Sensor initialization will commence shortly...");
-    
-    // Visual Countdown
-    for(int i=10; i>0; i--) {
-        Serial.printf(" %d...", i);
-        delay(1000);
+    uint32_t lcg = 12345;
+    for (size_t i = 0; i < DSP_MAX_BLOCK; i++) {
+        lcg = lcg * 1664525UL + 1013904223UL;
+        block[i].x = (int16_t)((lcg >> 24) & 0x07) - 4;
+        block[i].y = (int16_t)((lcg >> 16) & 0x07) - 4;
+        block[i].z = 250 + (int16_t)((lcg >> 8) & 0x07) - 4;
     }
-    Serial.println("\n\n[BOOT] Starting Hardware Initialization...");
 
-    // 2. HARDWARE INIT (I2C PINS 7 & 8)
-    Serial.printf("[HARDWARE] Configuring I2C Bus on SDA=%d, SCL=%d\n", I2C_SDA_PIN, I2C_SCL_PIN);
-    
-    // Bus Recovery Sequence: Manually toggles pins to unlatch the sensor 
-    // if it is stuck in a "zombie" state holding the line low.
-    pinMode(I2C_SDA_PIN, INPUT_PULLUP);
-    pinMode(I2C_SCL_PIN, INPUT_PULLUP);
-    digitalWrite(I2C_SDA_PIN, HIGH);
-    digitalWrite(I2C_SCL_PIN, HIGH);
-    delay(50);
-    
-    Wire.end(); 
-    Wire.setPins(I2C_SDA_PIN, I2C_SCL_PIN);
-    Wire.begin();
-    Wire.setClock(10000); // 10kHz stability clock
-    delay(100); 
+    // Float reference: sqrt(pow()) + float STA/LTA per sample
+    DetectorState ref;
+    detectorInit(ref, 9.81f);
+    volatile float sink = 0.0f;
+    uint32_t t0 = ESP.getCycleCount();
+    for (size_t b = 0; b < BLOCKS; b++) {
+        for (size_t i = 0; i < DSP_MAX_BLOCK; i++) {
+            float x = block[i].x * ADXL345_LSB_TO_MS2;
+            float y = block[i].y * ADXL345_LSB_TO_MS2;
+            float z = block[i].z * ADXL345_LSB_TO_MS2;
+            float ratio;
+            detectorStepT(DETECTOR_PARAMS, ref, sqrt(pow(x, 2) + pow(y, 2) + pow(z, 2)), &ratio);
+            sink = ratio;
+        }
+    }
+    uint32_t floatCycles = ESP.getCycleCount() - t0;
 
-    // 3. DYNAMIC MEMORY ALLOCATION
-    Serial.println("[HARDWARE] Allocating Sensor Object...");
-    if (accel != NULL) delete accel;
-    accel = new Adafruit_ADXL345_Unified(12345);
+    // Float block kernels (dsp_block.h): same detector, pass-structured
+    detectorInit(ref, 9.81f);
+    BlockTrigger btrig;
+    t0 = ESP.getCycleCount();
+    for (size_t b = 0; b < BLOCKS; b++) {
+        detectorProcessBlockT(DETECTOR_PARAMS, ref, block, DSP_MAX_BLOCK, &btrig, 1);
+    }
+    uint32_t blockCycles = ESP.getCycleCount() - t0;
 
-    // 4. SENSOR STARTUP
-    if(!accel->begin(0x53)) {
-        Serial.println("[WARN] Not found at 0x53. Trying 0x1D...");
-        if(!accel->begin(0x1D)) {
-            Serial.println("[FATAL] Sensor Check Failed. (Did you copy the key?)");
-            // We do not block execution in an infinite loop here, otherwise the Key 
-            // would scroll off-screen. The sensorTask will handle hardware absence gracefully.
+    // Fixed-point block path
+    FixedDetector det;
+    fixedDetectorInit(det, ActiveFixedParams::runtime(), 9.81f);
+    FixedTrigger trig;
+    t0 = ESP.getCycleCount();
+    for (size_t b = 0; b < BLOCKS; b++) {
+        fixedProcessBlockT(FIXED_PARAMS, det, block, DSP_MAX_BLOCK, &trig);
+    }
+    uint32_t fixedCycles = ESP.getCycleCount() - t0;
+    (void)sink;
+
+    // Multi-band bank, default 4-channel profile
+    static DetectorBank bank;
+    bankInit(bank, bankDefaultConfig(), SENSOR_ODR_HZ, 9.81f);
+    BankTrigger bankTrig;
+    t0 = ESP.getCycleCount();
+    for (size_t b = 0; b < BLOCKS; b++) {
+        bankProcessBlock(bank, block, DSP_MAX_BLOCK, &bankTrig, 1);
+    }
+    uint32_t bankCycles = ESP.getCycleCount() - t0;
+
+    const uint32_t samples = BLOCKS * DSP_MAX_BLOCK;
+    const uint32_t budget = (ESP.getCpuFreqMHz() * 1000000UL) / SENSOR_ODR_HZ;
+    Serial.printf("[BENCH] DSP float sqrt(pow) path: %lu cycles/sample\n", (unsigned long)(floatCycles / samples));
+    Serial.printf("[BENCH] DSP float block (%s):  %lu cycles/sample\n", dspBlockKernel(), (unsigned long)(blockCycles / samples));
+    Serial.printf("[BENCH] DSP Q15 block path:       %lu cycles/sample\n", (unsigned long)(fixedCycles / samples));
+    Serial.printf("[BENCH] DSP bank %u channels:       %lu cycles/sample (%.2f%% CPU at %d Hz)\n",
+                  (unsigned)bankDefaultConfig().channels, (unsigned long)(bankCycles / samples),
+                  100.0f * (bankCycles / samples) / budget, SENSOR_ODR_HZ);
+    Serial.printf("[BENCH] Budget at %d Hz:          %lu cycles/sample\n", SENSOR_ODR_HZ, (unsigned long)budget);
+}
+#endif
+
+#if BUS_BENCHMARK
+const int BUS_BENCH_BLOCKS = 8;
+
+/**
+ * @brief Average time of one FIFO_WATERMARK-entry burst in µs (0 = no answer).
+ */
+static uint32_t timeBurst(Adxl345Fifo &dev) {
+    RawSample sample;
+    const int64_t start = esp_timer_get_time();
+    for (int b = 0; b < BUS_BENCH_BLOCKS; b++) {
+        for (int i = 0; i < FIFO_WATERMARK; i++) {
+            if (!dev.readSample(sample)) return 0;
         }
-    } else {
-        accel->setDataRate(ADXL345_DATARATE_100_HZ);
-        accel->setRange(ADXL345_RANGE_16_G);
-        Serial.println("[SYS] Sensor OK.");
     }
+    return (uint32_t)((esp_timer_get_time() - start) / BUS_BENCH_BLOCKS);
+}
+
+static void printBurst(const char *bus, uint32_t hz, uint32_t us) {
+    if (us == 0) {
+        Serial.printf("[BENCH] Bus %s %5lu kHz: no answer\n", bus, (unsigned long)(hz / 1000));
+        return;
+    }
+    Serial.printf("[BENCH] Bus %s %5lu kHz: %7lu us/burst (%lu us/entry, %.1f%% of a block period)\n", bus,
+                  (unsigned long)(hz / 1000), (unsigned long)us, (unsigned long)(us / FIFO_WATERMARK),
+                  100.0f * us / (FIFO_WATERMARK * SAMPLE_PERIOD_US));
+}
 
-    // 5. TASK CREATION
-    eventQueue = xQueueCreate(20, sizeof(SeismicEvent));
-    xTaskCreate(sensorTask, "SensorTask", 4096, NULL, 5, NULL);
-    xTaskCreate(networkTask, "NetworkTask", 8192, NULL, 1, NULL);
+/**
+ * @brief Times a FIFO_WATERMARK-entry burst read over I2C and over SPI.
+ * Needs the SPI wiring: with CS high the ADXL345 answers I2C on SCL/SDA, with
+ * CS low SPI on the same two wires plus SDO. Only the data registers are read
+ * (the sensor is not configured yet), so each read is a full-size burst.
+ */
+static void runBusBenchmark() {
+    static const uint32_t I2C_CLOCKS[] = { 10000, 100000, 400000 };
+    static const uint32_t SPI_CLOCKS[] = { 1000000, 2000000, 5000000 };
+    static const uint8_t ADDRESSES[] = { 0x53, 0x1D };
+    Adxl345Fifo dev; // Transport only: no FIFO setup, no interrupt
+
+    Serial.printf("[BENCH] Bus: %d-entry FIFO burst, average of %d\n", FIFO_WATERMARK, BUS_BENCH_BLOCKS);
+    pinMode(SENSOR_SPI_CS_PIN, OUTPUT);
+    digitalWrite(SENSOR_SPI_CS_PIN, HIGH); // I2C interface selected
+    Wire.setPins(I2C_SDA_PIN, I2C_SCL_PIN);
+    Wire.begin();
+    Wire.setTimeOut(I2C_TIMEOUT_MS);
+    bool found = false;
+    for (size_t a = 0; a < sizeof(ADDRESSES) && !found; a++) {
+        dev.attach(Wire, ADDRESSES[a]);
+        found = dev.identify();
+    }
+    for (size_t i = 0; i < sizeof(I2C_CLOCKS) / sizeof(I2C_CLOCKS[0]); i++) {
+        Wire.setClock(I2C_CLOCKS[i]);
+        printBurst("I2C", I2C_CLOCKS[i], found ? timeBurst(dev) : 0);
+    }
+    Wire.end();
+
+    SPI.begin(SENSOR_SPI_SCK_PIN, SENSOR_SPI_MISO_PIN, SENSOR_SPI_MOSI_PIN, -1);
+    for (size_t i = 0; i < sizeof(SPI_CLOCKS) / sizeof(SPI_CLOCKS[0]); i++) {
+        dev.attach(SPI, SENSOR_SPI_CS_PIN, SPI_CLOCKS[i]);
+        printBurst("SPI", SPI_CLOCKS[i], dev.identify() ? timeBurst(dev) : 0);
+    }
+    SPI.end();
+    digitalWrite(SENSOR_SPI_CS_PIN, HIGH);
+}
+#endif
+
+#if CODEC_BENCHMARK
+/**
+ * @brief Reports delta/varint size and encode cost for a quiet and a shaking
+ * synthetic signal (1 s at 400 Hz, raw counts).
+ */
+static void runCodecBenchmark() {
+    const size_t N = 400;
+    static RawSample signal[N];
+    static uint8_t out[N * DELTA_MAX_SAMPLE_BYTES];
+    static const char *const names[] = {"quiet", "shaking"};
+
+    for (int pass = 0; pass < 2; pass++) {
+        uint32_t lcg = 12345;
+        for (size_t i = 0; i < N; i++) {
+            lcg = lcg * 1664525UL + 1013904223UL;
+            int16_t noise = (int16_t)((lcg >> 24) & 0x07) - 4;
+            // Shaking: ~4G at 10 Hz on X/Y, ~2G on Z, plus wider noise
+            float w = 2.0f * PI * 10.0f * i / N;
+            int16_t shake = pass == 1 ? (int16_t)(1000.0f * sinf(w)) : 0;
+            if (pass == 1) noise *= 4;
+            signal[i].x = shake + noise;
+            signal[i].y = (int16_t)(pass == 1 ? 1000.0f * cosf(w) : 0) - noise;
+            signal[i].z = 250 + shake / 2 + noise;
+        }
+
+        RawSample prev = {0, 0, 0};
+        size_t consumed = 0;
+        uint32_t t0 = ESP.getCycleCount();
+        size_t bytes = deltaEncode(signal, N, prev, out, sizeof(out), &consumed);
+        uint32_t cycles = ESP.getCycleCount() - t0;
+        Serial.printf("[BENCH] Codec %-7s: %.2f bytes/sample (raw %u) | %lu cycles/sample\n",
+                      names[pass], bytes / (float)consumed, (unsigned)sizeof(RawSample),
+                      (unsigned long)(cycles / N));
+    }
+}
+#endif
+
+/**
+ * @brief Logs boot-to-armed time once, when the first acquisition loop starts.
+ */
+static void reportArmed() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    Serial.printf("[BOOT] Armed %lu ms after boot (%s boot).\n", bootMillis(),
+                  FAST_BOOT && provisioned ? "fast" : "provisioning");
+}
+
+/**
+ * @brief Counts one read's samples and feeds the bus monitor, which may
+ * recover or re-clock the bus (I2C only: SPI has no acknowledge to count
+ * and no clock ladder).
+ */
+static void noteAcquired(uint32_t samples, uint32_t dropouts) {
+    metrics.noteSamples(samples, dropouts);
+#if SENSOR_BUS == SENSOR_BUS_I2C
+    i2c.noteDropouts(dropouts);
+    i2c.service(); // Sensor registers survive a bus restart: the FIFO keeps filling
+#endif
+}
+
+#if SENSOR_BUS == SENSOR_BUS_SPI
+/**
+ * @brief Routes the sensor pins to the hardware SPI host (FIFO acquisition).
+ */
+static void sensorSpiAcquire() {
+    SPI.begin(SENSOR_SPI_SCK_PIN, SENSOR_SPI_MISO_PIN, SENSOR_SPI_MOSI_PIN, -1);
+}
+
+/**
+ * @brief Hands the pins back to GPIO for the Adafruit driver's software SPI
+ * (polled acquisition): SPI.end() leaves them as inputs.
+ */
+static void sensorSpiRelease() {
+    SPI.end();
+    pinMode(SENSOR_SPI_SCK_PIN, OUTPUT);
+    digitalWrite(SENSOR_SPI_SCK_PIN, HIGH); // Mode 3: clock idles high
+    pinMode(SENSOR_SPI_MOSI_PIN, OUTPUT);
+    pinMode(SENSOR_SPI_MISO_PIN, INPUT);
+    pinMode(SENSOR_SPI_CS_PIN, OUTPUT);
+    digitalWrite(SENSOR_SPI_CS_PIN, HIGH);
+}
+#endif
+
+/**
+ * @brief Legacy acquisition: one getEvent() transaction every 10ms.
+ */
+static void runPolledAcquisition(DetectorState &st) {
+    sensors_event_t event;
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    const TickType_t xFrequency = pdMS_TO_TICKS(SAMPLE_PERIOD_US / 1000); // 100Hz Sampling Rate
+    reportArmed();
+
+    for(;;) {
+        // Enforce strict timing
+        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+
+        // Retrieve Data (Access via pointer)
+        if (!accel->getEvent(&event)) {
+            continue;
+        }
+        // BYPASS mode: the data registers hold the newest conversion, at most one period old
+        const int64_t sample_us = esp_timer_get_time();
+
+#if WAVEFORM_STREAM || WAVEFORM_CAPTURE || EVENT_FEATURES
+        RawSample raw;
+        raw.x = (int16_t)lrintf(event.acceleration.x / ADXL345_LSB_TO_MS2);
+        raw.y = (int16_t)lrintf(event.acceleration.y / ADXL345_LSB_TO_MS2);
+        raw.z = (int16_t)lrintf(event.acceleration.z / ADXL345_LSB_TO_MS2);
+#endif
+#if WAVEFORM_CAPTURE
+        capture.push(&raw, 1);
+#endif
+
+        float raw_mag = sqrt(pow(event.acceleration.x, 2) + pow(event.acceleration.y, 2) + pow(event.acceleration.z, 2));
+        // The Adafruit driver hides transfer errors: a dead bus shows up as dropout frames
+        noteAcquired(1, raw_mag < DETECTOR_PARAMS.dropout_ms2 ? 1 : 0);
+        processSample(st, raw_mag, sample_us, sampleCounter++);
+#if EVENT_FEATURES
+        featureBlock(&raw, 1, sampleCounter - 1);
+#endif
+
+#if WAVEFORM_STREAM
+        sampleRing.write(&raw, 1);
+#endif
+    }
+}
+
+/**
+ * @brief Maps SENSOR_ODR_HZ to the ADXL345 BW_RATE code.
+ */
+static dataRate_t odrToRateCode(uint32_t hz) {
+    switch (hz) {
+        case 800: return ADXL345_DATARATE_800_HZ;
+        case 400: return ADXL345_DATARATE_400_HZ;
+        case 200: return ADXL345_DATARATE_200_HZ;
+        default:  return ADXL345_DATARATE_100_HZ;
+    }
+}
+
+/**
+ * @brief Frames of a block the detector will discard as dropouts.
+ */
+static uint32_t countDropouts(const RawSample *block, size_t count) {
+    uint32_t dropouts = 0;
+    for (size_t i = 0; i < count; i++) {
+        const int32_t x = block[i].x, y = block[i].y, z = block[i].z;
+        if ((uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z) < DROPOUT_COUNTS_SQ) dropouts++;
+    }
+    return dropouts;
+}
+
+/**
+ * @brief FIFO acquisition: the task sleeps until the ADXL345 watermark
+ * interrupt and then drains the whole FIFO in one pass.
+ * Sample spacing comes from the sensor ODR clock, not from the scheduler.
+ */
+static void runFifoAcquisition(DetectorState &st) {
+    static RawSample block[ADXL345_FIFO_DEPTH];
+
+    // Safety timeout: twice the expected block period. Keeps acquisition alive
+    // (as a slow poll) if the INT1 line is not wired or an edge is missed.
+    const TickType_t xTimeout = pdMS_TO_TICKS((2 * FIFO_WATERMARK * SAMPLE_PERIOD_US) / 1000);
+
+#if SENSOR_BUS == SENSOR_BUS_SPI
+    sensorSpiAcquire();
+    fifo.attach(SPI, SENSOR_SPI_CS_PIN, SENSOR_SPI_HZ);
+    const char *busName = "SPI";
+#else
+    fifo.attach(Wire, sensorAddress, &i2c);
+    const char *busName = "I2C";
+#endif
+    if (!fifo.begin(odrToRateCode(SENSOR_ODR_HZ), FIFO_WATERMARK, ADXL_INT1_PIN, xTaskGetCurrentTaskHandle())) {
+        Serial.println("[SENSOR] FIFO setup failed. Falling back to polled acquisition.");
+#if SENSOR_BUS == SENSOR_BUS_SPI
+        sensorSpiRelease();
+#endif
+        runPolledAcquisition(st);
+        return;
+    }
+    Serial.printf("[SENSOR] FIFO stream mode active (%d Hz, watermark %d, INT1 on GPIO %d, %s).\n",
+                  SENSOR_ODR_HZ, FIFO_WATERMARK, ADXL_INT1_PIN, busName);
+    if (power.lightSleep() && !fifo.enableWakeup()) {
+        Serial.println("[POWER] INT1 cannot wake the chip. Sensor relies on the timeout wakeup.");
+    }
+    reportArmed();
+
+#if SENSOR_HIGH_RATE
+    // Fixed-point detector seeded from the float stabilization phase
+    FixedDetector det;
+    fixedDetectorInit(det, ActiveFixedParams::runtime(), st.prev_raw_mag);
+    FixedTrigger trig;
+#endif
+#if DETECTOR_BANK
+    static DetectorBank bank;
+    const BankConfig bankCfg = bankDefaultConfig();
+    bool bankReady = bankInit(bank, bankCfg, SENSOR_ODR_HZ, st.prev_raw_mag);
+    if (bankReady) {
+        Serial.printf("[SENSOR] Detector bank: %u channels, vote %d within %.1f s.\n",
+                      (unsigned)bankCfg.channels, bankCfg.vote_threshold, bankCfg.vote_window_s);
+    } else {
+        Serial.println("[SENSOR] Detector bank config invalid at this ODR. Using the single detector.");
+    }
+#endif
+
+    for(;;) {
+        power.sensorSleep();
+        bool notified = ulTaskNotifyTake(pdTRUE, xTimeout) > 0;
+        power.sensorWake();
+
+        const int64_t drain_us = esp_timer_get_time();
+        if (notified) monitor.noteWakeLatency((uint32_t)(drain_us - fifo.watermarkUs()));
+        size_t count = fifo.drain(block, ADXL345_FIFO_DEPTH);
+        noteAcquired(count, countDropouts(block, count));
+        if (count == 0) continue;
+
+        // Entries are exactly one ODR period apart. The watermark edge dates entry
+        // FIFO_WATERMARK-1 to within the ISR latency; without an edge (timeout poll,
+        // or the FIFO was still above the watermark) the newest entry is dated at
+        // the drain start, at most one period late.
+        const int64_t period = SAMPLE_PERIOD_US;
+        int64_t first_us = drain_us - (int64_t)(count - 1) * period;
+        if (notified && count >= FIFO_WATERMARK) {
+            int64_t edge_first = fifo.watermarkUs() - (int64_t)(FIFO_WATERMARK - 1) * period;
+            int64_t newest = edge_first + (int64_t)(count - 1) * period;
+            if (newest <= drain_us + period && newest > drain_us - 2 * period) first_us = edge_first;
+        }
+        const uint32_t first_index = sampleCounter;
+        sampleCounter += count;
+
+#if WAVEFORM_STREAM
+        sampleRing.write(block, count);
+#endif
+#if WAVEFORM_CAPTURE
+        capture.push(block, count);
+#endif
+        takeRemoteConfig();
+
+#if DETECTOR_BANK
+        if (bankReady) {
+            BankTrigger bankTrig;
+            if (bankProcessBlock(bank, block, count, &bankTrig, 1) > 0) {
+                Serial.printf("[SENSOR] Bank vote: channels 0x%02x\n", bankTrig.mask);
+                onTrigger(bankTrig.ratio, bankTrig.sta, first_us + bankTrig.index * period,
+                          first_index + bankTrig.index);
+            }
+            featureBlock(block, count, first_index);
+            continue;
+        }
+#endif
+#if SENSOR_HIGH_RATE
+        const bool fired = remoteParamsActive ? fixedProcessBlockT(remoteParams.q, det, block, count, &trig)
+                                              : fixedProcessBlockT(FIXED_PARAMS, det, block, count, &trig);
+        if (fired) {
+            onTrigger(trig.ratio_q8 / 256.0f,
+                      (trig.sta_q12 / (float)(1L << DSP_EMA_FRAC_BITS)) * ADXL345_LSB_TO_MS2,
+                      first_us + trig.index * period, first_index + trig.index);
+        }
+#else
+        // A burst is far shorter than the cooldown: at most one trigger per block
+        BlockTrigger trig;
+        const size_t fired = remoteParamsActive ? detectorProcessBlockT(remoteParams.f, st, block, count, &trig, 1)
+                                                : detectorProcessBlockT(DETECTOR_PARAMS, st, block, count, &trig, 1);
+        if (fired > 0) {
+            onTrigger(trig.ratio, trig.sta, first_us + trig.index * period, first_index + trig.index);
+        }
+#endif
+        featureBlock(block, count, first_index);
+    }
+}
+
+void sensorTask(void *pvParameters) {
+    DetectorState st;
+    detectorInit(st, 9.81f); // Assumes 1G start
+    sensors_event_t event;
+    
+    // Block until the sensor object is allocated in setup()
+    while (accel == NULL) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    Serial.println("[SENSOR] Task Active. Beginning Stabilization Phase...");
+
+    // Initial Stabilization Loop (Populate Filters). On a fast boot samples are taken
+    // at the output rate: the ADXL345 needs only ~1.1 ms + 1/ODR after power-up.
+    const TickType_t xSettle = pdMS_TO_TICKS(FAST_BOOT && provisioned ? SAMPLE_PERIOD_US / 1000 + 1 : 50);
+    for(int i=0; i<20; i++) { 
+        if(accel->getEvent(&event)) { 
+             float mag = sqrt(pow(event.acceleration.x, 2) + pow(event.acceleration.y, 2) + pow(event.acceleration.z, 2));
+             detectorInit(st, mag);
+        }
+        vTaskDelay(xSettle); 
+    }
+    Serial.println("[SENSOR] Ready for detection.");
+    Serial.printf("[SENSOR] Detector profile '%s': ratio %.2f, noise floor %.3f m/s^2, alphas %.4f/%.4f.\n",
+                  ActiveProfile::name(), DETECTOR_PARAMS.trigger_ratio, DETECTOR_PARAMS.noise_floor,
+                  DETECTOR_PARAMS.alpha_lta, DETECTOR_PARAMS.alpha_sta);
+#if EVENT_FEATURES
+    featuresReady = featureInit(featureExtractor, SENSOR_ODR_HZ, FEATURE_WINDOW_MS);
+    if (featuresReady) {
+        Serial.printf("[SENSOR] Event features over %d ms, impulsive events %s.\n", FEATURE_WINDOW_MS,
+                      FEATURE_SUPPRESS ? "suppressed" : "tagged");
+    } else {
+        Serial.println("[SENSOR] No feature bin fits FEATURE_WINDOW_MS at this ODR. Triggers go out unclassified.");
+    }
+#endif
+
+#if SENSOR_FIFO_MODE
+    if (sensorFound) {
+        runFifoAcquisition(st);
+    }
+#endif
+    runPolledAcquisition(st);
+}
+
+// --------------------------------------------------------------------------
+// TASK: NETWORK DISPATCHER
+// --------------------------------------------------------------------------
+const size_t   PIPELINE_DEPTH      = 8;     // Events written back-to-back on one connection
+const uint32_t LINK_MAINTAIN_MS    = LOW_POWER ? 10000 : 1000; // Idle wakeup for background reconnects
+const uint32_t RESPONSE_TIMEOUT_MS = 5000;
+const uint32_t POWER_REPORT_MS     = 60000; // Wakeups/s and current estimate (power_manager.h)
+const uint32_t LINK_REPORT_MS      = 60000; // Reconnect and drop counters
+const uint32_t TASK_REPORT_MS      = 60000; // Stacks, CPU, queues, wake latency (task_monitor.h)
+const uint32_t BUS_REPORT_MS       = 60000; // I2C errors, recoveries and clock (i2c_bus.h)
+const uint32_t BACKLOG_POLL_MS     = 250;   // Link down: how often queued events move to the backlog
+const uint32_t FLUSH_RETRY_MIN_MS  = 1000;  // Server unreachable: back-off between flush attempts
+const uint32_t FLUSH_RETRY_MAX_MS  = 30000;
+
+// Connectivity (connectivity.h) and the events waiting for it
+Connectivity conn;
+#define EVENT_BACKLOG_SLOTS 64 // 3 KB (2 KB without EVENT_FEATURES): events held while the link or the server is down
+EventBacklog<SeismicEvent, EVENT_BACKLOG_SLOTS> backlog;
+uint32_t encodeDrops = 0;      // Events that did not fit the static transmit buffers
+uint32_t rejectDrops = 0;      // Events the server refused for good (4xx other than 408/429)
+
+// Batching: coalesce queued events into one signed multi-event payload
+#if BATCH_MODE
+const size_t   BATCH_MAX_EVENTS    = EVENT_QUEUE_LENGTH;
+const char*    SERVER_BATCH_PATH_CONF = SERVER_PATH "batch";
+#define PENDING_SLOTS BATCH_MAX_EVENTS
+#else
+#define PENDING_SLOTS PIPELINE_DEPTH
+#endif
+
+/**
+ * @brief Unix time (s) of a past millis() stamp of this boot.
+ */
+static time_t unixTimeAt(unsigned long stamp_millis) {
+    int64_t mono_us = esp_timer_get_time() - (int64_t)(unsigned long)(millis() - stamp_millis) * 1000;
+    return (time_t)(timebase.toUnixUs(mono_us) / 1000000);
+}
+
+/**
+ * @brief Unix time (µs) of a trigger: as stamped at trigger time, or converted
+ * from its esp_timer stamp now that the clock is set.
+ * 0 if the trigger happened in an earlier boot before the clock was ever set.
+ */
+static int64_t eventUnixUs(const SeismicEvent &evt) {
+    if (evt.device_time_us == EVENT_TIME_UNKNOWN) return 0;
+    if (evt.device_time_us != 0) return evt.device_time_us;
+    return timebase.toUnixUs(evt.event_us);
+}
+
+/**
+ * @brief Integer value transmitted for an event (STA/LTA ratio * 100).
+ */
+static int eventValue(const SeismicEvent &evt) {
+    return (int)(evt.magnitude * 100);
+}
+
+// --------------------------------------------------------------------------
+// STATIC TRANSMIT BUFFERS
+// --------------------------------------------------------------------------
+// The whole send path (canonical message, signature hex, JSON tree, JSON text
+// and HTTP request) runs out of these buffers, so steady-state operation does
+// not allocate from the heap and cannot fragment it over days of uptime.
+#if WIRE_BINARY
+#define WIRE_FLAGS       ((EVENT_JOURNAL ? WIRE_FLAG_SEQUENCE : 0) | (TIMESTAMP_US ? WIRE_FLAG_TIME_US : 0) | \
+                          (EVENT_FEATURES ? WIRE_FLAG_FEATURES : 0))
+#define EVENT_BODY_SIZE  WIRE_FRAME_SIZE_FLAGS(1, WIRE_FLAGS)
+#define BATCH_BODY_SIZE  WIRE_FRAME_SIZE_FLAGS(EVENT_QUEUE_LENGTH, WIRE_FLAGS)
+const char* BODY_CONTENT_TYPE = WIRE_CONTENT_TYPE;
+#else
+#define EVENT_BODY_SIZE  EVENT_JSON_SIZE
+#define BATCH_BODY_SIZE  BATCH_JSON_SIZE
+const char* BODY_CONTENT_TYPE = "application/json";
+#endif
+#define SIG_HEX_SIZE     (2 * MBEDTLS_ECDSA_MAX_LEN + 1)
+#if EVENT_FEATURES
+#define FEATURES_MSG_SIZE  64   // ":class:hz:ms:pga:ex:ey:ez" per entry
+#define FEATURES_JSON_SIZE 160  // "features" object per entry (text and arena)
+#else
+#define FEATURES_MSG_SIZE  0
+#define FEATURES_JSON_SIZE 0
+#endif
+#define MSG_BUF_SIZE     (EVENT_QUEUE_LENGTH * (44 + FEATURES_MSG_SIZE))  // "value:timestamp_us:seq;" per entry
+#define EVENT_JSON_SIZE  (320 + FEATURES_JSON_SIZE)
+#define BATCH_JSON_SIZE  (EVENT_QUEUE_LENGTH * (112 + FEATURES_JSON_SIZE) + 256)  // Entry incl. "device_timestamp_us", "seq"
+#define JSON_ARENA_SIZE  (EVENT_QUEUE_LENGTH * (160 + FEATURES_JSON_SIZE) + 512)
+
+#define HEARTBEAT_JSON_SIZE 1024 // 17 counters, histogram and a DER signature in hex
+
+static char msgBuf[MSG_BUF_SIZE];
+static char sigHexBuf[SIG_HEX_SIZE];
+static uint8_t eventBodyBufs[PIPELINE_DEPTH][EVENT_BODY_SIZE];
+#if BATCH_MODE
+static uint8_t batchBodyBuf[BATCH_BODY_SIZE];
+#endif
+alignas(8) static uint8_t jsonArenaStorage[JSON_ARENA_SIZE];
+static JsonArena jsonArena(jsonArenaStorage, sizeof(jsonArenaStorage));
+static bool signFailed = false; // Set by a builder whose 0 means "not signed", not "too large"
+
+/**
+ * @brief Prints heap statistics and the change since the previous report.
+ * A zero delta between events confirms the send path is allocation-free.
+ */
+static void reportHeap(const char *tag) {
+    static uint32_t lastFree = 0;
+    uint32_t freeNow = ESP.getFreeHeap();
+    long delta = lastFree ? (long)freeNow - (long)lastFree : 0;
+    lastFree = freeNow;
+    Serial.printf("[HEAP] %s | Free: %lu | Min-ever: %lu | Largest block: %lu | Delta: %ld | JSON arena peak: %u/%u\n",
+                  tag, (unsigned long)freeNow, (unsigned long)ESP.getMinFreeHeap(),
+                  (unsigned long)ESP.getMaxAllocHeap(), delta,
+                  (unsigned)jsonArena.peak(), (unsigned)JSON_ARENA_SIZE);
+}
+
+/**
+ * @brief Appends the signed form of an event's features,
+ * ":<class>:<dominant_hz>:<duration_ms>:<pga_mms2>:<energy_x>:<energy_y>:<energy_z>".
+ * Writes nothing for an unclassified event.
+ * @return Characters written, or -1 if they did not fit.
+ */
+static int formatFeatures(const SeismicEvent &evt, char *out, size_t outSize) {
+    const EventFeatures &f = evt.features;
+    if (f.event_class == EVENT_CLASS_NONE) return outSize > 0 ? 0 : -1;
+    int n = snprintf(out, outSize, ":%u:%u:%u:%lu:%lu:%lu:%lu", f.event_class, f.dominant_hz, f.duration_ms,
+                     (unsigned long)f.pga_mms2, (unsigned long)f.energy[0], (unsigned long)f.energy[1],
+                     (unsigned long)f.energy[2]);
+    return n >= 0 && (size_t)n < outSize ? n : -1;
+}
+
+/**
+ * @brief Appends ":<seq>" for a journaled event, so the backend's replay
+ * protection covers the sequence number. Writes nothing when seq is 0.
+ * @return Characters written, or -1 if they did not fit.
+ */
+static int formatSeq(const SeismicEvent &evt, char *out, size_t outSize) {
+    if (evt.seq == 0) return outSize > 0 ? 0 : -1;
+    int n = snprintf(out, outSize, ":%lu", (unsigned long)evt.seq);
+    return n >= 0 && (size_t)n < outSize ? n : -1;
+}
+
+/**
+ * @brief Adds the "features" object of a classified event to a JSON entry.
+ */
+static void addFeaturesJson(const SeismicEvent &evt, JsonObject features) {
+    const EventFeatures &f = evt.features;
+    features["event_class"] = f.event_class;
+    features["dominant_hz"] = f.dominant_hz;
+    features["duration_ms"] = f.duration_ms;
+    features["pga_mms2"] = f.pga_mms2;
+    JsonArray energy = features["energy"].to<JsonArray>();
+    for (int a = 0; a < 3; a++) energy.add(f.energy[a]);
+}
+
+/**
+ * @brief Builds the signed JSON body for one trigger event.
+ * @return JSON length written to out (0 if it did not fit).
+ */
+static size_t buildEventJson(const SeismicEvent &receivedEvt, char *out, size_t outSize) {
+    // Timestamp Reconstruction
+    int64_t evt_us = eventUnixUs(receivedEvt);
+    time_t evt_time = (time_t)(evt_us / 1000000);
+    
+    // Payload Construction
+    int val = eventValue(receivedEvt);
+#if TIMESTAMP_US
+    int msgLen = snprintf(msgBuf, sizeof(msgBuf), "%d:%lld", val, (long long)evt_us);
+#else
+    int msgLen = snprintf(msgBuf, sizeof(msgBuf), "%d:%ld", val, (long)evt_time);
+#endif
+    if (msgLen < 0 || (size_t)msgLen >= sizeof(msgBuf)) return 0;
+    int featLen = formatFeatures(receivedEvt, msgBuf + msgLen, sizeof(msgBuf) - msgLen);
+    if (featLen < 0) return 0;
+    msgLen += featLen;
+    int seqLen = formatSeq(receivedEvt, msgBuf + msgLen, sizeof(msgBuf) - msgLen);
+    if (seqLen < 0) return 0;
+    msgLen += seqLen;
+    
+    // Cryptographic Signing
+    if (signMessage(msgBuf, msgLen, sigHexBuf, sizeof(sigHexBuf)) == 0) {
+        signFailed = true;
+        return 0;
+    }
+
+    // JSON Serialization
+    jsonArena.reset();
+    JsonDocument doc(&jsonArena);
+    doc["value"] = val; 
+    doc["misurator_id"] = SENSOR_ID_CONF;
+    doc["device_timestamp"] = evt_time; 
+#if TIMESTAMP_US
+    doc["device_timestamp_us"] = (long long)evt_us; // Signed instead of device_timestamp
+#endif
+    if (receivedEvt.seq != 0) doc["seq"] = receivedEvt.seq; // Backend de-duplication (signed)
+    if (receivedEvt.features.event_class != EVENT_CLASS_NONE) {
+        addFeaturesJson(receivedEvt, doc["features"].to<JsonObject>());
+    }
+    doc["signature_hex"] = (const char *)sigHexBuf;
+    if (doc.overflowed() || measureJson(doc) >= outSize) return 0; // serializeJson() would truncate
+    return serializeJson(doc, out, outSize);
+}
+
+#if WIRE_BINARY
+/**
+ * @brief Builds one signed binary frame (wire_format.h) for 1..n events.
+ * The signature covers the header and entries exactly as transmitted.
+ * @return Frame length written to out (0 if it did not fit).
+ */
+static size_t buildBinaryFrame(const SeismicEvent *events, size_t count, uint8_t *out, size_t outSize) {
+    WireEntry entries[EVENT_QUEUE_LENGTH];
+    if (count > EVENT_QUEUE_LENGTH) return 0;
+    for (size_t i = 0; i < count; i++) {
+        entries[i].value = eventValue(events[i]);
+        int64_t evt_us = eventUnixUs(events[i]);
+        entries[i].device_timestamp = (uint32_t)(evt_us / 1000000);
+        entries[i].usec = (uint32_t)(evt_us % 1000000);
+        entries[i].seq = events[i].seq;
+        entries[i].features = events[i].features;
+    }
+
+    size_t signedLen = wireEncodeFrame(SENSOR_ID_CONF, entries, count, out, outSize, WIRE_FLAGS);
+    if (signedLen == 0) return 0;
+    if (!signMessageRaw(out, signedLen, out + signedLen)) {
+        signFailed = true;
+        return 0;
+    }
+    return signedLen + WIRE_SIG_SIZE;
+}
+#endif
+
+#if BATCH_MODE
+/**
+ * @brief Builds one JSON body covering several events with a single signature.
+ * Signed message: "value:timestamp;value:timestamp;..." in queue order
+ * (timestamps in µs with TIMESTAMP_US), each entry followed by its features
+ * when it has them (formatFeatures()), then by its sequence number (formatSeq()).
+ * @return JSON length written to out (0 if it did not fit).
+ */
+static size_t buildBatchJson(const SeismicEvent *events, size_t count, char *out, size_t outSize) {
+    jsonArena.reset();
+    JsonDocument doc(&jsonArena);
+    doc["misurator_id"] = SENSOR_ID_CONF;
+    JsonArray entries = doc["entries"].to<JsonArray>();
+
+    size_t msgLen = 0;
+    for (size_t i = 0; i < count; i++) {
+        int64_t evt_us = eventUnixUs(events[i]);
+        time_t evt_time = (time_t)(evt_us / 1000000);
+        int val = eventValue(events[i]);
+
+#if TIMESTAMP_US
+        int n = snprintf(msgBuf + msgLen, sizeof(msgBuf) - msgLen, "%s%d:%lld",
+                         i > 0 ? ";" : "", val, (long long)evt_us);
+#else
+        int n = snprintf(msgBuf + msgLen, sizeof(msgBuf) - msgLen, "%s%d:%ld",
+                         i > 0 ? ";" : "", val, (long)evt_time);
+#endif
+        if (n < 0 || msgLen + n >= sizeof(msgBuf)) return 0;
+        msgLen += n;
+        n = formatFeatures(events[i], msgBuf + msgLen, sizeof(msgBuf) - msgLen);
+        if (n < 0) return 0;
+        msgLen += n;
+        n = formatSeq(events[i], msgBuf + msgLen, sizeof(msgBuf) - msgLen);
+        if (n < 0) return 0;
+        msgLen += n;
+
+        JsonObject entry = entries.add<JsonObject>();
+        entry["value"] = val;
+        entry["device_timestamp"] = evt_time;
+#if TIMESTAMP_US
+        entry["device_timestamp_us"] = (long long)evt_us;
+#endif
+        if (events[i].seq != 0) entry["seq"] = events[i].seq;
+        if (events[i].features.event_class != EVENT_CLASS_NONE) {
+            addFeaturesJson(events[i], entry["features"].to<JsonObject>());
+        }
+    }
+
+    // One ECDSA signature for the whole batch
+    if (signMessage(msgBuf, msgLen, sigHexBuf, sizeof(sigHexBuf)) == 0) {
+        signFailed = true;
+        return 0;
+    }
+    doc["signature_hex"] = (const char *)sigHexBuf;
+
+    if (doc.overflowed() || measureJson(doc) >= outSize) return 0; // serializeJson() would truncate
+    return serializeJson(doc, out, outSize);
+}
+#endif
+
+#if HEARTBEAT_MS > 0
+const char* HEARTBEAT_PATH_CONF = HEARTBEAT_PATH;
+static char heartbeatBuf[HEARTBEAT_JSON_SIZE];
+
+/**
+ * @brief Builds the signed heartbeat JSON from a metrics snapshot.
+ * Signed message: "heartbeat:<misurator_id>:<device_timestamp>:" followed by
+ * the scalar fields in the order below, comma-separated, then ';' and the
+ * sign latency buckets. The backend rebuilds it from the same field list.
+ * @return JSON length written to out (0 if it did not fit).
+ */
+static size_t buildHeartbeatJson(const MetricsSnapshot &m, time_t now, char *out, size_t outSize) {
+    const struct { const char *name; uint32_t value; } fields[] = {
+        { "uptime_s", m.uptimeS },
+        { "samples", m.samples },
+        { "dropouts", m.dropouts },
+        { "triggers", m.triggers },
+        { "suppressed", m.suppressed },
+        { "queue_drops", m.queueDrops },
+        { "send_ok", m.sendOk },
+        { "send_failures", m.sendFailures },
+        { "sign_max_us", m.signMaxUs },
+        { "sign_failures", m.signFailures },
+        { "tcp_connects", m.tcpConnects },
+        { "tcp_connect_last_ms", m.tcpConnectLastMs },
+        { "tcp_connect_max_ms", m.tcpConnectMaxMs },
+        { "wifi_disconnects", m.wifiDisconnects },
+        { "wifi_reconnect_max_ms", m.wifiReconnectMaxMs },
+        { "free_heap", m.freeHeap },
+        { "min_free_heap", m.minFreeHeap },
+    };
+
+    jsonArena.reset();
+    JsonDocument doc(&jsonArena);
+    doc["misurator_id"] = SENSOR_ID_CONF;
+    doc["device_timestamp"] = (long)now;
+
+    int n = snprintf(msgBuf, sizeof(msgBuf), "heartbeat:%d:%ld:", SENSOR_ID_CONF, (long)now);
+    size_t msgLen = n > 0 ? (size_t)n : 0;
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        doc[fields[i].name] = fields[i].value;
+        n = snprintf(msgBuf + msgLen, sizeof(msgBuf) - msgLen, "%s%lu", i > 0 ? "," : "",
+                     (unsigned long)fields[i].value);
+        if (n < 0 || msgLen + n >= sizeof(msgBuf)) return 0;
+        msgLen += n;
+    }
+    JsonArray hist = doc["sign_ms_hist"].to<JsonArray>();
+    for (size_t i = 0; i < METRICS_SIGN_BUCKETS; i++) {
+        hist.add(m.signCount[i]);
+        n = snprintf(msgBuf + msgLen, sizeof(msgBuf) - msgLen, "%s%lu", i > 0 ? "," : ";",
+                     (unsigned long)m.signCount[i]);
+        if (n < 0 || msgLen + n >= sizeof(msgBuf)) return 0;
+        msgLen += n;
+    }
+
+    if (signMessage(msgBuf, msgLen, sigHexBuf, sizeof(sigHexBuf)) == 0) {
+        signFailed = true;
+        return 0;
+    }
+    doc["signature_hex"] = (const char *)sigHexBuf;
+    if (doc.overflowed() || measureJson(doc) >= outSize) return 0; // serializeJson() would truncate
+    return serializeJson(doc, out, outSize);
+}
+#endif
+
+/**
+ * @brief true for answers that will not change on a resend: 4xx except
+ * 408 (timeout) and 429 (rate limited).
+ */
+static bool isPermanentRejection(int status) {
+    return status >= 400 && status < 500 && status != 408 && status != 429;
+}
+
+/**
+ * @brief POSTs already-built bodies over the persistent link.
+ * All requests are pipelined on one connection; if the link drops mid-way
+ * the unacknowledged tail is retried once on a fresh connection. Any other
+ * non-2xx answer that is not a permanent rejection (5xx while the backend's
+ * storage is down, a proxy's 502-504, 408, 429) ends the burst: that body
+ * and the rest stay held and flushBacklog() backs off.
+ * @param trigger_millis Trigger time of the oldest event in each body (latency report).
+ * @param rejected Set to the number of done bodies the server rejected for good.
+ * @return Number of leading bodies that are done with: acknowledged (2xx)
+ *         or rejected for good.
+ */
+static size_t postPipelined(HttpLink &link, const char *path, const uint8_t *const *bodies,
+                            const size_t *lengths, const unsigned long *trigger_millis, size_t count,
+                            size_t *rejected) {
+    size_t done = 0;
+    *rejected = 0;
+    for (int attempt = 0; attempt < 2 && done < count; attempt++) {
+        if (!link.ensureConnected()) {
+            Serial.println("[NET] Connection Failed.");
+            metrics.noteSendFailures((uint32_t)(count - done));
+            return done;
+        }
+        bool reused = link.reused();
+
+        // HTTP POST Transmission (pipelined)
+        Serial.printf("[NET] Transmitting %u Request(s) to Server (%s connection)...\n",
+                      (unsigned)(count - done), reused ? "warm" : "new");
+        size_t sent = done;
+        while (sent < count && link.sendPost(path, BODY_CONTENT_TYPE, bodies[sent], lengths[sent])) {
+            sent++;
+        }
+
+        // Collect responses in request order
+        bool serverBusy = false;
+        while (done < sent) {
+            int status = link.readResponse(RESPONSE_TIMEOUT_MS);
+            if (status < 0) {
+                metrics.noteSendFailures((uint32_t)(sent - done));
+                break;
+            }
+            noteServerStatus(status);
+            bool ok = status >= 200 && status < 300;
+            metrics.noteSend(ok);
+            if (ok) {
+                Serial.printf("[NET] Request acked (HTTP %d). Trigger->ack: %lu ms\n",
+                              status, millis() - trigger_millis[done]);
+            } else if (isPermanentRejection(status)) {
+                Serial.printf("[NET] Request rejected (HTTP %d). Event(s) dropped.\n", status);
+                (*rejected)++;
+            } else {
+                Serial.printf("[NET] Server unavailable (HTTP %d). Event(s) kept for retry.\n", status);
+                metrics.noteSendFailures((uint32_t)(sent - done - 1));
+                serverBusy = true;
+                break;
+            }
+            done++;
+        }
+
+        if (done < count) {
+            // Stale keep-alive socket or protocol error: reconnect and resend the rest.
+            // Also drops the answers still in flight behind a server error.
+            link.close();
+        }
+        if (serverBusy) break; // Resending at once would hit the same error: back off
+    }
+    return done;
+}
+
+/**
+ * @brief Signs and transmits a group of drained trigger events.
+ * BATCH_MODE sends one multi-event request; otherwise one request per event, pipelined.
+ * @return Number of leading events that are done with: acknowledged, rejected
+ *         for good by the server, or dropped because they cannot be encoded.
+ *         The rest stays in the backlog.
+ */
+static size_t transmitEvents(HttpLink &link, const SeismicEvent *events, size_t count) {
+    const uint8_t *bodies[PIPELINE_DEPTH];
+    size_t lengths[PIPELINE_DEPTH];
+    unsigned long trigger_millis[PIPELINE_DEPTH];
+    size_t requests;
+    bool batched = false;
+    const char *path = SERVER_PATH_CONF;
+    signFailed = false;
+#if BATCH_MODE
+    // A batch that does not fit is retried with half the events, down to the
+    // first one on its own, so one oversized entry cannot drop the whole burst
+    size_t batchCount = count;
+    while (batchCount > 1) {
+#if WIRE_BINARY
+        lengths[0] = buildBinaryFrame(events, batchCount, batchBodyBuf, sizeof(batchBodyBuf));
+#else
+        lengths[0] = buildBatchJson(events, batchCount, (char *)batchBodyBuf, sizeof(batchBodyBuf));
+#endif
+        if (lengths[0] != 0 || signFailed) break;
+        batchCount /= 2;
+    }
+    if (batchCount < count) {
+        Serial.printf("[NET] Batch of %u exceeds static buffers. Sending %u.\n", (unsigned)count, (unsigned)batchCount);
+        count = batchCount; // The rest stays in the backlog for the next burst
+    }
+    if (count > 1) {
+        batched = true;
+        bodies[0] = batchBodyBuf;
+        trigger_millis[0] = (unsigned long)(events[0].event_us / 1000);
+        requests = 1;
+        path = SERVER_BATCH_PATH_CONF;
+    } else
+#endif
+    {
+        requests = count < PIPELINE_DEPTH ? count : PIPELINE_DEPTH;
+        for (size_t i = 0; i < requests; i++) {
+            bodies[i] = eventBodyBufs[i];
+#if WIRE_BINARY
+            lengths[i] = buildBinaryFrame(&events[i], 1, eventBodyBufs[i], EVENT_BODY_SIZE);
+#else
+            lengths[i] = buildEventJson(events[i], (char *)eventBodyBufs[i], EVENT_BODY_SIZE);
+#endif
+            trigger_millis[i] = (unsigned long)(events[i].event_us / 1000);
+        }
+    }
+
+    for (size_t i = 0; i < requests; i++) {
+        if (lengths[i] == 0) {
+            if (i > 0) {
+                requests = i; // Send what fits; the oversized or unsigned one is next in line
+                break;
+            }
+            if (signFailed) {
+                Serial.println("[SEC] Signing failed. Event(s) kept for retry.");
+                return 0;
+            }
+            // Only a single event gets here: a batch that fails to build is halved above
+            Serial.println("[NET] Payload exceeds static buffers. Event dropped.");
+            encodeDrops++;
+            return 1;
+        }
+    }
+
+    size_t rejected;
+    size_t done = postPipelined(link, path, bodies, lengths, trigger_millis, requests, &rejected);
+
+    if (done == requests && rejected == 0) {
+        Serial.printf("[NET] Transmission Successful (%u event(s)).\n", (unsigned)(batched ? count : requests));
+    } else {
+        Serial.printf("[NET] Transmission incomplete: %u/%u requests acked, %u rejected.\n",
+                      (unsigned)(done - rejected), (unsigned)requests, (unsigned)rejected);
+    }
+    reportHeap("After send");
+    // One batch request carries every event; otherwise one event per request
+    if (batched) {
+        if (rejected) rejectDrops += (uint32_t)count;
+        return done == 1 ? count : 0;
+    }
+    rejectDrops += (uint32_t)rejected;
+    return done;
+}
+
+#if HEARTBEAT_MS > 0
+/**
+ * @brief Sends one heartbeat on the persistent link and waits for its answer.
+ * Not retried: the counters are cumulative, the next heartbeat covers the gap.
+ * @return true if the backend accepted it.
+ */
+static bool sendHeartbeat(HttpLink &link) {
+    MetricsSnapshot m;
+    metrics.snapshot(m);
+    m.tcpConnects = link.connectCount();
+    m.tcpConnectLastMs = link.lastConnectMs();
+    m.tcpConnectMaxMs = link.maxConnectMs();
+    m.wifiDisconnects = conn.disconnects();
+    m.wifiReconnectMaxMs = conn.maxReconnectMs();
+
+    signFailed = false;
+    size_t len = buildHeartbeatJson(m, time(NULL), heartbeatBuf, sizeof(heartbeatBuf));
+    if (len == 0) {
+        Serial.println(signFailed ? "[METRICS] Heartbeat signing failed. Skipped."
+                                  : "[METRICS] Heartbeat exceeds its buffer. Skipped.");
+        return false;
+    }
+    if (!link.ensureConnected()) return false;
+    int status = -1;
+    if (link.sendPost(HEARTBEAT_PATH_CONF, "application/json", (const uint8_t *)heartbeatBuf, len)) {
+        status = link.readResponse(RESPONSE_TIMEOUT_MS);
+    }
+    if (status < 0) {
+        link.close();
+        Serial.println("[METRICS] Heartbeat not answered.");
+        return false;
+    }
+    noteServerStatus(status);
+    Serial.printf("[METRICS] Heartbeat HTTP %d | Samples %lu, dropouts %lu, triggers %lu (%lu suppressed), "
+                  "queue drops %lu | Sends %lu ok, %lu failed | Heap %lu (min %lu)\n",
+                  status, (unsigned long)m.samples, (unsigned long)m.dropouts, (unsigned long)m.triggers,
+                  (unsigned long)m.suppressed, (unsigned long)m.queueDrops, (unsigned long)m.sendOk, (unsigned long)m.sendFailures,
+                  (unsigned long)m.freeHeap, (unsigned long)m.minFreeHeap);
+    return status >= 200 && status < 300;
+}
+#endif
+
+#if REMOTE_CONFIG
+#define CONFIG_BODY_SIZE 384 // {"config": blob, "signature_hex": raw r||s hex}
+static char configBody[CONFIG_BODY_SIZE];
+
+/**
+ * @brief Derives both parameter forms of a configuration and stages them;
+ * the sensor task swaps them in before its next block.
+ */
+static void stageRemoteConfig(const DetectorConfig &c) {
+    const LiveDetectorParams live = detectorConfigApply(c, ActiveDetectorParams::runtime(), SENSOR_ODR_HZ);
+    // A previous hand-over is taken within one block; only a stalled sensor task waits longer
+    for (int i = 0; !configSwap.publish(live); i++) {
+        if (i == 100) {
+            Serial.println("[CONFIG] Sensor task did not take the last configuration. Applies at next boot.");
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    Serial.printf("[CONFIG] Version %lu applied: ratio %.2f, noise floor %.3f m/s^2, alphas %.4f/%.4f, "
+                  "cooldown %lu ms.\n",
+                  (unsigned long)c.version, c.trigger_ratio, c.noise_floor, c.alpha_lta, c.alpha_sta,
+                  (unsigned long)c.cooldown_ms);
+}
+
+/**
+ * @brief Asks the backend for a configuration newer than the one in use
+ * (204 if there is none) and applies it.
+ */
+static void pollRemoteConfig(HttpLink &link) {
+    char path[64];
+    snprintf(path, sizeof(path), "/misurators/%d/config?since=%lu", SENSOR_ID_CONF,
+             (unsigned long)remoteConfig.version());
+    if (!link.ensureConnected()) return;
+    int status = -1;
+    if (link.sendGet(path)) {
+        status = link.readResponse(RESPONSE_TIMEOUT_MS, configBody, sizeof(configBody));
+    }
+    if (status < 0) {
+        link.close();
+        return;
+    }
+    if (status != 200) {
+        if (status != 204) Serial.printf("[CONFIG] Poll answered HTTP %d.\n", status);
+        return;
+    }
+
+    jsonArena.reset();
+    JsonDocument doc(&jsonArena);
+    const char *why = "malformed response";
+    DetectorConfig c;
+    if (!deserializeJson(doc, configBody)) {
+        const char *blob = doc["config"].as<const char *>();
+        const char *sig = doc["signature_hex"].as<const char *>();
+        if (blob != NULL && sig != NULL && remoteConfig.accept(blob, sig, c, &why)) {
+            stageRemoteConfig(c);
+            return;
+        }
+    }
+    Serial.printf("[CONFIG] Configuration rejected: %s.\n", why);
+}
+#endif
+
+#if WAVEFORM_STREAM
+const uint32_t STREAM_FLUSH_MS      = 50;    // Max latency between ring drains
+const uint32_t STREAM_RETRY_MS      = 5000;  // Back-off between stream reconnects
+const uint32_t STREAM_CONNECT_MS    = 200;   // Keeps a dead stream host off the event path
+const uint32_t STREAM_REPORT_MS     = 10000;
+
+/**
+ * @brief Drains sampleRing to the stream socket.
+ * Each contiguous span is written straight from ring memory, then released.
+ */
+static void streamSamples(WiFiClient &stream) {
+    static uint32_t frameSeq = 0;
+    static uint32_t streamed = 0;
+    static unsigned long lastAttempt = 0;
+    static unsigned long lastReport = 0;
+
+    if (millis() - lastReport >= STREAM_REPORT_MS) {
+        lastReport = millis();
+        Serial.printf("[STREAM] Sent: %lu samples | Ring overruns: %lu | FIFO overruns: %lu | High water: %lu/%u\n",
+                      (unsigned long)streamed, (unsigned long)sampleRing.overruns(),
+                      (unsigned long)fifo.overruns(), (unsigned long)sampleRing.highWater(),
+                      (unsigned)SAMPLE_RING_SIZE);
+    }
+
+    if (!conn.linkUp()) return;
+    if (!stream.connected()) {
+        if (millis() - lastAttempt < STREAM_RETRY_MS) return;
+        lastAttempt = millis();
+        if (!stream.connect(STREAM_HOST_CONF, STREAM_PORT_CONF, STREAM_CONNECT_MS)) return;
+        stream.setNoDelay(true);
+        Serial.printf("[STREAM] Connected to %s:%d\n", STREAM_HOST_CONF, STREAM_PORT_CONF);
+    }
+
+    size_t n;
+    const RawSample *span = sampleRing.peek(n);
+    while (n > 0) {
+        StreamFrameHeader hdr;
+        hdr.magic = STREAM_MAGIC;
+        hdr.sensor_id = (uint16_t)SENSOR_ID_CONF;
+        hdr.odr_hz = (uint16_t)SENSOR_ODR_HZ;
+        hdr.seq = frameSeq;
+        hdr.dropped = sampleRing.overruns();
+        hdr.count = (uint16_t)n;
+        hdr.reserved = 0;
+
+        const size_t bytes = n * sizeof(RawSample);
+        if (stream.write((const uint8_t *)&hdr, sizeof(hdr)) != sizeof(hdr) ||
+            stream.write((const uint8_t *)span, bytes) != bytes) {
+            Serial.println("[STREAM] Write failed. Dropping connection.");
+            stream.stop();
+            return;
+        }
+        sampleRing.release(n);
+        streamed += n;
+        frameSeq++;
+        span = sampleRing.peek(n);
+    }
+}
+#endif
+
+#if WAVEFORM_CAPTURE
+// --------------------------------------------------------------------------
+// TASK: WAVEFORM UPLOAD
+// --------------------------------------------------------------------------
+// Runs below the network task, on its own connection, so a multi-chunk
+// upload never sits in front of an alert.
+const char*    WAVEFORM_PATH_CONF       = "/waveforms/";
+const size_t   WAVEFORM_PAYLOAD_MAX     = 1500;  // Sample bytes per request
+#if WAVEFORM_ENCODING == WAVEFORM_ENC_DELTA_VARINT
+const size_t   WAVEFORM_CHUNK_SAMPLES   = WAVEFORM_PAYLOAD_MAX / 3; // Best case: 3 bytes/sample
+#else
+const size_t   WAVEFORM_CHUNK_SAMPLES   = WAVEFORM_PAYLOAD_MAX / sizeof(RawSample);
+#endif
+const uint32_t WAVEFORM_POLL_MS         = LOW_POWER ? 1000 : 200;
+const int      WAVEFORM_UPLOAD_ATTEMPTS = 3;
+
+static uint8_t chunkBuf[WAVEFORM_HEADER_SIZE + WAVEFORM_PAYLOAD_MAX + WIRE_SIG_SIZE];
+static RawSample chunkSamples[WAVEFORM_CHUNK_SAMPLES];
+
+// Uploader-owned signing state: RFC 6979 on a private group copy, so the
+// upload never shares the DRBG or the pre-signature pool with the network task.
+static mbedtls_ecp_group uploadGroup;
+static mbedtls_entropy_context uploadEntropy;
+static mbedtls_ctr_drbg_context uploadDrbg;
+static mbedtls_md_context_t uploadHash;
+
+static bool initUploadSigner() {
+    const char *pers = "quake_guard_upload";
+    mbedtls_ecp_group_init(&uploadGroup);
+    mbedtls_entropy_init(&uploadEntropy);
+    mbedtls_ctr_drbg_init(&uploadDrbg);
+    mbedtls_md_init(&uploadHash);
+    return mbedtls_ecp_group_load(&uploadGroup, MBEDTLS_ECP_DP_SECP256R1) == 0 &&
+           mbedtls_ctr_drbg_seed(&uploadDrbg, mbedtls_entropy_func, &uploadEntropy,
+                                 (const unsigned char *)pers, strlen(pers)) == 0 &&
+           mbedtls_md_setup(&uploadHash, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0) == 0;
+}
+
+static bool signUploadDigest(const uint8_t hash[32], uint8_t rs[WIRE_SIG_SIZE]) {
+    const int64_t t0 = esp_timer_get_time();
+    mbedtls_ecp_keypair *kp = mbedtls_pk_ec(pk_context);
+    mbedtls_mpi r, s;
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    bool ok = mbedtls_ecdsa_sign_det_ext(&uploadGroup, &r, &s, &kp->d, hash, 32, MBEDTLS_MD_SHA256,
+                                         mbedtls_ctr_drbg_random, &uploadDrbg) == 0 &&
+              mbedtls_mpi_write_binary(&r, rs, WIRE_SIG_SIZE / 2) == 0 &&
+              mbedtls_mpi_write_binary(&s, rs + WIRE_SIG_SIZE / 2, WIRE_SIG_SIZE / 2) == 0;
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    metrics.noteSignUs((uint32_t)(esp_timer_get_time() - t0));
+    if (!ok) metrics.noteSignFailure();
+    return ok;
+}
+
+/**
+ * @brief Encodes the next chunk payload of the frozen window.
+ * @param offset First window sample of the chunk.
+ * @param prev Codec predictor state, carried from chunk to chunk.
+ * @param consumed Receives the number of samples encoded.
+ * @return Payload bytes written to out (at most WAVEFORM_PAYLOAD_MAX).
+ */
+static size_t encodeChunk(size_t offset, RawSample &prev, uint8_t *out, size_t *consumed) {
+    size_t n = capture.read(offset, chunkSamples, WAVEFORM_CHUNK_SAMPLES);
+#if WAVEFORM_ENCODING == WAVEFORM_ENC_DELTA_VARINT
+    return deltaEncode(chunkSamples, n, prev, out, WAVEFORM_PAYLOAD_MAX, consumed);
+#else
+    memcpy(out, chunkSamples, n * sizeof(RawSample));
+    *consumed = n;
+    return n * sizeof(RawSample);
+#endif
+}
+
+/**
+ * @brief Uploads the frozen capture window as a sequence of signed-at-the-end chunks.
+ * The last chunk carries one signature over the descriptor and every payload.
+ * @return true once every chunk was acknowledged with a 2xx status.
+ */
+static bool uploadCapture(HttpLink &link, uint32_t captureId) {
+    const size_t total = capture.length();
+    uint8_t *payload = chunkBuf + WAVEFORM_HEADER_SIZE;
+    WaveformDescriptor desc;
+    desc.encoding = WAVEFORM_ENCODING;
+    desc.odr_hz = SENSOR_ODR_HZ;
+    desc.misurator_id = SENSOR_ID_CONF;
+    desc.capture_id = captureId;
+    desc.trigger_timestamp = (uint32_t)unixTimeAt(capture.meta());
+    desc.total_samples = total;
+    desc.pre_samples = (uint16_t)capture.preSamples();
+
+    // Encoded chunks vary in size: a dry run fixes chunk_count, which the signature covers
+    RawSample prev = {0, 0, 0};
+    size_t offset = 0, consumed = 0;
+    desc.chunk_count = 0;
+    while (offset < total) {
+        encodeChunk(offset, prev, payload, &consumed);
+        if (consumed == 0) return false;
+        offset += consumed;
+        desc.chunk_count++;
+    }
+
+    prev = {0, 0, 0};
+    offset = 0;
+    mbedtls_md_starts(&uploadHash);
+    for (uint16_t chunk = 0; chunk < desc.chunk_count; chunk++) {
+        size_t payloadLen = encodeChunk(offset, prev, payload, &consumed);
+        offset += consumed;
+        wireEncodeWaveformHeader(desc, chunk, (uint16_t)payloadLen, chunkBuf, sizeof(chunkBuf));
+
+        if (chunk == 0) mbedtls_md_update(&uploadHash, chunkBuf, WAVEFORM_DESCRIPTOR_SIZE);
+        mbedtls_md_update(&uploadHash, payload, payloadLen);
+
+        size_t len = WAVEFORM_HEADER_SIZE + payloadLen;
+        if (chunk + 1 == desc.chunk_count) {
+            uint8_t hash[32];
+            mbedtls_md_finish(&uploadHash, hash);
+            if (!signUploadDigest(hash, chunkBuf + len)) return false;
+            len += WIRE_SIG_SIZE;
+        }
+
+        if (!link.ensureConnected() ||
+            !link.sendPost(WAVEFORM_PATH_CONF, WAVEFORM_CONTENT_TYPE, chunkBuf, len)) {
+            return false;
+        }
+        int status = link.readResponse(RESPONSE_TIMEOUT_MS);
+        if (status < 200 || status >= 300) {
+            Serial.printf("[CAPTURE] Chunk %u/%u rejected (HTTP %d).\n",
+                          (unsigned)chunk + 1, (unsigned)desc.chunk_count, status);
+            return false;
+        }
+    }
+    return true;
+}
+
+void uploadTask(void *pvParameters) {
+    static HttpLink link(SERVER_HOST_CONF, SERVER_PORT_CONF);
+    waitCryptoReady();
+    if (!initUploadSigner()) {
+        Serial.println("[CAPTURE] Signer init failed. Waveform upload disabled.");
+        vTaskDelete(NULL);
+        return;
+    }
+    uint32_t captureId = esp_random(); // Distinct ids across reboots
+
+    for(;;) {
+        if (!capture.ready() || !conn.ready()) {
+            vTaskDelay(pdMS_TO_TICKS(WAVEFORM_POLL_MS));
+            power.noteWakeup(POWER_WAKE_UPLOAD);
+            continue;
+        }
+
+        unsigned long t0 = millis();
+        bool ok = false;
+        power.radioAcquire();
+        for (int attempt = 1; attempt <= WAVEFORM_UPLOAD_ATTEMPTS && !ok; attempt++) {
+            ok = uploadCapture(link, captureId);
+            if (!ok) {
+                link.close();
+                vTaskDelay(pdMS_TO_TICKS(1000 * attempt));
+            }
+        }
+        power.radioRelease();
+
+        if (ok) {
+            Serial.printf("[CAPTURE] Uploaded waveform #%lu: %u samples (%u pre-trigger), encoding %d, in %lu ms.\n",
+                          (unsigned long)captureId, (unsigned)capture.length(),
+                          (unsigned)capture.preSamples(), WAVEFORM_ENCODING, millis() - t0);
+        } else {
+            Serial.println("[CAPTURE] Upload failed. Waveform dropped.");
+        }
+        captureId++;
+        capture.release();
+    }
+}
+#endif
+
+#if EVENT_JOURNAL
+/**
+ * @brief Picks the next burst in sequence order. Journal records the RAM backlog
+ * does not hold (earlier boots, queue or backlog overflow) go first, then the
+ * contiguous run at the front of the backlog.
+ * @param fromBacklog Set when the burst was copied from the backlog.
+ * @return Events in out; 0 if nothing can be sent yet.
+ */
+static size_t nextJournalBurst(SeismicEvent *out, bool *fromBacklog) {
+    static JournalRecord records[PENDING_SLOTS];
+    *fromBacklog = false;
+    for (;;) {
+        const uint32_t next = journal.acked() + 1;
+        SeismicEvent front;
+        bool haveFront = backlog.peek(&front, 1) == 1;
+        if (haveFront && front.seq != 0 && front.seq < next) {
+            backlog.pop(1); // Already delivered by a replay
+            continue;
+        }
+
+        uint32_t limit = haveFront && front.seq != 0 ? front.seq : journal.writtenEnd();
+        if (next < limit) {
+            uint32_t scanEnd;
+            size_t max = limit - next < PENDING_SLOTS ? limit - next : PENDING_SLOTS;
+            size_t n = journal.read(next, records, max, &scanEnd);
+            if (n == 0 && scanEnd > next) {
+                journal.acknowledge(scanEnd - 1); // Unreadable records: nothing left to send
+                continue;
+            }
+            for (size_t i = 0; i < n; i++) {
+                out[i].magnitude = records[i].magnitude;
+                out[i].event_us = (int64_t)records[i].uptime_ms * 1000; // ms resolution on replay
+                out[i].seq = records[i].seq;
+                out[i].sample_index = records[i].sample_index;
+                out[i].features = EventFeatures(); // Not journaled: replays go out unclassified
+                if (records[i].unix_time != JOURNAL_TIME_UNKNOWN) {
+                    out[i].device_time_us = (int64_t)records[i].unix_time * 1000000 + records[i].unix_usec;
+                } else {
+                    out[i].device_time_us = records[i].boot_id == journal.bootId() ? 0 : EVENT_TIME_UNKNOWN;
+                }
+            }
+            // n == 0: the gap is not on flash yet (writer behind), retry later
+            return n;
+        }
+        if (!haveFront) return 0;
+
+        size_t n = backlog.peek(out, PENDING_SLOTS);
+        size_t run = 1;
+        while (run < n && out[run].seq == out[run - 1].seq + 1) run++;
+        *fromBacklog = true;
+        return run;
+    }
+}
+#endif
+
+/**
+ * @brief true while events wait for delivery, in RAM or in the journal.
+ */
+static bool eventsPending() {
+#if EVENT_JOURNAL
+    if (journal.pending()) return true;
+#endif
+    return !backlog.empty();
+}
+
+/**
+ * @brief Sends the held events, oldest first, in bursts of PENDING_SLOTS.
+ * @return false if a burst was not fully delivered (the rest stays held).
+ */
+static bool flushBacklog(HttpLink &link) {
+    static SeismicEvent pending[PENDING_SLOTS];
+    while (eventsPending()) {
+        if (!conn.ready()) return false;
+        size_t n;
+        bool fromBacklog = true;
+#if EVENT_JOURNAL
+        if (journal.ready()) {
+            n = nextJournalBurst(pending, &fromBacklog);
+        } else
+#endif
+        {
+            n = backlog.peek(pending, PENDING_SLOTS);
+        }
+        if (n == 0) return !eventsPending();
+
+        size_t done = transmitEvents(link, pending, n);
+        if (fromBacklog) backlog.pop(done);
+#if EVENT_JOURNAL
+        if (done > 0) journal.acknowledge(pending[done - 1].seq);
+#endif
+        if (done < n) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Link statistics and every place an event can be lost.
+ */
+static void reportLink() {
+    conn.report();
+    timebase.report();
+#if EVENT_JOURNAL
+    journal.report();
+#endif
+    Serial.printf("[NET] Backlog: %u/%u (high water %u) | Dropped: queue full %lu, backlog full %lu, oversize %lu, "
+                  "rejected %lu\n",
+                  (unsigned)backlog.size(), (unsigned)backlog.capacity(), (unsigned)backlog.highWater(),
+                  (unsigned long)metrics.queueDropCount(), (unsigned long)backlog.dropped(), (unsigned long)encodeDrops,
+                  (unsigned long)rejectDrops);
+}
+
+void networkTask(void *pvParameters) {
+    // Static storage: the link owns a 2 KB transmit buffer
+    static HttpLink link(SERVER_HOST_CONF, SERVER_PORT_CONF);
+#if WAVEFORM_STREAM
+    WiFiClient stream;
+    const TickType_t xEventWait = pdMS_TO_TICKS(STREAM_FLUSH_MS);
+#else
+    const TickType_t xEventWait = pdMS_TO_TICKS(LINK_MAINTAIN_MS);
+#endif
+
+    // Non-blocking: association, retries and NTP (critical for signature validity)
+    // run in the background; triggers are held in the backlog until ready()
+    conn.begin(WIFI_SSID_CONF, WIFI_PASS_CONF, "pool.ntp.org", "time.nist.gov", &timebase);
+
+    // Events queue up meanwhile; nothing can be signed before the key is loaded
+    waitCryptoReady();
+    reportHeap("Network ready");
+
+#if REMOTE_CONFIG
+    // The last pushed configuration survives reboots; it is verified again before use
+    if (remoteConfig.begin(REMOTE_CONFIG_PUBKEY_CONF, SENSOR_ID_CONF, SENSOR_ODR_HZ)) {
+        DetectorConfig stored;
+        if (remoteConfig.load(stored)) stageRemoteConfig(stored);
+    } else {
+        Serial.println("[CONFIG] REMOTE_CONFIG_PUBKEY is not a P-256 public key. Remote configuration disabled.");
+    }
+    unsigned long lastConfigPoll = millis() - REMOTE_CONFIG_POLL_MS; // First poll as soon as the link is up
+#endif
+
+    bool radioConfigured = false;
+    uint32_t retryMs = 0;           // Flush back-off, 0 while the server answers
+    unsigned long retryAt = 0;
+    unsigned long lastPowerReport = millis();
+    unsigned long lastLinkReport = millis();
+    unsigned long lastTaskReport = millis();
+#if SENSOR_BUS == SENSOR_BUS_I2C
+    unsigned long lastBusReport = millis();
+#endif
+#if HEARTBEAT_MS > 0
+    unsigned long lastHeartbeat = millis();
+#endif
+    for(;;) {
+        SeismicEvent evt;
+        if (!eventsPending()) {
+            // Block until event is received from Sensor Task (trigger events take priority)
+            if (xQueueReceive(eventQueue, &evt, xEventWait) == pdTRUE) {
+                backlog.push(evt);
+            }
+        } else if (!conn.ready()) {
+            // Events held: wake as soon as the link is back, or to take in new triggers
+            retryMs = 0;
+            conn.waitReady(pdMS_TO_TICKS(BACKLOG_POLL_MS));
+        } else if (retryMs != 0 && (long)(millis() - retryAt) < 0) {
+            // Server unreachable: sleep until the next attempt, still taking in triggers
+            if (xQueueReceive(eventQueue, &evt, pdMS_TO_TICKS(retryAt - millis())) == pdTRUE) {
+                backlog.push(evt);
+            }
+        }
+        // Whatever else is queued joins the backlog (the oldest entry goes when full)
+        monitor.sampleQueues();
+        while (xQueueReceive(eventQueue, &evt, 0) == pdTRUE) {
+            backlog.push(evt);
+        }
+
+        if (!radioConfigured && conn.linkUp()) {
+            power.radioReady();
+            radioConfigured = true;
+        }
+
+        bool retryDue = retryMs == 0 || (long)(millis() - retryAt) >= 0;
+        if (eventsPending() && conn.ready() && retryDue) {
+            // Wake the radio first: it comes out of power save while the batch window runs
+            power.radioAcquire();
+#if BATCH_MODE
+            // Follow-up events arriving within the batch window share one request
+            const TickType_t window = pdMS_TO_TICKS(BATCH_WINDOW_MS);
+            const TickType_t windowStart = xTaskGetTickCount();
+            while (backlog.size() < PENDING_SLOTS) {
+                TickType_t elapsed = xTaskGetTickCount() - windowStart;
+                TickType_t wait = elapsed < window ? window - elapsed : 0;
+                if (xQueueReceive(eventQueue, &evt, wait) != pdTRUE) break;
+                backlog.push(evt);
+            }
+#endif
+            bool delivered = flushBacklog(link);
+            power.radioRelease();
+            if (delivered) {
+                retryMs = 0;
+            } else if (conn.ready()) {
+                retryMs = retryMs == 0 ? FLUSH_RETRY_MIN_MS
+                                       : (retryMs * 2 > FLUSH_RETRY_MAX_MS ? FLUSH_RETRY_MAX_MS : retryMs * 2);
+                retryAt = millis() + retryMs;
+                Serial.printf("[NET] %u event(s) held. Retry in %lu ms.\n",
+                              (unsigned)backlog.size(), (unsigned long)retryMs);
+            }
+        } else if (conn.linkUp()) {
+            // Keep the link warm so the next trigger skips the TCP handshake
+            link.maintain();
+        }
+
+        power.noteWakeup(POWER_WAKE_NETWORK);
+        if (millis() - lastPowerReport >= POWER_REPORT_MS) {
+            lastPowerReport = millis();
+            power.report();
+        }
+        if (millis() - lastLinkReport >= LINK_REPORT_MS) {
+            lastLinkReport = millis();
+            reportLink();
+        }
+        if (millis() - lastTaskReport >= TASK_REPORT_MS) {
+            lastTaskReport = millis();
+            monitor.report();
+        }
+#if REMOTE_CONFIG
+        if (millis() - lastConfigPoll >= REMOTE_CONFIG_POLL_MS && conn.ready() && !eventsPending()) {
+            lastConfigPoll = millis();
+            power.radioAcquire();
+            pollRemoteConfig(link);
+            power.radioRelease();
+        }
+#endif
+#if HEARTBEAT_MS > 0
+        // Events first: a heartbeat only goes out on an idle, ready link. The
+        // backend orders heartbeats by their timestamp, so none before the clock is set
+        if (millis() - lastHeartbeat >= HEARTBEAT_MS && conn.ready() && !eventsPending() && timebase.valid()) {
+            lastHeartbeat = millis();
+            power.radioAcquire();
+            sendHeartbeat(link);
+            power.radioRelease();
+        }
+#endif
+#if SENSOR_BUS == SENSOR_BUS_I2C
+        if (millis() - lastBusReport >= BUS_REPORT_MS) {
+            lastBusReport = millis();
+            i2c.report();
+        }
+#endif
+#if WAVEFORM_STREAM
+        streamSamples(stream);
+#endif
+    }
+}
+
+// --------------------------------------------------------------------------
+// SYSTEM INITIALIZATION
+// --------------------------------------------------------------------------
+void setup() {
+    Serial.begin(115200);
+    bootEvents = xEventGroupCreate();
+    provisioned = loadProvisioned();
+    const bool fastBoot = FAST_BOOT && provisioned;
+
+    if (!fastBoot) {
+        // Wait for the Serial Monitor to initialize
+        while(!Serial) delay(10); 
+        delay(2000); 
+    }
+
+    Serial.println("\n\n==================================================");
+    Serial.println("[BOOT] QuakeGuard Security System First...");
+    Serial.println("==================================================");
+
+    if (fastBoot) {
+        // Key already registered: arm the sensor first, crypto init runs in cryptoTask
+        Serial.println("[BOOT] Provisioned node: fast boot (crypto init in parallel).");
+    } else {
+        // 1. INITIALIZE CRYPTO SUBSYSTEM & DISPLAY KEY (PRIORITY OVER SENSOR)
+        startSecurity(true);
+
+        Serial.println("\n⚠️  WARNING: You have 10 seconds to copy the Public Key above!");
+        Serial.println("    Register it in the server database to prevent 403 Forbidden errors.");
+        Serial.println("    Sensor initialization will commence shortly...");
+        
+        // Visual Countdown
+        for(int i=10; i>0; i--) {
+            Serial.printf(" %d...", i);
+            delay(1000);
+        }
+    }
+    Serial.println("\n\n[BOOT] Starting Hardware Initialization...");
+
+#if BUS_BENCHMARK
+    // Runs on the raw pins, before either transport is brought up
+    if (!fastBoot) runBusBenchmark();
+#endif
+
+#if SENSOR_BUS == SENSOR_BUS_SPI
+    // 2. HARDWARE INIT (SPI: software SPI for setup and the polled path,
+    //    the hardware SPI host takes the pins over for FIFO acquisition)
+    Serial.printf("[HARDWARE] Configuring SPI Bus on SCK=%d, MISO=%d, MOSI=%d, CS=%d\n", SENSOR_SPI_SCK_PIN,
+                  SENSOR_SPI_MISO_PIN, SENSOR_SPI_MOSI_PIN, SENSOR_SPI_CS_PIN);
+
+    // 3. DYNAMIC MEMORY ALLOCATION
+    Serial.println("[HARDWARE] Allocating Sensor Object...");
+    if (accel != NULL) delete accel;
+    accel = new Adafruit_ADXL345_Unified(SENSOR_SPI_SCK_PIN, SENSOR_SPI_MISO_PIN, SENSOR_SPI_MOSI_PIN,
+                                         SENSOR_SPI_CS_PIN, 12345);
+
+    // 4. SENSOR STARTUP (begin() checks the device id over SPI)
+    if (accel->begin()) {
+        sensorFound = true;
+    } else {
+        Serial.println("[FATAL] Sensor Check Failed. (Check SDO/CS wiring.)");
+    }
+#else
+    // 2. HARDWARE INIT (I2C PINS 7 & 8)
+    Serial.printf("[HARDWARE] Configuring I2C Bus on SDA=%d, SCL=%d\n", I2C_SDA_PIN, I2C_SCL_PIN);
+    
+    // Bus Recovery Sequence: clocks SCL to unlatch a sensor stuck in a "zombie"
+    // state holding SDA low. The same sequence runs again whenever the bus
+    // misbehaves at runtime (i2c_bus.h).
+    i2c.begin(Wire, I2C_SDA_PIN, I2C_SCL_PIN, I2C_CLOCK_HZ, SENSOR_ODR_HZ, I2C_ADAPTIVE, !fastBoot);
+
+    // 3. DYNAMIC MEMORY ALLOCATION
+    Serial.println("[HARDWARE] Allocating Sensor Object...");
+    if (accel != NULL) delete accel;
+    accel = new Adafruit_ADXL345_Unified(12345);
+
+    // 4. SENSOR STARTUP
+    if(!accel->begin(0x53)) {
+        Serial.println("[WARN] Not found at 0x53. Trying 0x1D...");
+        if(!accel->begin(0x1D)) {
+            Serial.println("[FATAL] Sensor Check Failed. (Did you copy the key?)");
+            // We do not block execution in an infinite loop here, otherwise the Key 
+            // would scroll off-screen. The sensorTask will handle hardware absence gracefully.
+        } else {
+            sensorAddress = 0x1D;
+        }
+    } else {
+        sensorAddress = 0x53;
+    }
+    sensorFound = sensorAddress != 0;
+#endif
+
+    if (sensorFound) {
+        accel->setDataRate(odrToRateCode(SENSOR_ODR_HZ));
+        accel->setRange(ADXL345_RANGE_16_G);
+        Serial.println("[SYS] Sensor OK.");
+    }
+
+    // Benchmarks delay arming by up to a few seconds: provisioning boots only
+    if (!fastBoot) {
+#if DSP_BENCHMARK
+        runDspBenchmark();
+#endif
+#if CODEC_BENCHMARK
+        runCodecBenchmark();
+#endif
+    }
+
+    // 5. POWER MANAGEMENT (before the tasks, so the sensor task sees the final mode)
+    power.begin(LOW_POWER);
+
+    // 6. EVENT JOURNAL (mounted before the sensor task hands out sequence numbers)
+#if EVENT_JOURNAL
+    bool journalReady = journal.begin();
+#endif
+
+    // 7. TASK CREATION (sizes, priorities and cores: task_layout.h)
+    eventQueue = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(SeismicEvent));
+    monitor.watchQueue(eventQueue, "events");
+    monitor.spawn(SENSOR_TASK_SPEC, sensorTask, NULL);
+    monitor.spawn(NETWORK_TASK_SPEC, networkTask, NULL);
+    if (fastBoot) {
+        // Between the sensor and the network task: done long before Wi-Fi associates
+        monitor.spawn(CRYPTO_TASK_SPEC, cryptoTask, NULL, false);
+    }
+#if WAVEFORM_CAPTURE
+    monitor.spawn(UPLOAD_TASK_SPEC, uploadTask, NULL);
+#endif
+#if EVENT_JOURNAL
+    if (journalReady) {
+        // Low priority: flash writes and sector erases never delay detection or alerts
+        monitor.watchQueue(journal.writeQueue(), "journal");
+        monitor.spawn(JOURNAL_TASK_SPEC, EventJournal::writerTask, &journal);
+    }
+#endif
 
     Serial.println("[SYS] System Running.");
 }
 
 void loop() {
-    // Main loop delegates to FreeRTOS tasks
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    // Everything runs in the tasks created by setup(): release the loop task
+    // and its stack (CONFIG_ARDUINO_LOOP_STACK_SIZE, 8 KB) instead of waking it
+    vTaskDelete(NULL);
 }
\ No newline at end of file
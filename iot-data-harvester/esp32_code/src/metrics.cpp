@@ -0,0 +1,49 @@
+/**
+ * Module: Performance Counters
+ * See include/metrics.h for the threading model.
+ */
+
+#include "metrics.h"
+
+#include "esp_timer.h"
+
+static const uint32_t SIGN_BUCKET_MS[METRICS_SIGN_BUCKETS - 1] = { 2, 8, 32, 128, 512 };
+
+uint32_t Metrics::signBucketMs(size_t i) {
+    return i < METRICS_SIGN_BUCKETS - 1 ? SIGN_BUCKET_MS[i] : 0;
+}
+
+void Metrics::noteSignUs(uint32_t us) {
+    size_t bucket = 0;
+    while (bucket < METRICS_SIGN_BUCKETS - 1 && us > SIGN_BUCKET_MS[bucket] * 1000) bucket++;
+    portENTER_CRITICAL(&mux);
+    signCount[bucket]++;
+    if (us > signMaxUs) signMaxUs = us;
+    portEXIT_CRITICAL(&mux);
+}
+
+void Metrics::noteSignFailure() {
+    portENTER_CRITICAL(&mux);
+    signFailures++;
+    portEXIT_CRITICAL(&mux);
+}
+
+void Metrics::snapshot(MetricsSnapshot &out) const {
+    out.uptimeS = (uint32_t)(esp_timer_get_time() / 1000000LL);
+    out.samples = samples;
+    out.dropouts = dropouts;
+    out.triggers = triggers;
+    out.suppressed = suppressed;
+    out.queueDrops = queueDrops;
+    out.sendOk = sendOk;
+    out.sendFailures = sendFailures;
+    portENTER_CRITICAL(&mux);
+    for (size_t i = 0; i < METRICS_SIGN_BUCKETS; i++) out.signCount[i] = signCount[i];
+    out.signMaxUs = signMaxUs;
+    out.signFailures = signFailures;
+    portEXIT_CRITICAL(&mux);
+    out.tcpConnects = out.tcpConnectLastMs = out.tcpConnectMaxMs = 0;
+    out.wifiDisconnects = out.wifiReconnectMaxMs = 0;
+    out.freeHeap = ESP.getFreeHeap();
+    out.minFreeHeap = ESP.getMinFreeHeap();
+}
@@ -0,0 +1,166 @@
+/**
+ * Module: Power Manager
+ * See include/power_manager.h for the interface description.
+ */
+
+#include "power_manager.h"
+
+#include <WiFi.h>
+#include "esp_idf_version.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#if ESP_IDF_VERSION_MAJOR < 5
+  #include "esp32c3/pm.h"
+#endif
+
+// --------------------------------------------------------------------------
+// CURRENT MODEL (3.3 V, approximate datasheet figures, see README)
+// --------------------------------------------------------------------------
+static const float MA_ADXL345          = 0.14f;  // Measurement mode, ODR >= 100 Hz
+static const float MA_CPU_RUN          = 23.0f;  // 160 MHz, running
+static const float MA_CPU_IDLE_160     = 16.0f;  // 160 MHz, idle task (WAITI)
+static const float MA_CPU_IDLE_40      = 8.0f;   // Scaled down to 40 MHz (XTAL)
+static const float MA_LIGHT_SLEEP      = 0.13f;  // CPU and digital domain clock-gated
+static const float MA_RADIO_RX         = 80.0f;  // WIFI_PS_NONE: receiver always on
+static const float MA_RADIO_MIN_MODEM  = 1.2f;   // Beacon every DTIM (average)
+static const float MA_RADIO_MAX_MODEM  = 0.5f;   // Beacon every listen interval (3)
+
+static const uint32_t CPU_MIN_FREQ_MHZ = 40;
+
+PowerMode PowerManager::begin(bool lowPower) {
+    windowStartUs = esp_timer_get_time();
+    currentMode = POWER_MODE_ACTIVE;
+    if (!lowPower) return currentMode;
+
+    radioMutex = xSemaphoreCreateMutex();
+    currentMode = POWER_MODE_MODEM;
+
+#if CONFIG_PM_ENABLE
+  #if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t cfg;
+  #else
+    esp_pm_config_esp32c3_t cfg;
+  #endif
+    cfg.max_freq_mhz = (int)ESP.getCpuFreqMHz();
+    cfg.min_freq_mhz = (int)CPU_MIN_FREQ_MHZ;
+  #if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    cfg.light_sleep_enable = true;
+  #else
+    cfg.light_sleep_enable = false;
+  #endif
+    esp_err_t err = esp_pm_configure(&cfg);
+    if (err == ESP_OK) {
+        currentMode = cfg.light_sleep_enable ? POWER_MODE_LIGHT_SLEEP : POWER_MODE_DFS;
+        esp_pm_lock_handle_t lock;
+        if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "sensor", &lock) == ESP_OK) {
+            cpuLock = lock;
+        }
+    } else {
+        Serial.printf("[POWER] esp_pm_configure failed (%d). Radio power save only.\n", (int)err);
+    }
+#endif
+
+    Serial.printf("[POWER] Low-power mode: %s (CPU %d-%lu MHz).\n", modeName(),
+                  currentMode >= POWER_MODE_DFS ? (int)CPU_MIN_FREQ_MHZ : (int)ESP.getCpuFreqMHz(),
+                  (unsigned long)ESP.getCpuFreqMHz());
+    if (currentMode != POWER_MODE_LIGHT_SLEEP) {
+        Serial.println("[POWER] Automatic light sleep needs CONFIG_PM_ENABLE + CONFIG_FREERTOS_USE_TICKLESS_IDLE.");
+    }
+    return currentMode;
+}
+
+const char *PowerManager::modeName() const {
+    switch (currentMode) {
+        case POWER_MODE_MODEM:       return "modem-sleep";
+        case POWER_MODE_DFS:         return "dfs+modem-sleep";
+        case POWER_MODE_LIGHT_SLEEP: return "light-sleep";
+        default:                     return "active";
+    }
+}
+
+void PowerManager::sensorWake() {
+    if (cpuLock != NULL) esp_pm_lock_acquire((esp_pm_lock_handle_t)cpuLock);
+    wakeups[POWER_WAKE_SENSOR]++;
+    sensorWakeUs = esp_timer_get_time();
+}
+
+void PowerManager::sensorSleep() {
+    if (sensorWakeUs != 0) {
+        sensorAwakeUs += esp_timer_get_time() - sensorWakeUs;
+        sensorWakeUs = 0;
+    }
+    if (cpuLock != NULL) esp_pm_lock_release((esp_pm_lock_handle_t)cpuLock);
+}
+
+void PowerManager::radioReady() {
+    if (currentMode == POWER_MODE_ACTIVE) return;
+    xSemaphoreTake(radioMutex, portMAX_DELAY);
+    if (radioUsers == 0) WiFi.setSleep(WIFI_PS_MAX_MODEM);
+    xSemaphoreGive(radioMutex);
+}
+
+void PowerManager::radioAcquire() {
+    if (currentMode == POWER_MODE_ACTIVE) return;
+    xSemaphoreTake(radioMutex, portMAX_DELAY);
+    if (radioUsers++ == 0) {
+        // The access point stops buffering for us as soon as PM=0 is announced
+        WiFi.setSleep(WIFI_PS_NONE);
+        radioOnSinceUs = esp_timer_get_time();
+    }
+    xSemaphoreGive(radioMutex);
+}
+
+void PowerManager::radioRelease() {
+    if (currentMode == POWER_MODE_ACTIVE) return;
+    xSemaphoreTake(radioMutex, portMAX_DELAY);
+    if (radioUsers > 0 && --radioUsers == 0) {
+        WiFi.setSleep(WIFI_PS_MAX_MODEM);
+        radioOnUs += esp_timer_get_time() - radioOnSinceUs;
+    }
+    xSemaphoreGive(radioMutex);
+}
+
+float PowerManager::estimateCurrentMa(float sensorDuty, float radioOnDuty) const {
+    float idle;
+    float radioIdle = MA_RADIO_MAX_MODEM;
+    switch (currentMode) {
+        case POWER_MODE_LIGHT_SLEEP: idle = MA_LIGHT_SLEEP; break;
+        case POWER_MODE_DFS:         idle = MA_CPU_IDLE_40; break;
+        case POWER_MODE_MODEM:       idle = MA_CPU_IDLE_160; break;
+        default:
+            idle = MA_CPU_IDLE_160;
+            radioIdle = MA_RADIO_MIN_MODEM; // Arduino default power save
+            break;
+    }
+    return MA_ADXL345
+         + sensorDuty * MA_CPU_RUN + (1.0f - sensorDuty) * idle
+         + radioOnDuty * MA_RADIO_RX + (1.0f - radioOnDuty) * radioIdle;
+}
+
+void PowerManager::report() {
+    const int64_t now = esp_timer_get_time();
+    const float seconds = (now - windowStartUs) / 1e6f;
+    if (seconds <= 0.0f) return;
+
+    int64_t radioOn = radioOnUs;
+    if (radioUsers > 0) radioOn += now - radioOnSinceUs;
+    float sensorDuty = sensorAwakeUs / 1e6f / seconds;
+    float radioDuty = radioOn / 1e6f / seconds;
+    if (sensorDuty > 1.0f) sensorDuty = 1.0f;
+    if (radioDuty > 1.0f) radioDuty = 1.0f;
+
+    Serial.printf("[POWER] %s | Wakeups/s: sensor %.1f, network %.1f, upload %.1f | "
+                  "Sensor awake %.1f%% | Radio on %.1f%% | Est. %.1f mA\n",
+                  modeName(), wakeups[POWER_WAKE_SENSOR] / seconds,
+                  wakeups[POWER_WAKE_NETWORK] / seconds, wakeups[POWER_WAKE_UPLOAD] / seconds,
+                  100.0f * sensorDuty, 100.0f * radioDuty, estimateCurrentMa(sensorDuty, radioDuty));
+#if CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);
+#endif
+
+    for (size_t i = 0; i < POWER_WAKE_SOURCES; i++) wakeups[i] = 0;
+    sensorAwakeUs = 0;
+    radioOnUs = 0;
+    if (radioUsers > 0) radioOnSinceUs = now;
+    windowStartUs = now;
+}
@@ -0,0 +1,109 @@
+/**
+ * Module: Signed Remote Configuration
+ * See include/remote_config.h for the trust model.
+ */
+
+#include "remote_config.h"
+
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/md.h"
+
+static const char *CONFIG_NVS_NAMESPACE = "quake-config";
+static const size_t CONFIG_KEY_BYTES = 65;  // 04 || X || Y
+static const size_t CONFIG_SIG_BYTES = 64;  // r || s
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Decodes exactly len bytes of hex.
+ * @return false on a wrong length or a non-hex character.
+ */
+static bool hexDecode(const char *hex, uint8_t *out, size_t len) {
+    if (hex == NULL || strlen(hex) != 2 * len) return false;
+    for (size_t i = 0; i < len; i++) {
+        int hi = hexNibble(hex[2 * i]);
+        int lo = hexNibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+bool RemoteConfig::begin(const char *pubKeyHex, int sensorId, uint32_t odrHz) {
+    id = sensorId;
+    odr = odrHz;
+
+    uint8_t key[CONFIG_KEY_BYTES];
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&serverKey);
+    ready = hexDecode(pubKeyHex, key, sizeof(key)) &&
+            mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1) == 0 &&
+            mbedtls_ecp_point_read_binary(&grp, &serverKey, key, sizeof(key)) == 0 &&
+            mbedtls_ecp_check_pubkey(&grp, &serverKey) == 0;
+    return ready;
+}
+
+bool RemoteConfig::verify(const char *blob, const char *sigHex) {
+    uint8_t sig[CONFIG_SIG_BYTES];
+    if (!ready || !hexDecode(sigHex, sig, sizeof(sig))) return false;
+
+    uint8_t hash[32];
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), (const unsigned char *)blob, strlen(blob), hash);
+
+    mbedtls_mpi r, s;
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    bool ok = mbedtls_mpi_read_binary(&r, sig, CONFIG_SIG_BYTES / 2) == 0 &&
+              mbedtls_mpi_read_binary(&s, sig + CONFIG_SIG_BYTES / 2, CONFIG_SIG_BYTES / 2) == 0 &&
+              mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &serverKey, &r, &s) == 0;
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    return ok;
+}
+
+const char *RemoteConfig::validate(const char *blob, const char *sigHex, DetectorConfig &out) {
+    if (!verify(blob, sigHex)) return "bad signature";
+    if (!detectorConfigParse(blob, out)) return "malformed blob";
+    if (out.misurator_id != id) return "blob is for another sensor";
+    return detectorConfigCheck(out, odr);
+}
+
+bool RemoteConfig::load(DetectorConfig &out) {
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, true)) return false; // Nothing pushed yet
+    char blob[DETECTOR_CONFIG_MAX_LEN] = "";
+    char sigHex[2 * CONFIG_SIG_BYTES + 1] = "";
+    prefs.getString("blob", blob, sizeof(blob));
+    prefs.getString("sig", sigHex, sizeof(sigHex));
+    prefs.end();
+    if (blob[0] == '\0') return false;
+
+    const char *why = validate(blob, sigHex, out);
+    if (why != NULL) {
+        Serial.printf("[CONFIG] Stored configuration rejected (%s). Using the compiled profile.\n", why);
+        return false;
+    }
+    current = out.version;
+    return true;
+}
+
+bool RemoteConfig::accept(const char *blob, const char *sigHex, DetectorConfig &out, const char **why) {
+    *why = validate(blob, sigHex, out);
+    if (*why == NULL && out.version <= current) *why = "not newer than the version in use";
+    if (*why != NULL) return false;
+
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, false) ||
+        prefs.putString("blob", blob) == 0 || prefs.putString("sig", sigHex) == 0) {
+        // Still applied: it is valid, it just will not survive a reboot
+        Serial.println("[CONFIG] Could not store the configuration in NVS.");
+    }
+    prefs.end();
+    current = out.version;
+    return true;
+}
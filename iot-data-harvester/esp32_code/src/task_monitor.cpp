@@ -0,0 +1,135 @@
+/**
+ * Module: Task Monitor
+ * See include/task_monitor.h for the interface description.
+ */
+
+#include "task_monitor.h"
+
+TaskHandle_t TaskMonitor::spawn(const TaskSpec &spec, TaskFunction_t fn, void *arg, bool monitored) {
+    TaskHandle_t handle = NULL;
+    BaseType_t ok;
+#if portNUM_PROCESSORS > 1
+    if (spec.core != TASK_CORE_ANY) {
+        ok = xTaskCreatePinnedToCore(fn, spec.name, spec.stackBytes, arg, spec.priority, &handle, spec.core);
+    } else
+#endif
+    {
+        ok = xTaskCreate(fn, spec.name, spec.stackBytes, arg, spec.priority, &handle);
+    }
+    if (ok != pdPASS) {
+        Serial.printf("[TASKS] Could not create %s (%lu B stack).\n", spec.name, (unsigned long)spec.stackBytes);
+        return NULL;
+    }
+    if (monitored && taskCount < MONITOR_MAX_TASKS) {
+        tasks[taskCount].handle = handle;
+        tasks[taskCount].spec = &spec;
+        taskCount++;
+    }
+    return handle;
+}
+
+void TaskMonitor::watchQueue(QueueHandle_t queue, const char *name) {
+    if (queue == NULL || queueCount >= MONITOR_MAX_QUEUES) return;
+    WatchedQueue &q = queues[queueCount++];
+    q.queue = queue;
+    q.name = name;
+    q.length = uxQueueMessagesWaiting(queue) + uxQueueSpacesAvailable(queue);
+    q.peak = 0;
+}
+
+void TaskMonitor::sampleQueues() {
+    for (size_t i = 0; i < queueCount; i++) {
+        UBaseType_t depth = uxQueueMessagesWaiting(queues[i].queue);
+        if (depth > queues[i].peak) queues[i].peak = depth;
+    }
+}
+
+void TaskMonitor::noteWakeLatency(uint32_t us) {
+    portENTER_CRITICAL(&mux);
+    wakeCount++;
+    wakeSumUs += us;
+    if (us > wakeMaxUs) wakeMaxUs = us;
+    portEXIT_CRITICAL(&mux);
+}
+
+const TaskMonitor::Registered *TaskMonitor::find(TaskHandle_t handle) const {
+    for (size_t i = 0; i < taskCount; i++) {
+        if (tasks[i].handle == handle) return &tasks[i];
+    }
+    return NULL;
+}
+
+uint32_t TaskMonitor::previousRunTime(TaskHandle_t handle) const {
+    for (size_t i = 0; i < lastRunCount; i++) {
+        if (lastRun[i].handle == handle) return lastRun[i].counter;
+    }
+    return 0; // New task: its whole run time falls into this window
+}
+
+/**
+ * @brief One report line. cpu < 0: run-time stats unavailable.
+ */
+static void printTask(const char *name, UBaseType_t prio, const TaskSpec *spec, uint32_t freeBytes, float cpu) {
+    char size[16] = "";
+    char core[8] = "-";
+    if (spec != NULL) {
+        snprintf(size, sizeof(size), " of %lu", (unsigned long)spec->stackBytes);
+        if (portNUM_PROCESSORS > 1 && spec->core != TASK_CORE_ANY) snprintf(core, sizeof(core), "%d", spec->core);
+    }
+    char load[16] = "n/a";
+    if (cpu >= 0.0f) snprintf(load, sizeof(load), "%.1f%%", cpu);
+    Serial.printf("[TASKS] %-12s prio %2u core %s | stack %5lu free%s%s | cpu %s\n", name, (unsigned)prio,
+                  core, (unsigned long)freeBytes, size, freeBytes < MONITOR_STACK_WARN ? " LOW" : "", load);
+}
+
+void TaskMonitor::report() {
+#if configUSE_TRACE_FACILITY
+    static TaskStatus_t status[MONITOR_MAX_TASKS];
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(status, MONITOR_MAX_TASKS, &total);
+    if (n == 0) Serial.printf("[TASKS] More than %d tasks: report limited.\n", MONITOR_MAX_TASKS);
+    const uint32_t window = total - lastTotalRunTime; // Run-time counter: one core's worth of time
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        float cpu = -1.0f;
+  #if configGENERATE_RUN_TIME_STATS
+        if (window > 0) cpu = 100.0f * (status[i].ulRunTimeCounter - previousRunTime(status[i].xHandle)) / window;
+  #endif
+        const Registered *r = find(status[i].xHandle);
+        printTask(status[i].pcTaskName, status[i].uxCurrentPriority, r != NULL ? r->spec : NULL,
+                  status[i].usStackHighWaterMark, cpu);
+        lastRun[i].handle = status[i].xHandle;
+        lastRun[i].counter = status[i].ulRunTimeCounter;
+    }
+    lastRunCount = n;
+    lastTotalRunTime = total;
+#else
+    for (size_t i = 0; i < taskCount; i++) {
+        printTask(tasks[i].spec->name, uxTaskPriorityGet(tasks[i].handle), tasks[i].spec,
+                  uxTaskGetStackHighWaterMark(tasks[i].handle), -1.0f);
+    }
+#endif
+
+    if (queueCount > 0) {
+        char line[160];
+        size_t len = 0;
+        for (size_t i = 0; i < queueCount && len < sizeof(line); i++) {
+            int w = snprintf(line + len, sizeof(line) - len, "%s%s %u/%u (peak %u)", i > 0 ? ", " : "",
+                             queues[i].name, (unsigned)uxQueueMessagesWaiting(queues[i].queue),
+                             (unsigned)queues[i].length, (unsigned)queues[i].peak);
+            if (w < 0) break;
+            len += (size_t)w;
+            queues[i].peak = 0;
+        }
+        Serial.printf("[TASKS] Queues: %s\n", line);
+    }
+
+    portENTER_CRITICAL(&mux);
+    const uint32_t count = wakeCount, sum = wakeSumUs, worst = wakeMaxUs;
+    wakeCount = wakeSumUs = wakeMaxUs = 0;
+    portEXIT_CRITICAL(&mux);
+    if (count > 0) {
+        Serial.printf("[TASKS] Sensor wake latency (INT1 -> task): avg %lu us, max %lu us over %lu wakeups\n",
+                      (unsigned long)(sum / count), (unsigned long)worst, (unsigned long)count);
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * Module: Disciplined Timebase
+ * See include/timebase.h for the model.
+ */
+
+#include "timebase.h"
+
+#include <stdlib.h>
+#include "connectivity.h"
+#include "esp_timer.h"
+
+static const int64_t MIN_DRIFT_INTERVAL_US = 60LL * 1000000LL; // Shorter: NTP jitter dominates
+static const int64_t STEP_THRESHOLD_US     = 1000000LL;        // Beyond this the clock was set, not drifting
+static const float   DRIFT_GAIN            = 0.25f;            // EMA weight of a new drift measurement
+static const float   DRIFT_LIMIT_PPM       = 500.0f;
+
+void Timebase::onSync(const struct timeval *tv) {
+    const int64_t mono = esp_timer_get_time();
+    const int64_t unixUs = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+
+    portENTER_CRITICAL(&mux);
+    if (syncCount > 0) {
+        const int64_t interval = mono - anchorMonoUs;
+        const int64_t predicted = anchorUnixUs + interval + (int64_t)((float)interval * drift * 1e-6f);
+        const int64_t err = unixUs - predicted;
+        if (llabs(err) > STEP_THRESHOLD_US) {
+            steps++;
+            driftSamples = 0;
+            drift = 0.0f;
+        } else {
+            lastError = (int32_t)err;
+            if (abs(lastError) > maxError) maxError = abs(lastError);
+            if (interval >= MIN_DRIFT_INTERVAL_US) {
+                float measured = (float)((unixUs - anchorUnixUs) - interval) * 1e6f / (float)interval;
+                if (measured > DRIFT_LIMIT_PPM) measured = DRIFT_LIMIT_PPM;
+                if (measured < -DRIFT_LIMIT_PPM) measured = -DRIFT_LIMIT_PPM;
+                drift = driftSamples == 0 ? measured : drift + DRIFT_GAIN * (measured - drift);
+                driftSamples++;
+            }
+        }
+    }
+    anchorMonoUs = mono;
+    anchorUnixUs = unixUs;
+    syncCount++;
+    portEXIT_CRITICAL(&mux);
+}
+
+bool Timebase::valid() const {
+    return syncCount > 0 || time(NULL) >= CONN_MIN_VALID_UNIX;
+}
+
+int64_t Timebase::toUnixUs(int64_t monoUs) const {
+    if (syncCount == 0) {
+        // Clock kept across a software reset: age the stamp against it
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        if (now.tv_sec < CONN_MIN_VALID_UNIX) return 0;
+        return (int64_t)now.tv_sec * 1000000LL + now.tv_usec - (esp_timer_get_time() - monoUs);
+    }
+    portENTER_CRITICAL(&mux);
+    const int64_t dt = monoUs - anchorMonoUs;
+    const int64_t unixUs = anchorUnixUs + dt + (int64_t)((float)dt * drift * 1e-6f);
+    portEXIT_CRITICAL(&mux);
+    return unixUs;
+}
+
+void Timebase::report() const {
+    if (syncCount == 0) {
+        Serial.printf("[TIME] %s | No SNTP sync yet\n", valid() ? "RTC clock" : "Not set");
+        return;
+    }
+    portENTER_CRITICAL(&mux);
+    const uint32_t age = (uint32_t)((esp_timer_get_time() - anchorMonoUs) / 1000000LL);
+    const uint32_t syncs = syncCount, stepCount = steps;
+    const int32_t last = lastError, worst = maxError;
+    const float ppm = drift;
+    portEXIT_CRITICAL(&mux);
+    Serial.printf("[TIME] Syncs: %lu (steps %lu) | Sync error last/max: %+ld/%ld us | Drift: %+.2f ppm | "
+                  "Last sync %lu s ago\n",
+                  (unsigned long)syncs, (unsigned long)stepCount, (long)last, (long)worst, ppm,
+                  (unsigned long)age);
+}
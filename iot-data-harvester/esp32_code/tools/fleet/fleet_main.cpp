@@ -0,0 +1,365 @@
+/**
+ * Project: QuakeGuard - Host Sensor Fleet
+ * Target: PlatformIO env:fleet (Linux / macOS host, OpenSSL libcrypto)
+ *
+ * Description:
+ * Simulates N sensor nodes for the end-to-end latency benchmark
+ * (backend-data-elaborator/api/tests/latency_benchmark.py). Every node
+ * replays the same recording in real time through the sensor task path of
+ * src/main.cpp with its defaults: FIFO_WATERMARK-sample blocks into the
+ * float block detector of the reference profile. --features adds the
+ * EVENT_FEATURES=1 path: the feature window and FEATURE_SUPPRESS, which hold
+ * every trigger for FEATURE_WINDOW_MS. Each queued event becomes a one-entry
+ * binary frame (wire_format.h with sequence and µs, plus the features with
+ * --features, as WIRE_BINARY sends it)
+ * signed with the node's P-256 key: SHA-256 + raw r||s, through OpenSSL on
+ * the host where the device uses mbedtls.
+ *
+ * Node i starts replaying at T0 + i * spread / N, so the wave sweeps the
+ * fleet instead of tripping every node in the same block.
+ *
+ * Keys file: one node per line, "misurator_id private_scalar_hex".
+ *
+ * Output: one line per frame on stdout, flushed as it is produced:
+ *   frame <misurator_id> <seq> <trigger_us> <queued_us> <signed_us> <frame hex>
+ * trigger_us is the Unix time at which the trigger sample was latched,
+ * queued_us when the sensor task queued the event (after the block, and the
+ * feature window with --features), signed_us when the frame was signed. A
+ * summary goes to stderr.
+ *
+ * Usage:
+ *   pio run -e fleet
+ *   .pio/build/fleet/program --keys FILE [--spread-ms N] [--start S] [--duration S]
+ *                            [--odr HZ] [--counts] [--features] [file]
+ * Without a file the synthetic scenario of recording.h is replayed.
+ */
+
+// The EC_KEY calls map one to one onto the firmware's mbedtls ones
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/obj_mac.h>
+#include <openssl/sha.h>
+
+#include "quake_types.h"
+#include "sta_lta.h"
+#include "dsp_block.h"
+#include "detector_profile.h"
+#include "event_features.h"
+#include "wire_format.h"
+#include "recording.h"
+
+// --------------------------------------------------------------------------
+// FIRMWARE CONSTANTS (mirrors src/main.cpp)
+// --------------------------------------------------------------------------
+static const size_t   FIFO_WATERMARK    = 25;
+static const float    SEED_MAG_MS2      = 9.81f;
+static const uint32_t FEATURE_WINDOW_MS = 1000;
+static const bool     FEATURE_SUPPRESS  = true;
+static const uint16_t WIRE_FLAGS_MAX    = WIRE_FLAG_SEQUENCE | WIRE_FLAG_TIME_US | WIRE_FLAG_FEATURES;
+
+static bool eventFeatures = false; // EVENT_FEATURES (off by default, as in src/main.cpp)
+
+struct PendingTrigger {
+    float ratio;
+    uint32_t sample_index;
+};
+
+struct Node {
+    uint32_t id;
+    EC_KEY *key;
+    int64_t start_us;        // Unix time at which sample 0 is latched
+    size_t next;             // First sample not fed yet
+    uint32_t seq;
+    DetectorState st;
+    FeatureExtractor fx;
+    bool featuresReady;
+    PendingTrigger pending;
+};
+
+struct FleetStats {
+    size_t triggers;
+    size_t suppressed;
+    size_t frames;
+    size_t signFailures;
+};
+
+static int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// --------------------------------------------------------------------------
+// KEYS AND SIGNING
+// --------------------------------------------------------------------------
+static EC_KEY *loadKey(const char *hex) {
+    EC_KEY *key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+    BIGNUM *d = NULL;
+    EC_POINT *pub = NULL;
+    bool ok = key != NULL && BN_hex2bn(&d, hex) > 0 && EC_KEY_set_private_key(key, d) == 1;
+    if (ok) {
+        const EC_GROUP *grp = EC_KEY_get0_group(key);
+        pub = EC_POINT_new(grp);
+        ok = pub != NULL && EC_POINT_mul(grp, pub, d, NULL, NULL, NULL) == 1 && EC_KEY_set_public_key(key, pub) == 1;
+    }
+    EC_POINT_free(pub);
+    BN_free(d);
+    if (!ok) {
+        EC_KEY_free(key);
+        return NULL;
+    }
+    return key;
+}
+
+/**
+ * @brief Reads "misurator_id private_scalar_hex" lines.
+ * @return false on a malformed line or an invalid key.
+ */
+static bool loadKeys(const char *path, std::vector<Node> &nodes) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "[FLEET] Cannot open %s\n", path);
+        return false;
+    }
+    char line[256];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f) != NULL) {
+        unsigned long id = 0;
+        char hex[80];
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%lu %79s", &id, hex) != 2) {
+            fprintf(stderr, "[FLEET] Malformed key line: %s", line);
+            ok = false;
+            break;
+        }
+        Node node;
+        memset(&node, 0, sizeof(node));
+        node.id = (uint32_t)id;
+        node.key = loadKey(hex);
+        if (node.key == NULL) {
+            fprintf(stderr, "[FLEET] Invalid private key for sensor %lu\n", id);
+            ok = false;
+            break;
+        }
+        nodes.push_back(node);
+    }
+    fclose(f);
+    return ok && !nodes.empty();
+}
+
+/**
+ * @brief SHA-256 + ECDSA P-256, raw r||s: what signMessageRaw() does on the device.
+ */
+static bool signRaw(EC_KEY *key, const uint8_t *msg, size_t len, uint8_t rs[WIRE_SIG_SIZE]) {
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    SHA256(msg, len, hash);
+    ECDSA_SIG *sig = ECDSA_do_sign(hash, sizeof(hash), key);
+    if (sig == NULL) return false;
+    const BIGNUM *r, *s;
+    ECDSA_SIG_get0(sig, &r, &s);
+    bool ok = BN_bn2binpad(r, rs, WIRE_SIG_SIZE / 2) == WIRE_SIG_SIZE / 2 &&
+              BN_bn2binpad(s, rs + WIRE_SIG_SIZE / 2, WIRE_SIG_SIZE / 2) == WIRE_SIG_SIZE / 2;
+    ECDSA_SIG_free(sig);
+    return ok;
+}
+
+// --------------------------------------------------------------------------
+// SENSOR TASK
+// --------------------------------------------------------------------------
+/**
+ * @brief queueTrigger() + buildBinaryFrame() + the send: signs a one-entry
+ * frame and writes it to stdout.
+ */
+static void queueEvent(Node &node, uint32_t odr_hz, const PendingTrigger &t, const EventFeatures *features,
+                       FleetStats &stats) {
+    const int64_t queued_us = nowUs();
+    const int64_t trigger_us = node.start_us + ((int64_t)t.sample_index * 1000000) / odr_hz;
+
+    WireEntry entry;
+    entry.value = (int32_t)(t.ratio * 100);
+    entry.device_timestamp = (uint32_t)(trigger_us / 1000000);
+    entry.usec = (uint32_t)(trigger_us % 1000000);
+    entry.seq = ++node.seq;
+    entry.features = features != NULL ? *features : EventFeatures();
+
+    const uint16_t flags = WIRE_FLAG_SEQUENCE | WIRE_FLAG_TIME_US | (eventFeatures ? WIRE_FLAG_FEATURES : 0);
+    uint8_t frame[WIRE_FRAME_SIZE_FLAGS(1, WIRE_FLAGS_MAX)];
+    const size_t signedLen = wireEncodeFrame(node.id, &entry, 1, frame, sizeof(frame), flags);
+    if (signedLen == 0 || !signRaw(node.key, frame, signedLen, frame + signedLen)) {
+        stats.signFailures++;
+        return;
+    }
+    const int64_t signed_us = nowUs();
+
+    printf("frame %lu %lu %lld %lld %lld ", (unsigned long)node.id, (unsigned long)entry.seq,
+           (long long)trigger_us, (long long)queued_us, (long long)signed_us);
+    for (size_t i = 0; i < signedLen + WIRE_SIG_SIZE; i++) printf("%02x", frame[i]);
+    printf("\n");
+    fflush(stdout);
+    stats.frames++;
+}
+
+/**
+ * @brief One FIFO block as in the sensor task: detector, then the feature window.
+ */
+template <class Params>
+static void processBlock(const Params &p, Node &node, uint32_t odr_hz, const RawSample *block, size_t count,
+                         FleetStats &stats) {
+    const uint32_t first_index = (uint32_t)node.next;
+    BlockTrigger trig;
+    if (detectorProcessBlockT(p, node.st, block, count, &trig, 1) > 0) {
+        stats.triggers++;
+        PendingTrigger t = { trig.ratio, first_index + (uint32_t)trig.index };
+        if (node.featuresReady && featureBegin(node.fx, t.sample_index, trig.sta)) {
+            node.pending = t;
+        } else {
+            queueEvent(node, odr_hz, t, NULL, stats);
+        }
+    }
+
+    if (!node.featuresReady || !featureFeed(node.fx, block, count, first_index)) return;
+    EventFeatures f;
+    featureResult(node.fx, f);
+    if (FEATURE_SUPPRESS && f.event_class == EVENT_CLASS_IMPULSIVE) {
+        stats.suppressed++;
+        return;
+    }
+    queueEvent(node, odr_hz, node.pending, &f, stats);
+}
+
+/**
+ * @brief Feeds every node its blocks as their last sample is latched, in real time.
+ */
+template <uint32_t ODR>
+static FleetStats runFleet(const Recording &rec, std::vector<Node> &nodes) {
+    const StaticDetectorParams<ProfileReference, ODR> p;
+    const size_t n = rec.samples.size();
+    FleetStats stats = {0, 0, 0, 0};
+    size_t done = 0;
+    while (done < nodes.size()) {
+        int64_t wake_us = INT64_MAX;
+        done = 0;
+        for (Node &node : nodes) {
+            for (;;) {
+                if (node.next >= n) {
+                    done++;
+                    break;
+                }
+                const size_t count = n - node.next < FIFO_WATERMARK ? n - node.next : FIFO_WATERMARK;
+                const int64_t ready_us = node.start_us + ((int64_t)(node.next + count - 1) * 1000000) / ODR;
+                if (ready_us > nowUs()) {
+                    if (ready_us < wake_us) wake_us = ready_us;
+                    break;
+                }
+                processBlock(p, node, ODR, &rec.samples[node.next], count, stats);
+                node.next += count;
+            }
+        }
+        const int64_t wait_us = wake_us - nowUs();
+        if (done < nodes.size() && wait_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(wait_us));
+        }
+    }
+    return stats;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s --keys FILE [--spread-ms N] [--start S] [--duration S]\n"
+            "          [--odr HZ] [--counts] [--features] [file]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    Recording rec;
+    rec.odr_hz = 100;
+    bool counts = false;
+    const char *keysPath = NULL;
+    const char *path = NULL;
+    long spreadMs = 2000;
+    double startS = 0.0, durationS = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(a, "--keys") == 0 && hasValue) {
+            keysPath = argv[++i];
+        } else if (strcmp(a, "--spread-ms") == 0 && hasValue) {
+            spreadMs = atol(argv[++i]);
+        } else if (strcmp(a, "--start") == 0 && hasValue) {
+            startS = atof(argv[++i]);
+        } else if (strcmp(a, "--duration") == 0 && hasValue) {
+            durationS = atof(argv[++i]);
+        } else if (strcmp(a, "--odr") == 0 && hasValue) {
+            rec.odr_hz = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(a, "--counts") == 0) {
+            counts = true;
+        } else if (strcmp(a, "--features") == 0) {
+            eventFeatures = true;
+        } else if (a[0] != '-' && path == NULL) {
+            path = a;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    std::vector<Node> nodes;
+    if (keysPath == NULL || !loadKeys(keysPath, nodes)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (path != NULL) {
+        if (!loadRecording(path, rec, counts)) {
+            fprintf(stderr, "[FLEET] No samples found in %s\n", path);
+            return 1;
+        }
+    } else {
+        buildSynthetic(rec, rec.odr_hz);
+    }
+    // Crop to [start, start + duration)
+    const size_t first = (size_t)(startS * rec.odr_hz);
+    if (first >= rec.samples.size()) {
+        fprintf(stderr, "[FLEET] --start is past the end of %s\n", rec.name);
+        return 1;
+    }
+    rec.samples.erase(rec.samples.begin(), rec.samples.begin() + first);
+    if (durationS > 0.0 && (size_t)(durationS * rec.odr_hz) < rec.samples.size()) {
+        rec.samples.resize((size_t)(durationS * rec.odr_hz));
+    }
+
+    const int64_t t0 = nowUs() + 500000; // Leave the caller time to start reading
+    for (size_t i = 0; i < nodes.size(); i++) {
+        Node &node = nodes[i];
+        node.start_us = t0 + (spreadMs * 1000 * (int64_t)i) / (int64_t)nodes.size();
+        detectorInit(node.st, SEED_MAG_MS2);
+        node.featuresReady = eventFeatures && featureInit(node.fx, rec.odr_hz, FEATURE_WINDOW_MS);
+    }
+    fprintf(stderr, "[FLEET] %zu nodes replaying %s: %zu samples @ %u Hz (%.1f s), spread %ld ms, features %s\n",
+            nodes.size(), rec.name, rec.samples.size(), rec.odr_hz,
+            (double)rec.samples.size() / rec.odr_hz, spreadMs, eventFeatures ? "on" : "off");
+
+    FleetStats stats;
+    switch (rec.odr_hz) {
+        case 100: stats = runFleet<100>(rec, nodes); break;
+        case 200: stats = runFleet<200>(rec, nodes); break;
+        case 400: stats = runFleet<400>(rec, nodes); break;
+        case 800: stats = runFleet<800>(rec, nodes); break;
+        default:
+            fprintf(stderr, "[FLEET] No detector specialization for %u Hz\n", rec.odr_hz);
+            return 1;
+    }
+    for (Node &node : nodes) EC_KEY_free(node.key);
+
+    fprintf(stderr, "[FLEET] %zu triggers, %zu suppressed as impulsive, %zu frames sent, %zu signing failures\n",
+            stats.triggers, stats.suppressed, stats.frames, stats.signFailures);
+    return stats.signFailures > 0 ? 1 : 0;
+}
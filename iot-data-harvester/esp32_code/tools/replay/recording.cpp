@@ -0,0 +1,176 @@
+/**
+ * Project: QuakeGuard - Host Recording Input
+ * See recording.h for the formats.
+ */
+
+#include "recording.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+static const uint32_t STREAM_MAGIC = 0x53574751; // "QGWS"
+static const size_t   STREAM_HEADER_SIZE = 20;
+
+static uint16_t readLe16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t readLe32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Parses a WAVEFORM_STREAM capture. Stops at the first damaged frame.
+ */
+static bool parseStream(const std::vector<uint8_t> &buf, Recording &rec) {
+    size_t pos = 0;
+    uint32_t expectSeq = 0, gaps = 0;
+    bool first = true;
+    while (pos + STREAM_HEADER_SIZE <= buf.size()) {
+        const uint8_t *h = &buf[pos];
+        if (readLe32(h) != STREAM_MAGIC) {
+            fprintf(stderr, "[REPLAY] %s: bad frame magic at byte %zu, truncating\n", rec.name, pos);
+            break;
+        }
+        uint32_t seq = readLe32(h + 8);
+        size_t count = readLe16(h + 16);
+        if (pos + STREAM_HEADER_SIZE + count * 6 > buf.size()) break; // Partial last frame
+        if (!first && seq != expectSeq) gaps++;
+        first = false;
+        expectSeq = seq + 1;
+        rec.odr_hz = readLe16(h + 6);
+
+        const uint8_t *p = h + STREAM_HEADER_SIZE;
+        for (size_t i = 0; i < count; i++, p += 6) {
+            RawSample s;
+            s.x = (int16_t)readLe16(p);
+            s.y = (int16_t)readLe16(p + 2);
+            s.z = (int16_t)readLe16(p + 4);
+            rec.samples.push_back(s);
+        }
+        pos += STREAM_HEADER_SIZE + count * 6;
+    }
+    if (gaps > 0) {
+        fprintf(stderr, "[REPLAY] %s: %u sequence gaps (frames lost on the link)\n", rec.name, gaps);
+    }
+    return !rec.samples.empty();
+}
+
+static int16_t toCounts(float v, bool counts) {
+    float c = counts ? v : v / ADXL345_LSB_TO_MS2;
+    if (c > 32767.0f) c = 32767.0f;
+    if (c < -32768.0f) c = -32768.0f;
+    return (int16_t)lrintf(c);
+}
+
+/**
+ * @brief Parses a text recording (three numbers per line).
+ */
+static bool parseText(const std::vector<uint8_t> &buf, Recording &rec, bool counts) {
+    std::string text(buf.begin(), buf.end());
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos) eol = text.size();
+        std::string line = text.substr(pos, eol - pos);
+        pos = eol + 1;
+
+        const char *c = line.c_str();
+        while (*c == ' ' || *c == '\t') c++;
+        if (!(*c == '-' || *c == '+' || *c == '.' || (*c >= '0' && *c <= '9'))) continue;
+
+        float v[3];
+        int n = 0;
+        while (n < 3) {
+            char *end;
+            v[n] = strtof(c, &end);
+            if (end == c) break;
+            n++;
+            c = end;
+            while (*c == ' ' || *c == '\t' || *c == ',' || *c == ';') c++;
+        }
+        if (n < 3) continue;
+
+        RawSample s;
+        s.x = toCounts(v[0], counts);
+        s.y = toCounts(v[1], counts);
+        s.z = toCounts(v[2], counts);
+        rec.samples.push_back(s);
+    }
+    return !rec.samples.empty();
+}
+
+bool loadRecording(const char *path, Recording &rec, bool counts) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "[REPLAY] Cannot open %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+    fclose(f);
+
+    rec.name = path;
+    if (buf.size() >= 4 && readLe32(buf.data()) == STREAM_MAGIC) {
+        return parseStream(buf, rec);
+    }
+    return parseText(buf, rec, counts);
+}
+
+void buildSynthetic(Recording &rec, uint32_t odr_hz) {
+    const size_t n = 130 * odr_hz;
+    const float g = 1.0f / 0.004f; // Counts per G in FULL_RES
+    const float TWO_PI = 2.0f * (float)M_PI;
+    rec.name = "synthetic";
+    rec.odr_hz = odr_hz;
+    rec.events = {30 * odr_hz, 80 * odr_hz, 105 * odr_hz};
+    rec.samples.resize(n);
+
+    uint32_t lcg = 12345;
+    auto noise = [&lcg]() {
+        // Sum of two uniforms: triangular noise of ~1.6 LSB rms (ADXL345 datasheet: 1-1.5)
+        lcg = lcg * 1664525UL + 1013904223UL;
+        int a = (int)((lcg >> 24) & 0x03);
+        lcg = lcg * 1664525UL + 1013904223UL;
+        int b = (int)((lcg >> 24) & 0x03);
+        return (float)(a + b - 3);
+    };
+
+    for (size_t i = 0; i < n; i++) {
+        float t = (float)i / odr_hz;
+        float x = noise(), y = noise(), z = g + noise();
+
+        for (size_t e = 0; e < 2; e++) {
+            float te = t - (float)rec.events[e] / odr_hz;
+            if (te < 0.0f || te > 10.0f) continue;
+            // 1 s ramp-up, then exponential decay; 0.25G horizontal, 0.1G vertical
+            float env = (te < 1.0f ? te : expf(-(te - 1.0f) / 3.0f)) * (e == 0 ? 1.0f : 0.5f);
+            float w = TWO_PI * 4.0f * te;
+            x += 0.25f * g * env * sinf(w);
+            y += 0.25f * g * env * cosf(1.3f * w);
+            z += 0.10f * g * env * sinf(0.7f * w);
+            if (e == 0 && odr_hz > 28) z += 0.05f * g * env * sinf(3.0f * w); // Near event: 12 Hz content
+        }
+
+        float tl = t - (float)rec.events[2] / odr_hz;
+        if (tl >= 0.0f && tl < 20.0f) {
+            // Long period: 4 s ramp, 0.04G mostly vertical
+            float env = tl < 4.0f ? tl / 4.0f : expf(-(tl - 4.0f) / 6.0f);
+            z += 0.04f * g * env * sinf(TWO_PI * 0.8f * tl);
+            x += 0.02f * g * env * cosf(TWO_PI * 0.8f * tl);
+        }
+
+        if (t >= 40.0f && t < 55.0f && odr_hz > 28) {
+            // Spin cycle: 2 s ramp, steady 14 Hz, 0.03G
+            float env = t < 42.0f ? (t - 40.0f) / 2.0f : 1.0f;
+            x += 0.03f * g * env * sinf(TWO_PI * 14.0f * t);
+            z += 0.03f * g * env * cosf(TWO_PI * 14.0f * t);
+        }
+
+        if (i >= 60 * odr_hz && i < 60 * odr_hz + odr_hz / 50 + 1) z += 0.5f * g;
+
+        rec.samples[i].x = (int16_t)lrintf(x);
+        rec.samples[i].y = (int16_t)lrintf(y);
+        rec.samples[i].z = (int16_t)lrintf(z);
+    }
+}
@@ -0,0 +1,44 @@
+/**
+ * Project: QuakeGuard - Host Recording Input
+ * Target: PlatformIO env:native / env:fleet (Linux / macOS host)
+ *
+ * Description:
+ * Accelerometer recordings for the host tools (tools/replay, tools/fleet).
+ * Input formats (auto-detected):
+ * - Stream capture: raw bytes of a WAVEFORM_STREAM socket (e.g. `nc -l 9000 > run.qgws`),
+ *   StreamFrameHeader + RawSample frames. ODR is taken from the headers.
+ * - Text: one sample per line, "x y z" or "x,y,z" in m/s^2 (or counts with
+ *   counts = true). Lines that do not start with a number (comments, log
+ *   lines) are skipped, so a Serial Monitor dump can be replayed as it is.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "quake_types.h"
+
+struct Recording {
+    const char *name;
+    std::vector<RawSample> samples;
+    uint32_t odr_hz;
+    std::vector<size_t> events; // Ground-truth onsets (sample index)
+};
+
+/**
+ * @brief Loads a recording (name = path). events is left alone.
+ * @return false if the file cannot be read or holds no samples.
+ */
+bool loadRecording(const char *path, Recording &rec, bool counts);
+
+/**
+ * @brief Synthetic 130 s scenario at odr_hz: 1G on Z + sensor noise.
+ * Events (ground truth):
+ *   30 s  strong 4 Hz shaking (+12 Hz)   80 s  weaker 4 Hz shaking
+ *   105 s long-period 0.8 Hz motion (slow ramp, 20 s)
+ * Disturbances (should not trigger):
+ *   40-55 s washing-machine spin at 14 Hz    60 s impulsive glitch (door slam)
+ */
+void buildSynthetic(Recording &rec, uint32_t odr_hz);
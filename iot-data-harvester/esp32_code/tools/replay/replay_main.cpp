@@ -0,0 +1,448 @@
+/**
+ * Project: QuakeGuard - Host DSP Replay Harness
+ * Target: PlatformIO env:native (Linux / macOS host)
+ *
+ * Description:
+ * Streams recorded accelerometer data through the QuakeCore detectors at
+ * full host speed, for every parameter set in PARAMETER_SETS, and prints
+ * per set and implementation (sqrt(pow) reference / float block kernels /
+ * Q15 block path), for every compile-time profile of detector_profile.h
+ * (runtime parameters vs. the specialized "static" / "q15s" kernels), plus
+ * one row for the multi-band detector bank:
+ * - samples/s and ns/sample of the detector loop,
+ * - detected events and trigger latency in samples (first trigger minus onset),
+ * - false triggers (triggers outside every event window).
+ * It then lists the event features and local class (event_features.h) of
+ * every trigger of the production set, as the sensor task computes them.
+ *
+ * Input formats (auto-detected):
+ * - Stream capture: raw bytes of a WAVEFORM_STREAM socket (e.g. `nc -l 9000 > run.qgws`),
+ *   StreamFrameHeader + RawSample frames. ODR is taken from the headers.
+ * - Text: one sample per line, "x y z" or "x,y,z" in m/s^2 (or counts with
+ *   --counts). Lines that do not start with a number (comments, log lines)
+ *   are skipped, so a Serial Monitor dump can be replayed as it is.
+ * Without a file a built-in synthetic scenario is replayed (quiet noise,
+ * three events, a washing machine and an impulsive glitch).
+ *
+ * Usage:
+ *   pio run -e native
+ *   .pio/build/native/program [--odr HZ] [--counts] [--event N]... [--window N]
+ *                             [--repeat N] [--block N] [--check] [--set LTA,STA,RATIO] [file]
+ *
+ * --check exits with status 1 if the block kernels trigger on different
+ * samples than the reference, or a specialized profile kernel on different
+ * samples than the same profile with runtime parameters, so the harness
+ * doubles as a regression test.
+ *
+ * Ground truth comes from --event (onset sample index, repeatable). A file
+ * replayed without --event is treated as quiet background: every trigger is
+ * counted as false.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "quake_types.h"
+#include "sta_lta.h"
+#include "dsp_fixed.h"
+#include "dsp_block.h"
+#include "detector_bank.h"
+#include "detector_profile.h"
+#include "event_features.h"
+#include "recording.h"
+
+// --------------------------------------------------------------------------
+// FIRMWARE CONSTANTS (mirrors src/main.cpp)
+// --------------------------------------------------------------------------
+static const float    HPF_COEFF         = 0.9f;
+static const float    DROPOUT_MS2       = 2.0f;
+static const float    LTA_FLOOR         = 0.05f;
+static const float    NOISE_FLOOR       = 0.04f;
+static const uint32_t ALARM_COOLDOWN_MS = 5000;
+static const size_t   FIFO_WATERMARK    = 25; // Block size of the Q15 path (and default --block)
+static const float    SEED_MAG_MS2      = 9.81f;
+static const size_t   BLOCK_MAX_TRIGGERS = 64; // Per --block call (one per cooldown at most)
+static const uint32_t FEATURE_WINDOW_MS = 1000;
+
+struct ParameterSet {
+    const char *name;
+    float alpha_lta;
+    float alpha_sta;
+    float trigger_ratio;
+};
+
+// First entry is the production tuning of src/main.cpp.
+static std::vector<ParameterSet> PARAMETER_SETS = {
+    {"reference",    0.05f, 0.40f, 1.8f},
+    {"sensitive",    0.05f, 0.40f, 1.5f},
+    {"conservative", 0.05f, 0.40f, 2.5f},
+    {"fast-sta",     0.05f, 0.60f, 1.8f},
+    {"slow-lta",     0.02f, 0.40f, 1.8f},
+};
+
+struct ReplayResult {
+    std::vector<size_t> triggers;
+    double ns_per_sample;
+};
+
+// --------------------------------------------------------------------------
+// REPLAY
+// --------------------------------------------------------------------------
+static DetectorParams floatParams(const ParameterSet &set, uint32_t odr_hz) {
+    DetectorParams p;
+    p.alpha_lta = set.alpha_lta;
+    p.alpha_sta = set.alpha_sta;
+    p.trigger_ratio = set.trigger_ratio;
+    p.noise_floor = NOISE_FLOOR;
+    p.hpf_coeff = HPF_COEFF;
+    p.dropout_ms2 = DROPOUT_MS2;
+    p.lta_floor = LTA_FLOOR;
+    p.cooldown_samples = (ALARM_COOLDOWN_MS * odr_hz) / 1000;
+    return p;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point t0) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+/**
+ * @brief Reference path: sqrt(pow()) + detectorStep() per sample, as in the
+ * polled acquisition loop. The block kernels are checked against this.
+ */
+static ReplayResult replayReference(const Recording &rec, const DetectorParams &p, int repeat) {
+    ReplayResult res;
+    const size_t n = rec.samples.size();
+    volatile float sink = 0.0f;
+    double ns = 0.0;
+
+    for (int r = 0; r < repeat; r++) {
+        DetectorState st;
+        detectorInit(st, SEED_MAG_MS2);
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++) {
+            const RawSample &s = rec.samples[i];
+            float x = s.x * ADXL345_LSB_TO_MS2;
+            float y = s.y * ADXL345_LSB_TO_MS2;
+            float z = s.z * ADXL345_LSB_TO_MS2;
+            float ratio = 0.0f;
+            if (detectorStep(p, st, sqrt(pow(x, 2) + pow(y, 2) + pow(z, 2)), &ratio) && r == 0) {
+                res.triggers.push_back(i);
+            }
+            sink = ratio;
+        }
+        ns += elapsedNs(t0);
+    }
+    (void)sink;
+    res.ns_per_sample = ns / ((double)n * repeat);
+    return res;
+}
+
+/**
+ * @brief Float block kernels (dsp_block.h), blockSize samples per call.
+ * Params is DetectorParams or a StaticDetectorParams profile.
+ */
+template <class Params>
+static ReplayResult replayBlock(const Recording &rec, const Params &p, int repeat, size_t blockSize) {
+    ReplayResult res;
+    const size_t n = rec.samples.size();
+    double ns = 0.0;
+
+    for (int r = 0; r < repeat; r++) {
+        DetectorState st;
+        detectorInit(st, SEED_MAG_MS2);
+        BlockTrigger trigs[BLOCK_MAX_TRIGGERS];
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i += blockSize) {
+            size_t count = n - i < blockSize ? n - i : blockSize;
+            size_t found = detectorProcessBlockT(p, st, &rec.samples[i], count, trigs, BLOCK_MAX_TRIGGERS);
+            if (found > BLOCK_MAX_TRIGGERS) found = BLOCK_MAX_TRIGGERS;
+            for (size_t t = 0; t < found && r == 0; t++) {
+                res.triggers.push_back(i + trigs[t].index);
+            }
+        }
+        ns += elapsedNs(t0);
+    }
+    res.ns_per_sample = ns / ((double)n * repeat);
+    return res;
+}
+
+/**
+ * @brief Q15 block path, in FIFO_WATERMARK-sample blocks as on the device.
+ * Params is FixedParams or a StaticFixedParams profile; fp seeds the state.
+ */
+template <class Params>
+static ReplayResult replayFixed(const Recording &rec, const Params &p, const FixedParams &fp, int repeat) {
+    ReplayResult res;
+    const size_t n = rec.samples.size();
+    double ns = 0.0;
+
+    for (int r = 0; r < repeat; r++) {
+        FixedDetector det;
+        fixedDetectorInit(det, fp, SEED_MAG_MS2);
+        FixedTrigger trig = {0, 0, 0};
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i += FIFO_WATERMARK) {
+            size_t count = n - i < FIFO_WATERMARK ? n - i : FIFO_WATERMARK;
+            if (fixedProcessBlockT(p, det, &rec.samples[i], count, &trig) && r == 0) {
+                res.triggers.push_back(i + trig.index);
+            }
+        }
+        ns += elapsedNs(t0);
+    }
+    res.ns_per_sample = ns / ((double)n * repeat);
+    return res;
+}
+
+/**
+ * @brief Multi-band detector bank (detector_bank.h) with cfg, blockSize samples per call.
+ */
+static ReplayResult replayBank(const Recording &rec, const BankConfig &cfg, int repeat, size_t blockSize) {
+    ReplayResult res;
+    const size_t n = rec.samples.size();
+    double ns = 0.0;
+
+    for (int r = 0; r < repeat; r++) {
+        DetectorBank bank;
+        if (!bankInit(bank, cfg, rec.odr_hz, SEED_MAG_MS2)) {
+            fprintf(stderr, "[REPLAY] Bank config invalid at %u Hz\n", rec.odr_hz);
+            res.ns_per_sample = 0.0;
+            return res;
+        }
+        BankTrigger trigs[BLOCK_MAX_TRIGGERS];
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i += blockSize) {
+            size_t count = n - i < blockSize ? n - i : blockSize;
+            size_t found = bankProcessBlock(bank, &rec.samples[i], count, trigs, BLOCK_MAX_TRIGGERS);
+            if (found > BLOCK_MAX_TRIGGERS) found = BLOCK_MAX_TRIGGERS;
+            for (size_t t = 0; t < found && r == 0; t++) {
+                res.triggers.push_back(i + trigs[t].index);
+            }
+        }
+        ns += elapsedNs(t0);
+    }
+    res.ns_per_sample = ns / ((double)n * repeat);
+    return res;
+}
+
+/**
+ * @brief Matches triggers against the ground truth and prints one table row.
+ * A trigger within [onset, onset + window) detects that event; the first one
+ * gives the latency. Every other trigger is a false trigger.
+ */
+static void report(const Recording &rec, const char *setName, const char *impl,
+                   const ReplayResult &res, size_t window) {
+    size_t detected = 0, falseTriggers = 0, latencySum = 0, latencyMax = 0;
+    std::vector<bool> hit(rec.events.size(), false);
+
+    for (size_t t : res.triggers) {
+        bool matched = false;
+        for (size_t e = 0; e < rec.events.size(); e++) {
+            size_t onset = rec.events[e];
+            if (t < onset || t >= onset + window) continue;
+            matched = true;
+            if (!hit[e]) {
+                hit[e] = true;
+                detected++;
+                size_t latency = t - onset;
+                latencySum += latency;
+                if (latency > latencyMax) latencyMax = latency;
+            }
+        }
+        if (!matched) falseTriggers++;
+    }
+
+    char latency[32] = "-";
+    if (detected > 0) {
+        snprintf(latency, sizeof(latency), "%.1f / %zu", (double)latencySum / detected, latencyMax);
+    }
+    if (res.ns_per_sample <= 0.0) return;
+    printf("%-13s %-6s %12.0f %10.1f %9zu %5zu/%-4zu %15s %6zu\n",
+           setName, impl, 1e9 / res.ns_per_sample, res.ns_per_sample,
+           res.triggers.size(), detected, rec.events.size(), latency, falseTriggers);
+}
+
+/**
+ * @brief Reference detector plus the feature extractor, fed sample by sample
+ * as in the polled loop: prints one row per trigger.
+ */
+static void reportFeatures(const Recording &rec, const ParameterSet &set, size_t window) {
+    const DetectorParams p = floatParams(set, rec.odr_hz);
+    FeatureExtractor fx;
+    if (!featureInit(fx, rec.odr_hz, FEATURE_WINDOW_MS)) {
+        fprintf(stderr, "[REPLAY] Feature window invalid at %u Hz\n", rec.odr_hz);
+        return;
+    }
+    DetectorState st;
+    detectorInit(st, SEED_MAG_MS2);
+
+    printf("[REPLAY] Features of the %s set, %u ms window:\n", set.name, (unsigned)FEATURE_WINDOW_MS);
+    printf("%10s %-6s %-10s %8s %12s %8s %12s %12s %12s\n", "trigger", "event", "class", "dom Hz",
+           "duration ms", "PGA mm/s2", "energy x", "energy y", "energy z");
+    size_t pending = 0;
+    for (size_t i = 0; i < rec.samples.size(); i++) {
+        const RawSample &s = rec.samples[i];
+        float ratio = 0.0f;
+        float mag = sqrtf((float)(s.x * s.x + s.y * s.y + s.z * s.z)) * ADXL345_LSB_TO_MS2;
+        if (detectorStep(p, st, mag, &ratio) && featureBegin(fx, (uint32_t)i, st.sta)) {
+            pending = i;
+        }
+        if (!featureFeed(fx, &s, 1, (uint32_t)i)) continue;
+
+        EventFeatures f;
+        featureResult(fx, f);
+        const char *event = "false";
+        for (size_t e = 0; e < rec.events.size(); e++) {
+            if (pending >= rec.events[e] && pending < rec.events[e] + window) event = "true";
+        }
+        printf("%10zu %-6s %-10s %8u %12u %8lu %12lu %12lu %12lu\n", pending, event,
+               eventClassName(f.event_class), f.dominant_hz, f.duration_ms, (unsigned long)f.pga_mms2,
+               (unsigned long)f.energy[0], (unsigned long)f.energy[1], (unsigned long)f.energy[2]);
+    }
+}
+
+/**
+ * @brief Replays profile P with runtime parameters ("block", "q15") and with
+ * the kernels specialized at compile time ("static", "q15s").
+ * @return 1 if a specialized kernel triggers differently than its runtime twin.
+ */
+template <class P, uint32_t ODR>
+static size_t replayProfileAt(const Recording &rec, int repeat, size_t blockSize, size_t window) {
+    typedef StaticDetectorParams<P, ODR> Float;
+    typedef StaticFixedParams<P, ODR> Fixed;
+    const DetectorParams fp = Float::runtime();
+    const FixedParams qp = Fixed::runtime();
+
+    ReplayResult blk = replayBlock(rec, fp, repeat, blockSize);
+    ReplayResult blkStatic = replayBlock(rec, Float(), repeat, blockSize);
+    ReplayResult q15 = replayFixed(rec, qp, qp, repeat);
+    ReplayResult q15Static = replayFixed(rec, Fixed(), qp, repeat);
+    report(rec, P::name(), "block", blk, window);
+    report(rec, P::name(), "static", blkStatic, window);
+    report(rec, P::name(), "q15", q15, window);
+    report(rec, P::name(), "q15s", q15Static, window);
+
+    if (blkStatic.triggers != blk.triggers || q15Static.triggers != q15.triggers) {
+        fprintf(stderr, "[REPLAY] profile %s: specialized kernels differ from runtime parameters\n", P::name());
+        return 1;
+    }
+    return 0;
+}
+
+template <class P>
+static size_t replayProfile(const Recording &rec, int repeat, size_t blockSize, size_t window) {
+    switch (rec.odr_hz) {
+        case 100: return replayProfileAt<P, 100>(rec, repeat, blockSize, window);
+        case 200: return replayProfileAt<P, 200>(rec, repeat, blockSize, window);
+        case 400: return replayProfileAt<P, 400>(rec, repeat, blockSize, window);
+        case 800: return replayProfileAt<P, 800>(rec, repeat, blockSize, window);
+        default:
+            fprintf(stderr, "[REPLAY] profile %s: skipped, no specialization for %u Hz\n", P::name(), rec.odr_hz);
+            return 0;
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--odr HZ] [--counts] [--event N]... [--window N] [--repeat N]\n"
+            "          [--block N] [--check] [--set LTA,STA,RATIO] [file]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    Recording rec;
+    rec.odr_hz = 100;
+    bool counts = false;
+    int repeat = 20;
+    size_t window = 0;
+    size_t blockSize = FIFO_WATERMARK;
+    bool check = false;
+    const char *path = NULL;
+    std::vector<size_t> events;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(a, "--odr") == 0 && hasValue) {
+            rec.odr_hz = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(a, "--counts") == 0) {
+            counts = true;
+        } else if (strcmp(a, "--event") == 0 && hasValue) {
+            events.push_back((size_t)atol(argv[++i]));
+        } else if (strcmp(a, "--window") == 0 && hasValue) {
+            window = (size_t)atol(argv[++i]);
+        } else if (strcmp(a, "--block") == 0 && hasValue) {
+            blockSize = (size_t)atol(argv[++i]);
+        } else if (strcmp(a, "--check") == 0) {
+            check = true;
+        } else if (strcmp(a, "--repeat") == 0 && hasValue) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(a, "--set") == 0 && hasValue) {
+            ParameterSet set = {"custom", 0, 0, 0};
+            if (sscanf(argv[++i], "%f,%f,%f", &set.alpha_lta, &set.alpha_sta, &set.trigger_ratio) != 3) {
+                usage(argv[0]);
+                return 2;
+            }
+            PARAMETER_SETS.push_back(set);
+        } else if (a[0] != '-' && path == NULL) {
+            path = a;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (repeat < 1) repeat = 1;
+    if (blockSize < 1) blockSize = FIFO_WATERMARK;
+    if (rec.odr_hz == 0) rec.odr_hz = 100;
+
+    if (path != NULL) {
+        if (!loadRecording(path, rec, counts)) {
+            fprintf(stderr, "[REPLAY] No samples found in %s\n", path);
+            return 1;
+        }
+        rec.events = events;
+    } else {
+        buildSynthetic(rec, rec.odr_hz);
+    }
+    // Default window: two cooldowns, so a re-trigger in the coda of an event is not a false alarm
+    if (window == 0) window = (2 * ALARM_COOLDOWN_MS * rec.odr_hz) / 1000;
+
+    printf("[REPLAY] %s: %zu samples @ %u Hz (%.1f s), %zu events, window %zu samples, %d passes\n",
+           rec.name, rec.samples.size(), rec.odr_hz, (double)rec.samples.size() / rec.odr_hz,
+           rec.events.size(), window, repeat);
+    printf("%-13s %-6s %12s %10s %9s %10s %15s %6s\n",
+           "set", "impl", "samples/s", "ns/sample", "triggers", "detected", "latency avg/max", "false");
+
+    size_t mismatches = 0;
+    for (const ParameterSet &set : PARAMETER_SETS) {
+        DetectorParams p = floatParams(set, rec.odr_hz);
+        ReplayResult ref = replayReference(rec, p, repeat);
+        ReplayResult blk = replayBlock(rec, p, repeat, blockSize);
+        report(rec, set.name, "ref", ref, window);
+        report(rec, set.name, "block", blk, window);
+        const FixedParams qp = fixedParamsFromFloat(set.alpha_lta, set.alpha_sta, HPF_COEFF,
+                                                    set.trigger_ratio, NOISE_FLOOR, DROPOUT_MS2,
+                                                    LTA_FLOOR, rec.odr_hz, ALARM_COOLDOWN_MS);
+        report(rec, set.name, "q15", replayFixed(rec, qp, qp, repeat), window);
+        if (blk.triggers != ref.triggers) {
+            mismatches++;
+            fprintf(stderr, "[REPLAY] %s: block triggers differ from the sqrt(pow) reference (%zu vs %zu)\n",
+                    set.name, blk.triggers.size(), ref.triggers.size());
+        }
+    }
+    size_t profileMismatches = 0;
+    profileMismatches += replayProfile<ProfileReference>(rec, repeat, blockSize, window);
+    profileMismatches += replayProfile<ProfileBuilding>(rec, repeat, blockSize, window);
+    profileMismatches += replayProfile<ProfileBedrock>(rec, repeat, blockSize, window);
+    report(rec, "bank-default", "bank", replayBank(rec, bankDefaultConfig(), repeat, blockSize), window);
+
+    printf("[REPLAY] Block kernel %s, %zu samples/call: %zu/%zu sets match the reference, "
+           "%zu/3 profiles match their specialized kernels\n",
+           dspBlockKernel(), blockSize, PARAMETER_SETS.size() - mismatches, PARAMETER_SETS.size(),
+           3 - profileMismatches);
+    reportFeatures(rec, PARAMETER_SETS[0], window);
+    return check && (mismatches > 0 || profileMismatches > 0) ? 1 : 0;
+}